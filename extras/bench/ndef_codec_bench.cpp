@@ -0,0 +1,452 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2021 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MIX MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/mix_myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+
+/*! \file
+ *
+ *  \author SRA
+ *
+ *  \brief NDEF codec benchmark
+ *
+ *  Measures records/s and bytes/s of ndefMessageDecode(), ndefMessageEncode(),
+ *  ndefRecordToType() and ndefTypeToRecord() over URI, Text, vCard, Wi-Fi
+ *  and multi-record corpora. Built by the host target of CMakeLists.txt:
+ *
+ *    cmake -S . -B build && cmake --build build
+ *    ./build/ndef_codec_bench [iterations]
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ndef_class.h"
+#include "rfal_clock.h"
+
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define BENCH_DEFAULT_ITERATIONS  200000U /*!< Iterations per measurement       */
+#define BENCH_MAX_RECORD          NDEF_MAX_RECORD /*!< Records per corpus, decoded from the built-in pool */
+#define BENCH_MESSAGE_LEN         1024U   /*!< Encoded message buffer length    */
+
+#define BENCH_CBUF(s)             { (const uint8_t *)(s), sizeof(s) - 1U }
+
+
+/*
+ ******************************************************************************
+ * LOCAL TYPES
+ ******************************************************************************
+ */
+
+/*! Benchmark corpus: the types, their records and the encoded message */
+typedef struct {
+  const char  *name;                              /*!< Corpus name             */
+  ndefType     type[BENCH_MAX_RECORD];            /*!< Source types            */
+  ndefRecord   record[BENCH_MAX_RECORD];          /*!< Records of the message  */
+  uint32_t     count;                             /*!< Number of records       */
+  ndefMessage  message;                           /*!< Message to encode       */
+  uint8_t      encoded[BENCH_MESSAGE_LEN];        /*!< Encoded message         */
+  uint32_t     encodedLen;                        /*!< Encoded message length  */
+} benchCorpus;
+
+
+/*
+ ******************************************************************************
+ * LOCAL VARIABLES
+ ******************************************************************************
+ */
+
+static NdefClass      ndef(NULL);
+static RfalLinuxClock benchClock;
+static volatile uint32_t benchSink; /*!< Keeps the results observable */
+
+static const uint8_t benchUri0[]   = "st.com/st25";
+static const uint8_t benchUri1[]   = "github.com/lewisxhe/NFC-RFAL-fork";
+static const uint8_t benchUri2[]   = "example.com/products/nfc/tags?id=0123456789&lang=en";
+static const uint8_t benchUri3[]   = "info@example.com";
+
+static const uint8_t benchLangEn[] = "en";
+static const uint8_t benchLangFr[] = "fr";
+static const uint8_t benchText0[]  = "Hello world";
+static const uint8_t benchText1[]  = "Tap the tag again to pair the speaker with your phone.";
+static const uint8_t benchText2[]  = "Bonjour, cette etiquette contient les informations de maintenance de la machine 42.";
+
+static const uint8_t benchVCardN[]     = "N";
+static const uint8_t benchVCardFn[]    = "FN";
+static const uint8_t benchVCardTel[]   = "TEL";
+static const uint8_t benchVCardEmail[] = "EMAIL";
+static const uint8_t benchVCardAdr[]   = "ADR";
+static const uint8_t benchVCardCell[]  = "CELL";
+static const uint8_t benchVCardWork[]  = "WORK";
+static const uint8_t benchVCardNone[]  = "";
+static const uint8_t benchVCardNameV[] = "Doe;John;;;";
+static const uint8_t benchVCardFnV[]   = "John Doe";
+static const uint8_t benchVCardTelV[]  = "+33 1 23 45 67 89";
+static const uint8_t benchVCardMailV[] = "john.doe@example.com";
+static const uint8_t benchVCardAdrV[]  = ";;39 Chemin du Champ des Filles;Geneva;;1228;Switzerland";
+
+static const uint8_t benchSsid0[]  = "ST-Guest";
+static const uint8_t benchKey0[]   = "guest-password-2021";
+static const uint8_t benchSsid1[]  = "Factory-Floor-5GHz";
+static const uint8_t benchKey1[]   = "0123456789abcdef0123456789abcdef";
+
+static const uint8_t benchAarPkg[] = "com.st.st25nfc";
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static uint32_t benchElapsedUs(uint32_t startUs)
+{
+  uint32_t elapsed = benchClock.rfalClockGetUs() - startUs;
+
+  return (elapsed == 0U) ? 1U : elapsed;
+}
+
+
+/*******************************************************************************/
+static void benchReport(const char *corpus, const char *op, uint32_t records, uint32_t bytes, uint32_t iterations, uint32_t elapsedUs)
+{
+  double seconds = (double)elapsedUs / 1000000.0;
+
+  printf("%-12s %-16s %12.0f %14.0f %10.3f\n", corpus, op,
+         ((double)records * (double)iterations) / seconds,
+         ((double)bytes   * (double)iterations) / seconds,
+         ((double)elapsedUs * 1000.0) / ((double)iterations * (double)records));
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAdd(benchCorpus *corpus)
+{
+  ReturnCode err;
+
+  err = ndef.ndefTypeToRecord(&corpus->type[corpus->count], &corpus->record[corpus->count]);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  err = ndef.ndefMessageAppend(&corpus->message, &corpus->record[corpus->count]);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  corpus->count++;
+
+  return ST_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAddUri(benchCorpus *corpus, uint8_t protocol, const uint8_t *uri, uint32_t uriLen)
+{
+  ndefConstBuffer bufUri = { uri, uriLen };
+  ReturnCode      err;
+
+  err = ndef.ndefRtdUri(&corpus->type[corpus->count], protocol, &bufUri);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  return benchCorpusAdd(corpus);
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAddText(benchCorpus *corpus, const uint8_t *lang, uint8_t langLen, const uint8_t *text, uint32_t textLen)
+{
+  ndefConstBuffer8 bufLang = { lang, langLen };
+  ndefConstBuffer  bufText = { text, textLen };
+  ReturnCode       err;
+
+  err = ndef.ndefRtdText(&corpus->type[corpus->count], TEXT_ENCODING_UTF8, &bufLang, &bufText);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  return benchCorpusAdd(corpus);
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAddVCard(benchCorpus *corpus)
+{
+  static const ndefConstBuffer bufN       = BENCH_CBUF(benchVCardN);
+  static const ndefConstBuffer bufFn      = BENCH_CBUF(benchVCardFn);
+  static const ndefConstBuffer bufTel     = BENCH_CBUF(benchVCardTel);
+  static const ndefConstBuffer bufEmail   = BENCH_CBUF(benchVCardEmail);
+  static const ndefConstBuffer bufAdr     = BENCH_CBUF(benchVCardAdr);
+  static const ndefConstBuffer bufCell    = BENCH_CBUF(benchVCardCell);
+  static const ndefConstBuffer bufWork    = BENCH_CBUF(benchVCardWork);
+  static const ndefConstBuffer bufNone    = BENCH_CBUF(benchVCardNone);
+  static const ndefConstBuffer bufNameV   = BENCH_CBUF(benchVCardNameV);
+  static const ndefConstBuffer bufFnV     = BENCH_CBUF(benchVCardFnV);
+  static const ndefConstBuffer bufTelV    = BENCH_CBUF(benchVCardTelV);
+  static const ndefConstBuffer bufMailV   = BENCH_CBUF(benchVCardMailV);
+  static const ndefConstBuffer bufAdrV    = BENCH_CBUF(benchVCardAdrV);
+  const ndefVCardInput input[] = {
+    { (ndefConstBuffer *)&bufN,     (ndefConstBuffer *)&bufNone, (ndefConstBuffer *)&bufNameV },
+    { (ndefConstBuffer *)&bufFn,    (ndefConstBuffer *)&bufNone, (ndefConstBuffer *)&bufFnV   },
+    { (ndefConstBuffer *)&bufTel,   (ndefConstBuffer *)&bufCell, (ndefConstBuffer *)&bufTelV  },
+    { (ndefConstBuffer *)&bufEmail, (ndefConstBuffer *)&bufWork, (ndefConstBuffer *)&bufMailV },
+    { (ndefConstBuffer *)&bufAdr,   (ndefConstBuffer *)&bufWork, (ndefConstBuffer *)&bufAdrV  },
+  };
+  ReturnCode err;
+
+  err = ndef.ndefVCard(&corpus->type[corpus->count], input, (uint32_t)(sizeof(input) / sizeof(input[0])));
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  return benchCorpusAdd(corpus);
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAddWifi(benchCorpus *corpus, const uint8_t *ssid, uint32_t ssidLen, const uint8_t *key, uint32_t keyLen)
+{
+  ndefTypeWifi wifi;
+  ReturnCode   err;
+
+  (void)ST_MEMSET(&wifi, 0, sizeof(wifi));
+  wifi.bufNetworkSSID.buffer = ssid;
+  wifi.bufNetworkSSID.length = ssidLen;
+  wifi.bufNetworkKey.buffer  = key;
+  wifi.bufNetworkKey.length  = keyLen;
+  wifi.authentication        = NDEF_WIFI_AUTHENTICATION_WPA2PSK;
+  wifi.encryption            = NDEF_WIFI_ENCRYPTION_AES;
+
+  err = ndef.ndefWifi(&corpus->type[corpus->count], &wifi);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  return benchCorpusAdd(corpus);
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusAddAar(benchCorpus *corpus)
+{
+  ndefConstBuffer bufPkg = BENCH_CBUF(benchAarPkg);
+  ReturnCode      err;
+
+  err = ndef.ndefRtdAar(&corpus->type[corpus->count], &bufPkg);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  return benchCorpusAdd(corpus);
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusBuild(benchCorpus *corpus, uint32_t id)
+{
+  ndefBuffer bufEncoded;
+  ReturnCode err = ST_ERR_NONE;
+
+  (void)ST_MEMSET(corpus, 0, sizeof(benchCorpus));
+  (void)ndef.ndefMessageInit(&corpus->message);
+
+  switch (id) {
+    case 0U:
+      corpus->name = "uri";
+      err |= benchCorpusAddUri(corpus, NDEF_URI_PREFIX_HTTPS,    benchUri0, sizeof(benchUri0) - 1U);
+      err |= benchCorpusAddUri(corpus, NDEF_URI_PREFIX_HTTPS,    benchUri1, sizeof(benchUri1) - 1U);
+      err |= benchCorpusAddUri(corpus, NDEF_URI_PREFIX_HTTP_WWW, benchUri2, sizeof(benchUri2) - 1U);
+      err |= benchCorpusAddUri(corpus, NDEF_URI_PREFIX_MAILTO,   benchUri3, sizeof(benchUri3) - 1U);
+      break;
+
+    case 1U:
+      corpus->name = "text";
+      err |= benchCorpusAddText(corpus, benchLangEn, sizeof(benchLangEn) - 1U, benchText0, sizeof(benchText0) - 1U);
+      err |= benchCorpusAddText(corpus, benchLangEn, sizeof(benchLangEn) - 1U, benchText1, sizeof(benchText1) - 1U);
+      err |= benchCorpusAddText(corpus, benchLangFr, sizeof(benchLangFr) - 1U, benchText2, sizeof(benchText2) - 1U);
+      break;
+
+    case 2U:
+      corpus->name = "vcard";
+      err |= benchCorpusAddVCard(corpus);
+      break;
+
+    case 3U:
+      corpus->name = "wifi";
+      err |= benchCorpusAddWifi(corpus, benchSsid0, sizeof(benchSsid0) - 1U, benchKey0, sizeof(benchKey0) - 1U);
+      break;
+
+    case 4U:
+      corpus->name = "multi";
+      err |= benchCorpusAddUri(corpus, NDEF_URI_PREFIX_HTTPS, benchUri1, sizeof(benchUri1) - 1U);
+      err |= benchCorpusAddText(corpus, benchLangEn, sizeof(benchLangEn) - 1U, benchText1, sizeof(benchText1) - 1U);
+      err |= benchCorpusAddVCard(corpus);
+      err |= benchCorpusAddWifi(corpus, benchSsid0, sizeof(benchSsid0) - 1U, benchKey0, sizeof(benchKey0) - 1U);
+      err |= benchCorpusAddWifi(corpus, benchSsid1, sizeof(benchSsid1) - 1U, benchKey1, sizeof(benchKey1) - 1U);
+      err |= benchCorpusAddText(corpus, benchLangFr, sizeof(benchLangFr) - 1U, benchText2, sizeof(benchText2) - 1U);
+      err |= benchCorpusAddAar(corpus);
+      break;
+
+    default:
+      return ST_ERR_PARAM;
+  }
+  if (err != ST_ERR_NONE) {
+    return ST_ERR_INTERNAL;
+  }
+
+  bufEncoded.buffer = corpus->encoded;
+  bufEncoded.length = sizeof(corpus->encoded);
+  err = ndef.ndefMessageEncode(&corpus->message, &bufEncoded);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  corpus->encodedLen = bufEncoded.length;
+
+  return ST_ERR_NONE;
+}
+
+
+/*******************************************************************************/
+static ReturnCode benchCorpusRun(benchCorpus *corpus, uint32_t iterations)
+{
+  ndefConstBuffer bufDecode = { corpus->encoded, corpus->encodedLen };
+  uint8_t         scratch[BENCH_MESSAGE_LEN];
+  ndefBuffer      bufEncode;
+  ndefMessage     message;
+  ndefType        type;
+  ndefRecord      record;
+  ndefRecord     *rec;
+  uint32_t        recordBytes;
+  uint32_t        startUs;
+  uint32_t        i;
+  uint32_t        r;
+  ReturnCode      err;
+
+  /* Bytes covered by the record conversions: header plus payload of each record */
+  recordBytes = 0U;
+  for (r = 0U; r < corpus->count; r++) {
+    recordBytes += ndef.ndefRecordGetHeaderLength(&corpus->record[r]) + ndef.ndefRecordGetPayloadLength(&corpus->record[r]);
+  }
+
+  /* ndefMessageDecode */
+  startUs = benchClock.rfalClockGetUs();
+  for (i = 0U; i < iterations; i++) {
+    err = ndef.ndefMessageDecode(&bufDecode, &message);
+    if (err != ST_ERR_NONE) {
+      return err;
+    }
+    benchSink += message.info.recordCount;
+  }
+  benchReport(corpus->name, "MessageDecode", corpus->count, corpus->encodedLen, iterations, benchElapsedUs(startUs));
+
+  /* ndefMessageEncode */
+  startUs = benchClock.rfalClockGetUs();
+  for (i = 0U; i < iterations; i++) {
+    bufEncode.buffer = scratch;
+    bufEncode.length = sizeof(scratch);
+    err = ndef.ndefMessageEncode(&corpus->message, &bufEncode);
+    if (err != ST_ERR_NONE) {
+      return err;
+    }
+    benchSink += bufEncode.length;
+  }
+  benchReport(corpus->name, "MessageEncode", corpus->count, corpus->encodedLen, iterations, benchElapsedUs(startUs));
+  if ((bufEncode.length != corpus->encodedLen) || (ST_BYTECMP(scratch, corpus->encoded, corpus->encodedLen) != 0)) {
+    return ST_ERR_INTERNAL;
+  }
+
+  /* ndefRecordToType, on the records of a decoded message */
+  err = ndef.ndefMessageDecode(&bufDecode, &message);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  startUs = benchClock.rfalClockGetUs();
+  for (i = 0U; i < iterations; i++) {
+    for (rec = message.record; rec != NULL; rec = rec->next) {
+      err = ndef.ndefRecordToType(rec, &type);
+      if (err != ST_ERR_NONE) {
+        return err;
+      }
+      benchSink += (uint32_t)type.id;
+    }
+  }
+  benchReport(corpus->name, "RecordToType", corpus->count, recordBytes, iterations, benchElapsedUs(startUs));
+
+  /* ndefTypeToRecord */
+  startUs = benchClock.rfalClockGetUs();
+  for (i = 0U; i < iterations; i++) {
+    for (r = 0U; r < corpus->count; r++) {
+      err = ndef.ndefTypeToRecord(&corpus->type[r], &record);
+      if (err != ST_ERR_NONE) {
+        return err;
+      }
+      benchSink += record.header;
+    }
+  }
+  benchReport(corpus->name, "TypeToRecord", corpus->count, recordBytes, iterations, benchElapsedUs(startUs));
+
+  return ST_ERR_NONE;
+}
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+int main(int argc, char *argv[])
+{
+  static benchCorpus corpus;
+  uint32_t           iterations = BENCH_DEFAULT_ITERATIONS;
+  uint32_t           id;
+  ReturnCode         err;
+
+  if (argc > 1) {
+    iterations = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (iterations == 0U) {
+      fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  printf("%-12s %-16s %12s %14s %10s\n", "corpus", "operation", "records/s", "bytes/s", "ns/record");
+  for (id = 0U; id < 5U; id++) {
+    err = benchCorpusBuild(&corpus, id);
+    if (err == ST_ERR_NONE) {
+      err = benchCorpusRun(&corpus, iterations);
+    }
+    if (err != ST_ERR_NONE) {
+      fprintf(stderr, "corpus %u failed: %d\n", (unsigned)id, (int)err);
+      return EXIT_FAILURE;
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,95 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2021 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MIX MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/mix_myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+
+/*! \file
+ *
+ *  \author SRA
+ *
+ *  \brief Minimal Arduino core stub for host builds
+ *
+ *  Provides the C library headers and the timing functions the library
+ *  expects from the Arduino core so that it can be compiled, tested and
+ *  benchmarked on a desktop host. ARDUINO is deliberately left undefined.
+ *
+ */
+
+#ifndef ARDUINO_HOST_STUB_H
+#define ARDUINO_HOST_STUB_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static inline unsigned long micros(void)
+{
+  struct timespec ts;
+
+  (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (unsigned long)(((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U));
+}
+
+
+/*******************************************************************************/
+static inline unsigned long millis(void)
+{
+  return (micros() / 1000UL);
+}
+
+
+/*******************************************************************************/
+static inline void delayMicroseconds(unsigned int us)
+{
+  struct timespec ts;
+
+  ts.tv_sec  = (time_t)(us / 1000000U);
+  ts.tv_nsec = (long)((us % 1000000U) * 1000U);
+  while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR)) { /* MISRA 15.6: mandatory brackets */ };
+}
+
+
+/*******************************************************************************/
+static inline void delay(unsigned long ms)
+{
+  while (ms > 0UL) {
+    delayMicroseconds(1000U);
+    ms--;
+  }
+}
+
+#endif /* ARDUINO_HOST_STUB_H */
@@ -0,0 +1,433 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2021 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MIX MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/mix_myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author SRA
+ *
+ *  \brief NDEF block cache
+ *
+ *  This module provides the block-granular write-back cache the T2T, T3T
+ *  and T5T byte accesses are built on. Partial block reads and the read
+ *  part of read-modify-write cycles are served from RAM when the block is
+ *  cached. Writes only mark blocks dirty: dirty blocks are written back in
+ *  ascending block order when a block has to be evicted, before a direct
+ *  multi-block read, before an L-field update and at the end of a public
+ *  byte write, so that the NDEF data always reaches the tag between the
+ *  L-field reset and the L-field update.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_class.h"
+
+/*
+ ******************************************************************************
+ * ENABLE SWITCH
+ ******************************************************************************
+ */
+
+#if NDEF_FEATURE_BLOCK_CACHE
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#if (NDEF_BLOCK_CACHE_BLOCKS < 2U)
+#error "NDEF_BLOCK_CACHE_BLOCKS must be at least 2"
+#endif
+
+#define NDEF_BLOCK_CACHE_RUN_MAX_LEN   (NDEF_T3T_MAX_NB_BLOCKS * NDEF_T3T_BLOCK_SIZE)   /*!< Largest run of blocks written back with one command (T3T UPDATE) */
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+void NdefClass::ndefBlockCacheInvalidate(void)
+{
+  (void)ST_MEMSET(&blockCache, 0, sizeof(ndefBlockCache));
+}
+
+/*******************************************************************************/
+ndefBlockCacheEntry *NdefClass::ndefBlockCacheFind(uint16_t blockNum)
+{
+  uint32_t i;
+
+  for (i = 0U; i < NDEF_BLOCK_CACHE_BLOCKS; i++) {
+    if (blockCache.entry[i].valid && (blockCache.entry[i].blockNum == blockNum)) {
+      return &blockCache.entry[i];
+    }
+  }
+  return NULL;
+}
+
+/*******************************************************************************/
+uint32_t NdefClass::ndefBlockCacheRunMax(void)
+{
+  uint32_t nbBlocks;
+
+  if (type != NDEF_DEV_T3T) {
+    /* T2T WRITE and T5T Write Single Block carry one block */
+    return 1U;
+  }
+
+  nbBlocks = NDEF_T3T_MAX_NB_BLOCKS;
+  if ((state != NDEF_STATE_INVALID) && (cc.t3t.nbW != 0U) && (cc.t3t.nbW < nbBlocks)) {
+    nbBlocks = cc.t3t.nbW;
+  }
+  return nbBlocks;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheReadDevice(uint16_t blockNum, uint8_t *buf)
+{
+  ReturnCode ret;
+#if NDEF_FEATURE_T2T
+  uint8_t    rsp[NDEF_T2T_READ_RESP_SIZE];
+  uint32_t   i;
+#endif
+#if (NDEF_FEATURE_T3T || NDEF_FEATURE_T5T)
+  uint16_t   rcvLen;
+#endif
+#if NDEF_FEATURE_T5T
+  uint32_t   blockLen;
+#endif
+
+  switch (type) {
+#if NDEF_FEATURE_T2T
+    case NDEF_DEV_T2T:
+      /* One READ returns four blocks: keep the following ones too */
+      ret = ndefT2TPollerReadBlock(blockNum, rsp);
+      if (ret != ST_ERR_NONE) {
+        return ret;
+      }
+      (void)ST_MEMCPY(buf, rsp, NDEF_T2T_BLOCK_SIZE);
+      for (i = 1U; i < (NDEF_T2T_READ_RESP_SIZE / NDEF_T2T_BLOCK_SIZE); i++) {
+        if (((uint32_t)(blockNum & 0xFFU) + i) <= 0xFFU) {
+          ndefBlockCacheFill((uint16_t)(blockNum + i), &rsp[i * NDEF_T2T_BLOCK_SIZE]);
+        }
+      }
+      return ST_ERR_NONE;
+#endif
+
+#if NDEF_FEATURE_T3T
+    case NDEF_DEV_T3T:
+      ret = ndefT3TPollerReadBlocks(blockNum, 1U, buf, NDEF_T3T_BLOCK_SIZE, &rcvLen);
+      if ((ret == ST_ERR_NONE) && (rcvLen != NDEF_T3T_BLOCK_SIZE)) {
+        return ST_ERR_MEM_CORRUPT;
+      }
+      return ret;
+#endif
+
+#if NDEF_FEATURE_T5T
+    case NDEF_DEV_T5T:
+      blockLen = subCtx.t5t.blockLen;
+      if ((((uint32_t)blockNum + 1U) * blockLen) <= subCtx.t5t.readAheadLen) {
+        /* Already read at NDEF detect */
+        (void)ST_MEMCPY(buf, &subCtx.t5t.readAhead[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + ((uint32_t)blockNum * blockLen)], blockLen);
+        return ST_ERR_NONE;
+      }
+      ret = ndefT5TPollerReadSingleBlock(blockNum, subCtx.t5t.txrxBuf, (uint16_t)(blockLen + 3U), &rcvLen);
+      if (ret != ST_ERR_NONE) {
+        return ret;
+      }
+      if ((subCtx.t5t.txrxBuf[0U] != 0U) || (rcvLen < (blockLen + 1U))) {
+        return ST_ERR_PROTO;
+      }
+      (void)ST_MEMCPY(buf, &subCtx.t5t.txrxBuf[1U], blockLen);
+      return ST_ERR_NONE;
+#endif
+
+    case NDEF_DEV_NONE:
+    case NDEF_DEV_T1T:
+    case NDEF_DEV_T4T:
+    default:
+      return ST_ERR_NOTSUPP;
+  }
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheWriteDevice(uint16_t blockNum, uint8_t nbBlocks, const uint8_t *buf)
+{
+  NO_WARNING(nbBlocks); /* Only T3T writes several blocks at once */
+
+  switch (type) {
+#if NDEF_FEATURE_T2T
+    case NDEF_DEV_T2T:
+      return ndefT2TPollerWriteBlock(blockNum, buf);
+#endif
+#if NDEF_FEATURE_T3T
+    case NDEF_DEV_T3T:
+      return ndefT3TPollerWriteBlocks(blockNum, nbBlocks, buf);
+#endif
+#if NDEF_FEATURE_T5T
+    case NDEF_DEV_T5T:
+      return ndefT5TPollerWriteSingleBlock(blockNum, buf);
+#endif
+    case NDEF_DEV_NONE:
+    case NDEF_DEV_T1T:
+    case NDEF_DEV_T4T:
+    default:
+      return ST_ERR_NOTSUPP;
+  }
+}
+
+/*******************************************************************************/
+void NdefClass::ndefBlockCacheFill(uint16_t blockNum, const uint8_t *data)
+{
+  ndefBlockCacheEntry *entry;
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             i;
+
+  entry = ndefBlockCacheFind(blockNum);
+  if (entry != NULL) {
+    if (!entry->dirty) {
+      (void)ST_MEMCPY(entry->data, data, blockLen);
+    }
+    return;
+  }
+
+  /* Prefetched data only takes a free entry, it never evicts a block */
+  for (i = 0U; i < NDEF_BLOCK_CACHE_BLOCKS; i++) {
+    if (!blockCache.entry[i].valid) {
+      entry = &blockCache.entry[i];
+      break;
+    }
+  }
+  if (entry == NULL) {
+    return;
+  }
+
+  (void)ST_MEMCPY(entry->data, data, blockLen);
+  entry->blockNum = blockNum;
+  entry->valid    = true;
+  entry->dirty    = false;
+  entry->lastUse  = ++blockCache.useCounter;
+}
+
+/*******************************************************************************/
+void NdefClass::ndefBlockCacheUpdate(uint16_t blockNum, uint32_t nbBlocks, const uint8_t *data, bool written)
+{
+  ndefBlockCacheEntry *entry;
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             i;
+
+  for (i = 0U; i < nbBlocks; i++) {
+    entry = ndefBlockCacheFind((uint16_t)(blockNum + i));
+    if (entry == NULL) {
+      continue;
+    }
+    if (written) {
+      if (entry->data != &data[i * blockLen]) {
+        (void)ST_MEMCPY(entry->data, &data[i * blockLen], blockLen);
+      }
+    } else {
+      /* Tag content unknown after a failed write */
+      entry->valid = false;
+    }
+    entry->dirty = false;
+  }
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheGet(uint16_t blockNum, bool fetch, ndefBlockCacheEntry **entry)
+{
+  ReturnCode           ret;
+  ndefBlockCacheEntry *victim;
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             i;
+
+  if ((blockLen == 0U) || (blockLen > NDEF_BLOCK_CACHE_BLOCK_MAX_LEN)) {
+    return ST_ERR_NOTSUPP;
+  }
+
+  victim = ndefBlockCacheFind(blockNum);
+  if (victim != NULL) {
+    victim->lastUse = ++blockCache.useCounter;
+    *entry          = victim;
+    return ST_ERR_NONE;
+  }
+
+  /* Use a free entry, or evict the least recently used one */
+  victim = &blockCache.entry[0];
+  for (i = 0U; i < NDEF_BLOCK_CACHE_BLOCKS; i++) {
+    if (!blockCache.entry[i].valid) {
+      victim = &blockCache.entry[i];
+      break;
+    }
+    if (blockCache.entry[i].lastUse < victim->lastUse) {
+      victim = &blockCache.entry[i];
+    }
+  }
+  if (victim->valid && victim->dirty) {
+    /* Write back every dirty block, in order, rather than the victim alone */
+    ret = ndefBlockCacheFlush();
+    if (ret != ST_ERR_NONE) {
+      return ret;
+    }
+  }
+
+  victim->blockNum = blockNum;
+  victim->valid    = true;
+  victim->dirty    = false;
+  victim->lastUse  = ++blockCache.useCounter;
+
+  if (fetch) {
+    ret = ndefBlockCacheReadDevice(blockNum, victim->data);
+    if (ret != ST_ERR_NONE) {
+      victim->valid = false;
+      return ret;
+    }
+  }
+
+  *entry = victim;
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheRead(uint32_t offset, uint32_t len, uint8_t *buf)
+{
+  ReturnCode           ret;
+  ndefBlockCacheEntry *entry;
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             byteNo;
+  uint32_t             le;
+
+  if ((blockLen == 0U) || (buf == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  while (len != 0U) {
+    byteNo = offset % blockLen;
+    le     = MIN(len, blockLen - byteNo);
+
+    ret = ndefBlockCacheGet((uint16_t)(offset / blockLen), true, &entry);
+    if (ret != ST_ERR_NONE) {
+      return ret;
+    }
+    (void)ST_MEMCPY(buf, &entry->data[byteNo], le);
+
+    buf     = &buf[le];
+    offset += le;
+    len    -= le;
+  }
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheWrite(uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+  ReturnCode           ret;
+  ndefBlockCacheEntry *entry;
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             byteNo;
+  uint32_t             le;
+
+  if ((blockLen == 0U) || (buf == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  while (len != 0U) {
+    byteNo = offset % blockLen;
+    le     = MIN(len, blockLen - byteNo);
+
+    /* Only a partially written block needs its current content */
+    ret = ndefBlockCacheGet((uint16_t)(offset / blockLen), (le != blockLen), &entry);
+    if (ret != ST_ERR_NONE) {
+      /* Drop the pending part of the write, the caller gets the error */
+      ndefBlockCacheInvalidate();
+      return ret;
+    }
+    (void)ST_MEMCPY(&entry->data[byteNo], buf, le);
+    entry->dirty = true;
+
+    buf     = &buf[le];
+    offset += le;
+    len    -= le;
+  }
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefBlockCacheFlush(void)
+{
+  ReturnCode           ret;
+  ndefBlockCacheEntry *first;
+  ndefBlockCacheEntry *next;
+  uint8_t              run[NDEF_BLOCK_CACHE_RUN_MAX_LEN];
+  uint32_t             blockLen = ndefPollerBlockLen();
+  uint32_t             runMax   = ndefBlockCacheRunMax();
+  uint32_t             nbBlocks;
+  uint32_t             i;
+
+  if ((blockLen * runMax) > sizeof(run)) {
+    runMax = 1U;
+  }
+
+  for (;;) {
+    /* Lowest dirty block first */
+    first = NULL;
+    for (i = 0U; i < NDEF_BLOCK_CACHE_BLOCKS; i++) {
+      if (blockCache.entry[i].valid && blockCache.entry[i].dirty && ((first == NULL) || (blockCache.entry[i].blockNum < first->blockNum))) {
+        first = &blockCache.entry[i];
+      }
+    }
+    if (first == NULL) {
+      return ST_ERR_NONE;
+    }
+
+    /* Extend to the following dirty blocks the command can carry */
+    (void)ST_MEMCPY(run, first->data, blockLen);
+    nbBlocks = 1U;
+    while (nbBlocks < runMax) {
+      next = ndefBlockCacheFind((uint16_t)(first->blockNum + nbBlocks));
+      if ((next == NULL) || !next->dirty) {
+        break;
+      }
+      (void)ST_MEMCPY(&run[nbBlocks * blockLen], next->data, blockLen);
+      nbBlocks++;
+    }
+
+    ret = ndefBlockCacheWriteDevice(first->blockNum, (uint8_t)nbBlocks, run);
+    if (ret != ST_ERR_NONE) {
+      ndefBlockCacheInvalidate();
+      return ret;
+    }
+    /* The device write refreshes the entries; make sure they are clean */
+    for (i = 0U; i < nbBlocks; i++) {
+      next = ndefBlockCacheFind((uint16_t)(first->blockNum + i));
+      if (next != NULL) {
+        next->dirty = false;
+      }
+    }
+  }
+}
+
+#endif /* NDEF_FEATURE_BLOCK_CACHE */
@@ -0,0 +1,399 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2021 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MIX MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/mix_myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author SRA
+ *
+ *  \brief NDEF tag geometry cache
+ *
+ *  This module remembers the geometry of the last seen tags (CC, NDEF TLV
+ *  offset, T5T block length and System Information) so that detection of a
+ *  known tag does not need to probe it again. The cache can be serialized
+ *  to warm start after a reboot.
+ *
+ */
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include "ndef_class.h"
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define NDEF_CACHE_BLOB_MAGIC_0          'N'    /*!< Blob magic number, byte 0           */
+#define NDEF_CACHE_BLOB_MAGIC_1          'C'    /*!< Blob magic number, byte 1           */
+#define NDEF_CACHE_BLOB_VERSION          2U     /*!< Blob format version                 */
+#define NDEF_CACHE_BLOB_HEADER_LEN       4U     /*!< Magic (2) + version (1) + count (1) */
+#define NDEF_CACHE_BLOB_CRC_LEN          2U     /*!< CRC over the header and the entries */
+#define NDEF_CACHE_BLOB_SYSINFO_LEN     (2U + 5U + NDEF_NFCV_SUPPORTED_CMD_LEN) /*!< Serialized System Information length */
+#define NDEF_CACHE_BLOB_GEOMETRY_LEN     6U     /*!< TLV offset (4) + block length (1) + flags (1) */
+
+#define NDEF_CACHE_T2T_CC_LEN            4U     /*!< T2T CC length read during detection */
+#define NDEF_CACHE_T5T_CC_LEN            8U     /*!< T5T CC bytes read during detection  */
+#define NDEF_CACHE_T5T_CC4_LEN           4U     /*!< T5T CC length without extended MLEN */
+
+/*
+ ******************************************************************************
+ * GLOBAL MACROS
+ ******************************************************************************
+ */
+
+#define ndefCacheIsCacheable(t)    (((t) == NDEF_DEV_T2T) || ((t) == NDEF_DEV_T5T))   /*!< Types whose geometry is cached */
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+static uint16_t ndefCacheCrc(const uint8_t *buf, uint32_t len)
+{
+  uint16_t crc;
+  uint32_t i;
+  uint8_t  bit;
+
+  /* CRC-16/CCITT as defined in ISO/IEC 13239, the one used by NFC-V frames */
+  crc = 0xFFFFU;
+  for (i = 0U; i < len; i++) {
+    crc ^= buf[i];
+    for (bit = 0U; bit < 8U; bit++) {
+      crc = ((crc & 0x0001U) != 0U) ? (uint16_t)((crc >> 1U) ^ 0x8408U) : (uint16_t)(crc >> 1U);
+    }
+  }
+  return (uint16_t)~crc;
+}
+
+/*******************************************************************************/
+static bool ndefCacheEntryIsConsistent(const ndefCacheEntry *entry)
+{
+  /* Geometry restored from a blob is used before the tag is read: reject values the detection never stores */
+  if (entry->type == (uint8_t)NDEF_DEV_T2T) {
+    return (entry->ccLen == NDEF_CACHE_T2T_CC_LEN);
+  }
+  if (entry->type == (uint8_t)NDEF_DEV_T5T) {
+    return (((entry->ccLen == NDEF_CACHE_T5T_CC_LEN) || (entry->ccLen == NDEF_CACHE_T5T_CC4_LEN)) &&
+            (entry->blockLen != 0U) && (entry->blockLen <= NDEF_BLOCK_CACHE_BLOCK_MAX_LEN));
+  }
+  return false;
+}
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
+
+/*******************************************************************************/
+void NdefClass::ndefPollerSetCache(ndefCache *cache)
+{
+  tagCache      = cache;
+  tagCacheEntry = NULL;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefCacheClear(ndefCache *cache)
+{
+  if (cache == NULL) {
+    return ST_ERR_PARAM;
+  }
+
+  (void)ST_MEMSET(cache, 0, sizeof(ndefCache));
+
+  if (cache == tagCache) {
+    tagCacheEntry = NULL;
+  }
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ndefCacheEntry *NdefClass::ndefCacheLookup(const rfalNfcDevice *dev)
+{
+  uint32_t i;
+
+  if ((tagCache == NULL) || (dev == NULL) || (dev->nfcid == NULL) || !ndefCacheIsCacheable(type) || (dev->nfcidLen > NDEF_CACHE_UID_MAX_LEN)) {
+    return NULL;
+  }
+
+  for (i = 0U; i < NDEF_CACHE_ENTRIES; i++) {
+    if ((tagCache->entry[i].type == (uint8_t)type) && (tagCache->entry[i].uidLen == dev->nfcidLen) &&
+        (ST_BYTECMP(tagCache->entry[i].uid, dev->nfcid, dev->nfcidLen) == 0)) {
+      tagCache->entry[i].lastUse = ++tagCache->useCounter;
+      return &tagCache->entry[i];
+    }
+  }
+  return NULL;
+}
+
+/*******************************************************************************/
+bool NdefClass::ndefCacheIsValid(uint32_t ccLen)
+{
+  /* The CC is always read back from the tag: the cached geometry is only trusted if it is unchanged */
+  if ((tagCacheEntry == NULL) || (tagCacheEntry->ccLen != ccLen) || (ST_BYTECMP(tagCacheEntry->cc, ccBuf, ccLen) != 0)) {
+    return false;
+  }
+  return true;
+}
+
+/*******************************************************************************/
+void NdefClass::ndefCacheDrop(void)
+{
+  if (tagCacheEntry != NULL) {
+    (void)ST_MEMSET(tagCacheEntry, 0, sizeof(ndefCacheEntry));
+    tagCacheEntry->type = (uint8_t)NDEF_DEV_NONE;
+    tagCacheEntry       = NULL;
+  }
+}
+
+/*******************************************************************************/
+void NdefClass::ndefCacheStore(void)
+{
+  ndefCacheEntry *entry;
+  uint32_t        i;
+
+  if ((tagCache == NULL) || (device.nfcid == NULL) || !ndefCacheIsCacheable(type) || (device.nfcidLen > NDEF_CACHE_UID_MAX_LEN)) {
+    return;
+  }
+
+  entry = tagCacheEntry;
+  if (entry == NULL) {
+    /* Use a free entry, or evict the least recently used one */
+    entry = &tagCache->entry[0];
+    for (i = 0U; i < NDEF_CACHE_ENTRIES; i++) {
+      if (tagCache->entry[i].type == (uint8_t)NDEF_DEV_NONE) {
+        entry = &tagCache->entry[i];
+        break;
+      }
+      if (tagCache->entry[i].lastUse < entry->lastUse) {
+        entry = &tagCache->entry[i];
+      }
+    }
+  }
+
+  (void)ST_MEMSET(entry, 0, sizeof(ndefCacheEntry));
+  entry->type    = (uint8_t)type;
+  entry->uidLen  = device.nfcidLen;
+  (void)ST_MEMCPY(entry->uid, device.nfcid, device.nfcidLen);
+  entry->lastUse = ++tagCache->useCounter;
+
+#if NDEF_FEATURE_T2T
+  if (type == NDEF_DEV_T2T) {
+    entry->ccLen     = (uint8_t)NDEF_CACHE_T2T_CC_LEN;
+    entry->tlvOffset = subCtx.t2t.offsetNdefTLV;
+  }
+#endif
+#if NDEF_FEATURE_T5T
+  if (type == NDEF_DEV_T5T) {
+    entry->ccLen     = (uint8_t)NDEF_CACHE_T5T_CC_LEN;
+    entry->tlvOffset = subCtx.t5t.TlvNDEFOffset;
+    entry->blockLen  = subCtx.t5t.blockLen;
+    entry->flags    |= (subCtx.t5t.legacySTHighDensity ? NDEF_CACHE_FLAG_LEGACY_HD : 0U);
+    if (subCtx.t5t.sysInfoSupported) {
+      entry->flags  |= NDEF_CACHE_FLAG_SYSINFO;
+      (void)ST_MEMCPY(&entry->sysInfo, &subCtx.t5t.sysInfo, sizeof(ndefSystemInformation));
+    }
+  }
+#endif
+  (void)ST_MEMCPY(entry->cc, ccBuf, entry->ccLen);
+
+  tagCacheEntry = entry;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefCacheSerialize(const ndefCache *cache, uint8_t *buf, uint32_t bufLen, uint32_t *outLen)
+{
+  const ndefCacheEntry *entry;
+  const ndefCacheEntry *next;
+  uint32_t              len;
+  uint32_t              entryLen;
+  uint32_t              prevUse;
+  uint32_t              i;
+  uint16_t              crc;
+  uint8_t               count;
+
+  if ((cache == NULL) || (outLen == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  len     = NDEF_CACHE_BLOB_HEADER_LEN;
+  count   = 0U;
+  prevUse = 0xFFFFFFFFU;
+
+  /* Emit entries by decreasing LRU stamp so that the order survives deserialization */
+  do {
+    next = NULL;
+    for (i = 0U; i < NDEF_CACHE_ENTRIES; i++) {
+      entry = &cache->entry[i];
+      if ((entry->type != (uint8_t)NDEF_DEV_NONE) && (entry->lastUse < prevUse) && ((next == NULL) || (entry->lastUse > next->lastUse))) {
+        next = entry;
+      }
+    }
+    if (next == NULL) {
+      break;
+    }
+    prevUse = next->lastUse;
+
+    entry    = next;
+    entryLen = 2U + (uint32_t)entry->uidLen + 1U + (uint32_t)entry->ccLen + NDEF_CACHE_BLOB_GEOMETRY_LEN;
+    entryLen += (((entry->flags & NDEF_CACHE_FLAG_SYSINFO) != 0U) ? NDEF_CACHE_BLOB_SYSINFO_LEN : 0U);
+
+    if (buf != NULL) {
+      if ((len + entryLen) > bufLen) {
+        return ST_ERR_NOMEM;
+      }
+      buf[len++] = entry->type;
+      buf[len++] = entry->uidLen;
+      (void)ST_MEMCPY(&buf[len], entry->uid, entry->uidLen);
+      len += entry->uidLen;
+      buf[len++] = entry->ccLen;
+      (void)ST_MEMCPY(&buf[len], entry->cc, entry->ccLen);
+      len += entry->ccLen;
+      buf[len++] = (uint8_t)(entry->tlvOffset >> 24U);
+      buf[len++] = (uint8_t)(entry->tlvOffset >> 16U);
+      buf[len++] = (uint8_t)(entry->tlvOffset >>  8U);
+      buf[len++] = (uint8_t)(entry->tlvOffset);
+      buf[len++] = entry->blockLen;
+      buf[len++] = entry->flags;
+      if ((entry->flags & NDEF_CACHE_FLAG_SYSINFO) != 0U) {
+        buf[len++] = (uint8_t)(entry->sysInfo.numberOfBlock >> 8U);
+        buf[len++] = (uint8_t)(entry->sysInfo.numberOfBlock);
+        buf[len++] = entry->sysInfo.infoFlags;
+        buf[len++] = entry->sysInfo.DFSID;
+        buf[len++] = entry->sysInfo.AFI;
+        buf[len++] = entry->sysInfo.blockSize;
+        buf[len++] = entry->sysInfo.ICRef;
+        (void)ST_MEMCPY(&buf[len], entry->sysInfo.supportedCmd, NDEF_NFCV_SUPPORTED_CMD_LEN);
+        len += NDEF_NFCV_SUPPORTED_CMD_LEN;
+      }
+    } else {
+      len += entryLen;
+    }
+    count++;
+  } while (prevUse > 0U);
+
+  if (buf != NULL) {
+    if ((len + NDEF_CACHE_BLOB_CRC_LEN) > bufLen) {
+      return ST_ERR_NOMEM;
+    }
+    buf[0] = (uint8_t)NDEF_CACHE_BLOB_MAGIC_0;
+    buf[1] = (uint8_t)NDEF_CACHE_BLOB_MAGIC_1;
+    buf[2] = NDEF_CACHE_BLOB_VERSION;
+    buf[3] = count;
+
+    crc = ndefCacheCrc(buf, len);
+    buf[len]      = (uint8_t)(crc >> 8U);
+    buf[len + 1U] = (uint8_t)(crc);
+  }
+
+  *outLen = len + NDEF_CACHE_BLOB_CRC_LEN;
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefCacheDeserialize(ndefCache *cache, const uint8_t *buf, uint32_t len)
+{
+  ndefCacheEntry  entry;
+  uint32_t        offset;
+  uint8_t         count;
+  uint8_t         i;
+
+  if ((cache == NULL) || (buf == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  (void)ndefCacheClear(cache);
+
+  if ((len < (NDEF_CACHE_BLOB_HEADER_LEN + NDEF_CACHE_BLOB_CRC_LEN)) || (buf[0] != (uint8_t)NDEF_CACHE_BLOB_MAGIC_0) || (buf[1] != (uint8_t)NDEF_CACHE_BLOB_MAGIC_1) || (buf[2] != NDEF_CACHE_BLOB_VERSION)) {
+    return ST_ERR_PROTO;
+  }
+  len -= NDEF_CACHE_BLOB_CRC_LEN;
+  if (GETU16(&buf[len]) != ndefCacheCrc(buf, len)) {
+    return ST_ERR_PROTO;
+  }
+  count  = buf[3];
+  offset = NDEF_CACHE_BLOB_HEADER_LEN;
+
+  for (i = 0U; i < count; i++) {
+    (void)ST_MEMSET(&entry, 0, sizeof(ndefCacheEntry));
+
+    if ((offset + 2U) > len) {
+      break;
+    }
+    entry.type   = buf[offset++];
+    entry.uidLen = buf[offset++];
+    if ((entry.uidLen > NDEF_CACHE_UID_MAX_LEN) || ((offset + entry.uidLen + 1U) > len)) {
+      break;
+    }
+    (void)ST_MEMCPY(entry.uid, &buf[offset], entry.uidLen);
+    offset += entry.uidLen;
+    entry.ccLen = buf[offset++];
+    if ((entry.ccLen > NDEF_CACHE_CC_MAX_LEN) || ((offset + entry.ccLen + NDEF_CACHE_BLOB_GEOMETRY_LEN) > len)) {
+      break;
+    }
+    (void)ST_MEMCPY(entry.cc, &buf[offset], entry.ccLen);
+    offset += entry.ccLen;
+    entry.tlvOffset = GETU32(&buf[offset]);
+    offset += 4U;
+    entry.blockLen = buf[offset++];
+    entry.flags    = buf[offset++];
+    if ((entry.flags & NDEF_CACHE_FLAG_SYSINFO) != 0U) {
+      if ((offset + NDEF_CACHE_BLOB_SYSINFO_LEN) > len) {
+        break;
+      }
+      entry.sysInfo.numberOfBlock = GETU16(&buf[offset]);
+      offset += 2U;
+      entry.sysInfo.infoFlags = buf[offset++];
+      entry.sysInfo.DFSID     = buf[offset++];
+      entry.sysInfo.AFI       = buf[offset++];
+      entry.sysInfo.blockSize = buf[offset++];
+      entry.sysInfo.ICRef     = buf[offset++];
+      (void)ST_MEMCPY(entry.sysInfo.supportedCmd, &buf[offset], NDEF_NFCV_SUPPORTED_CMD_LEN);
+      offset += NDEF_NFCV_SUPPORTED_CMD_LEN;
+      if (entry.uidLen == RFAL_NFCV_UID_LEN) {
+        (void)ST_MEMCPY(entry.sysInfo.UID, entry.uid, RFAL_NFCV_UID_LEN);
+      }
+    }
+    if (!ndefCacheEntryIsConsistent(&entry)) {
+      break;
+    }
+
+    /* Entries are stored most recent first: keep the first ones */
+    if (i < NDEF_CACHE_ENTRIES) {
+      entry.lastUse = (uint32_t)count - i;
+      (void)ST_MEMCPY(&cache->entry[i], &entry, sizeof(ndefCacheEntry));
+    }
+  }
+
+  if (i != count) {
+    (void)ndefCacheClear(cache);
+    return ST_ERR_PROTO;
+  }
+
+  cache->useCounter = count;
+  return ST_ERR_NONE;
+}
@@ -184,8 +184,15 @@ class NdefClass {
       areaLen = 0;
       memset(ccBuf, 0, ((sizeof(uint8_t)) * NDEF_CC_BUF_LEN));
       memset(&subCtx.t1t, 0, sizeof(ndefT1TContext));
-      ndefRecordPoolIndex = 0;
       memset(ndefRecordPool, 0, (sizeof(ndefRecord) * NDEF_MAX_RECORD));
+      tagCache = NULL;
+      tagCacheEntry = NULL;
+      workArea = NULL;
+      workAreaLen = 0;
+#if NDEF_FEATURE_BLOCK_CACHE
+      memset(&blockCache, 0, sizeof(ndefBlockCache));
+#endif
+      ndefTypeMapReset();
     }
 
     /*
@@ -213,6 +220,41 @@ class NdefClass {
     ReturnCode ndefPollerContextInitialization(rfalNfcDevice *dev);
 
 
+    /*!
+     *****************************************************************************
+     * \brief Supply the working buffers of the NDEF context
+     *
+     * The T3T and T4T contexts take their Tx/Rx and APDU buffers from this
+     * caller-owned area instead of the buffers embedded in the object, from
+     * the next ndefPollerContextInitialization() on. The area must stay valid
+     * while the context is in use and must not be shared with another
+     * NdefClass instance working at the same time.
+     * When built with NDEF_EXTERNAL_WORK_AREA set to 1 the embedded buffers
+     * are removed and T3T/T4T contexts require a work area.
+     *
+     * \param[in]   buf    : work area, NULL to go back to the embedded buffers
+     * \param[in]   bufLen : work area length
+     *****************************************************************************
+     */
+    void ndefPollerSetWorkArea(uint8_t *buf, uint32_t bufLen);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Work area length needed by a device
+     *
+     * Returns the length of the work area ndefPollerContextInitialization()
+     * takes for this device, so that it can be sized to the detected tag type
+     * (e.g. allocated from a pool) before the NDEF context is initialized.
+     *
+     * \param[in]   dev    : ndef Device
+     *
+     * \return Work area length in bytes, 0 when the device needs none
+     *****************************************************************************
+     */
+    uint32_t ndefPollerGetWorkAreaLen(const rfalNfcDevice *dev);
+
+
     /*!
      *****************************************************************************
      * \brief NDEF Detection procedure
@@ -316,6 +358,61 @@ class NdefClass {
     ReturnCode ndefPollerWriteRawMessage(const uint8_t *buf, uint32_t bufLen);
 
 
+    /*!
+     *****************************************************************************
+     * \brief Write raw NDEF message, changed blocks only
+     *
+     * This method compares the new message with the current one at the tag
+     * block granularity (T2T/T5T block, T3T 16-byte block, T4T MLc chunk) and
+     * writes only the blocks that differ. When the message length changes, the
+     * L-field/NLEN is reset before and updated after the data as in
+     * ndefPollerWriteRawMessage(). On T3T the Attribute Information Block
+     * WriteFlag is always set ON before and OFF after the changed blocks.
+     * Prior to NDEF Write procedure, a successful ndefPollerNdefDetect()
+     * has to be performed.
+     *
+     * \param[in]   buf        : raw message buffer
+     * \param[in]   bufLen     : buffer length
+     * \param[in]   current    : current raw message as stored in the tag, or NULL to read it back from the tag
+     * \param[in]   currentLen : current raw message length, ignored if current is NULL
+     *
+     * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
+     * \return ST_ERR_REQUEST      : write failed
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_PROTO        : Protocol error
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefPollerWriteRawMessageDelta(const uint8_t *buf, uint32_t bufLen, const uint8_t *current, uint32_t currentLen);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Write raw NDEF message and verify it
+     *
+     * This method writes the message as ndefPollerWriteRawMessage() does, then
+     * reads it back chunk by chunk with the largest read the tag supports
+     * (T2T READ batch, T3T CHECK, T4T ReadBinary, T5T Read Multiple Blocks)
+     * and compares each chunk with buf, so that no second message buffer is
+     * needed. Failing blocks only are written again, up to NDEF_VERIFY_RETRIES
+     * times. The stored length is finally checked with a new NDEF detection.
+     * Prior to NDEF Write procedure, a successful ndefPollerNdefDetect()
+     * has to be performed.
+     *
+     * \param[in]   buf    : raw message buffer
+     * \param[in]   bufLen : buffer length
+     *
+     * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
+     * \return ST_ERR_WRITE        : read back data or length still differ after the retries
+     * \return ST_ERR_REQUEST      : write failed
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_PROTO        : Protocol error
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefPollerWriteRawMessageVerified(const uint8_t *buf, uint32_t bufLen);
+
+
     /*!
      *****************************************************************************
      * \brief Format Tag
@@ -337,6 +434,39 @@ class NdefClass {
     ReturnCode ndefPollerTagFormat(const ndefCapabilityContainer *cc, uint32_t options);
 
 
+    /*!
+     *****************************************************************************
+     * \brief Personalize Tag
+     *
+     * This method formats the tag with the given CC, writes the message and
+     * optionally locks the tag in one procedure. The tag image (CC, NDEF TLV,
+     * message, Terminator TLV) is planned up front from the CC and the context,
+     * nothing is read back from the tag, and written in ascending block order
+     * with the widest write command supported (T5T Write Multiple Blocks when
+     * advertised in the command list). The block holding the TLV L-field is
+     * written last. Lock options:
+     *  - NDEF_PERSONALIZE_LOCK_READ_ONLY : CC write access set to read-only
+     *  - NDEF_PERSONALIZE_LOCK_PERMANENT : read-only CC plus T2T static lock
+     *    bytes (static memory tags only) or T5T Lock Block on the T5T area
+     * Supported for T2T and T5T. Only a successful ndefPollerContextInitialization()
+     * is required.
+     *
+     * \param[in]   cc          : Capability Container to be written
+     * \param[in]   message     : Message to write
+     * \param[in]   lockOptions : NDEF_PERSONALIZE_LOCK_xxx
+     * \param[out]  report      : commands and timings (optional parameter, NULL may be used)
+     *
+     * \return ST_ERR_NOTSUPP      : Tag type or lock option not supported
+     * \return ST_ERR_NOMEM        : Message does not fit in the area described by cc
+     * \return ST_ERR_REQUEST      : write failed
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_PROTO        : Protocol error
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefPollerPersonalize(const ndefCapabilityContainer *cc, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report);
+
+
     /*!
      *****************************************************************************
      * \brief Write NDEF message length
@@ -361,6 +491,9 @@ class NdefClass {
     *
     * Write the NDEF message to the tag
     *
+    * The message is encoded on the fly: record headers and payload items are
+    * coalesced into tag blocks, no buffer holding the whole message is needed.
+    *
     * \param[in] message: Message to write
     *
     * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
@@ -373,6 +506,52 @@ class NdefClass {
     ReturnCode ndefPollerWriteMessage(const ndefMessage *message);
 
 
+    /*!
+     *****************************************************************************
+     * \brief Start reading the NDEF message record by record
+     *
+     * Prepare an incremental reader over the message found by ndefPollerNdefDetect().
+     * Records are then pulled with ndefPollerReaderNext(), reading from the tag only
+     * the bytes of each record, so the application can stop as soon as it has the
+     * record it needs.
+     *
+     * \param[out]  reader : Reader to initialize
+     * \param[in]   buf    : Working buffer, must hold the largest record to be decoded
+     * \param[in]   bufLen : Working buffer length, at least NDEF_RECORD_HEADER_LEN
+     *
+     * \return ST_ERR_WRONG_STATE  : NDEF Detect not performed or failed
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefPollerReaderInit(ndefReader *reader, uint8_t *buf, uint32_t bufLen);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Read the next record of the NDEF message
+     *
+     * Read the next record from the tag into the reader buffer and decode it.
+     * The record points into the reader buffer and is valid until the next call.
+     * Chunked records are not reassembled: each chunk is skipped and reported
+     * with ST_ERR_NOTSUPP, read such messages with ndefPollerReadRawMessage()
+     * and ndefMessageDecode().
+     *
+     * \param[in,out] reader : Reader
+     * \param[out]    record : Decoded record
+     *
+     * \return ST_ERR_NOTFOUND     : No more records
+     * \return ST_ERR_NOMEM        : Record larger than the buffer (reader->recordLen), record skipped
+     * \return ST_ERR_NOTSUPP      : Record chunk, chunk skipped
+     * \return ST_ERR_REQUEST      : read failed
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_PROTO        : Protocol error
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefPollerReaderNext(ndefReader *reader, ndefRecord *record);
+
+
     /*!
      *****************************************************************************
      * \brief Check Presence
@@ -1070,7 +1249,7 @@ class NdefClass {
      *
      * \param[in]   offset : file offset of where to star reading data; valid range 0000h-7FFFh
      * \param[in]   data   : data to be written
-     * \param[in]   len    : data length
+     * \param[in]   len    : data length, up to MLc (extended Lc above FFh)
      *
      * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
      * \return ST_ERR_REQUEST      : read failed (SW1SW2 <> 9000h)
@@ -1079,7 +1258,7 @@ class NdefClass {
      * \return ST_ERR_NONE         : No error
      *****************************************************************************
      */
-    ReturnCode ndefT4TPollerWriteBinary(uint16_t offset, const uint8_t *data, uint8_t len);
+    ReturnCode ndefT4TPollerWriteBinary(uint16_t offset, const uint8_t *data, uint16_t len);
 
 
     /*!
@@ -1091,7 +1270,7 @@ class NdefClass {
      *
      * \param[in]   offset : file offset of where to star reading data; valid range 0000h-7FFFh
      * \param[in]   data   : data to be written
-     * \param[in]   len    : data length
+     * \param[in]   len    : data length, up to MLc minus the ODO prefix
      *
      * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
      * \return ST_ERR_REQUEST      : read failed (SW1SW2 <> 9000h)
@@ -1100,7 +1279,7 @@ class NdefClass {
      * \return ST_ERR_NONE         : No error
      *****************************************************************************
      */
-    ReturnCode ndefT4TPollerWriteBinaryODO(uint32_t offset, const uint8_t *data, uint8_t len);
+    ReturnCode ndefT4TPollerWriteBinaryODO(uint32_t offset, const uint8_t *data, uint16_t len);
 
     /*!
      *****************************************************************************
@@ -1517,6 +1696,83 @@ class NdefClass {
     ReturnCode ndefT5TPollerEndWriteMessage(uint32_t messageLen);
 
 
+    /*
+    ******************************************************************************
+    * NDEF TAG CACHE FUNCTION PROTOTYPES
+    ******************************************************************************
+    */
+
+    /*!
+     *****************************************************************************
+     * \brief Attach a tag geometry cache
+     *
+     * Once attached, ndefPollerContextInitialization() looks up the tag UID in
+     * the cache and ndefPollerNdefDetect() stores the tag geometry (CC, NDEF TLV
+     * offset, T5T block length and System Information) after a successful
+     * detection. For a known T2T/T5T tag, the detection is then reduced to the
+     * CC read used as validation followed by the read of the NDEF TLV.
+     *
+     * \param[in] cache : Cache to be used, NULL to disable caching
+     *****************************************************************************
+     */
+    void ndefPollerSetCache(ndefCache *cache);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Clear a tag geometry cache
+     *
+     * \param[out] cache : Cache to be cleared
+     *
+     * \return ST_ERR_PARAM : Invalid parameter
+     * \return ST_ERR_NONE  : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefCacheClear(ndefCache *cache);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Serialize a tag geometry cache
+     *
+     * Serializes the cache into a compact binary blob, most recently used
+     * entries first, so that it can be stored in non volatile memory.
+     * If buf is NULL only the required length is returned.
+     *
+     * \param[in]  cache  : Cache to be serialized
+     * \param[out] buf    : Output buffer, may be NULL
+     * \param[in]  bufLen : Output buffer length
+     * \param[out] outLen : Length of the blob
+     *
+     * \return ST_ERR_PARAM : Invalid parameter
+     * \return ST_ERR_NOMEM : Output buffer too small
+     * \return ST_ERR_NONE  : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefCacheSerialize(const ndefCache *cache, uint8_t *buf, uint32_t bufLen, uint32_t *outLen);
+
+
+    /*!
+     *****************************************************************************
+     * \brief Deserialize a tag geometry cache
+     *
+     * Restores a cache from a blob produced by ndefCacheSerialize().
+     * Entries beyond NDEF_CACHE_ENTRIES are dropped (least recently used first)
+     * The blob is rejected if its CRC does not match or if an entry holds a
+     * geometry the detection never stores, e.g. a null T5T block length.
+     *
+     * \param[out] cache : Cache to be restored
+     * \param[in]  buf   : Blob
+     * \param[in]  len   : Blob length
+     *
+     * \return ST_ERR_PARAM  : Invalid parameter
+     * \return ST_ERR_PROTO  : Malformed or corrupted blob, cache is cleared
+     * \return ST_ERR_NONE   : No error
+     *****************************************************************************
+     */
+    ReturnCode ndefCacheDeserialize(ndefCache *cache, const uint8_t *buf, uint32_t len);
+
+
     /*
     ******************************************************************************
     * NDEF MESSAGE FUNCTION PROTOTYPES
@@ -1542,6 +1798,9 @@ class NdefClass {
      *
      * Return the message information
      *
+     * The length is recomputed from the records on each call, so it reflects
+     * any change made to a record or to its NDEF type since it was appended.
+     *
      * \param[in]  message
      * \param[out] info: e.g. message length in bytes, number of records
      *
@@ -1584,6 +1843,10 @@ class NdefClass {
      *
      * Convert a raw buffer to a message
      *
+     * Records are taken from the built-in pool of NDEF_MAX_RECORD records,
+     * the message is valid until the next call to this function.
+     * Use ndefMessageDecodeArena() for larger or coexisting messages.
+     *
      * \param[in]  bufPayload: Payload buffer to convert into message
      * \param[out] message:    Message created from the raw buffer
      *
@@ -1593,6 +1856,68 @@ class NdefClass {
     ReturnCode ndefMessageDecode(const ndefConstBuffer *bufPayload, ndefMessage *message);
 
 
+    /*!
+     *****************************************************************************
+     * Decode a raw buffer to an NDEF message using caller supplied records
+     *
+     * Convert a raw buffer to a message, taking the records from the arena.
+     * Chunked records are reassembled into one record whose payload references
+     * each chunk in place; every chunk still takes one record from the arena.
+     * Messages decoded from the same or different arenas remain valid until
+     * the arena is reset, so several messages can coexist.
+     * On error the records taken by this call are given back to the arena.
+     *
+     * \param[in]     bufPayload: Payload buffer to convert into message
+     * \param[out]    message:    Message created from the raw buffer
+     * \param[in,out] arena:      Arena providing the record storage
+     *
+     * \return ST_ERR_NOMEM if the arena runs out of records
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefMessageDecodeArena(const ndefConstBuffer *bufPayload, ndefMessage *message, ndefRecordArena *arena);
+
+
+    /*!
+     *****************************************************************************
+     * Initialize a record arena
+     *
+     * \param[out] arena:    Arena to initialize
+     * \param[in]  record:   Caller supplied array of records, e.g. one allocation
+     * \param[in]  capacity: Number of records in the array
+     *
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordArenaInit(ndefRecordArena *arena, ndefRecord *record, uint32_t capacity);
+
+
+    /*!
+     *****************************************************************************
+     * Reset a record arena
+     *
+     * All the messages decoded from this arena become invalid.
+     *
+     * \param[in,out] arena: Arena to reset
+     *
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordArenaReset(ndefRecordArena *arena);
+
+
+    /*!
+     *****************************************************************************
+     * Allocate a record from an arena
+     *
+     * \param[in,out] arena: Arena to allocate from
+     *
+     * \return the record or NULL if the arena is exhausted
+     *****************************************************************************
+     */
+    ndefRecord *ndefRecordArenaAlloc(ndefRecordArena *arena);
+
+
     /*!
      *****************************************************************************
      * Encode an NDEF message to a raw buffer
@@ -1780,12 +2105,48 @@ class NdefClass {
      * \param[in]  record:     Record to get the payload from
      * \param[out] bufPayload: Payload buffer
      *
+     * \return ST_ERR_NOMEM if the payload is chunked, only the first chunk is returned,
+     *         see ndefRecordJoinChunks() or ndefRecordGetPayloadItem()
      * \return ST_ERR_NONE if successful or a standard error code
      *****************************************************************************
      */
     ReturnCode ndefRecordGetPayload(const ndefRecord *record, ndefConstBuffer *bufPayload);
 
 
+    /*!
+     *****************************************************************************
+     * Set the NDEF record chunk length
+     *
+     * When encoded, a payload longer than chunkLength is split into chunked
+     * records (CF flag) of chunkLength bytes.
+     *
+     * \param[in] record:      Record
+     * \param[in] chunkLength: Chunk length, 0 to encode a single record
+     *
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordSetChunkLength(ndefRecord *record, uint32_t chunkLength);
+
+
+    /*!
+     *****************************************************************************
+     * Join the chunks of a decoded NDEF record
+     *
+     * A chunked record decoded by ndefMessageDecode() references the payload of
+     * each chunk in place. This copies the payload into a contiguous buffer so
+     * that the record can be processed by ndefRecordGetPayload() and the types.
+     *
+     * \param[in,out] record:     Record
+     * \param[in,out] bufPayload: Buffer receiving the payload, length updated
+     *
+     * \return ST_ERR_NOMEM if the buffer is too small, required length in bufPayload->length
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordJoinChunks(ndefRecord *record, ndefBuffer *bufPayload);
+
+
     /*!
      *****************************************************************************
      * Decode a raw buffer to create an NDEF record
@@ -1923,6 +2284,24 @@ class NdefClass {
     ReturnCode ndefRecordToWifi(const ndefRecord *record, ndefType *wifi);
 
 
+    /*!
+     *****************************************************************************
+     * Convert one Credential of an NDEF record to a wifi type
+     *
+     * The WSC attributes are walked once, TLV by TLV. The number of Credentials
+     * found is returned in data.wifi.credentialCount.
+     *
+     * \param[in]  record: Record to convert
+     * \param[in]  index:  Credential index, 0 for the first one
+     * \param[out] wifi:   The converted wifi type
+     *
+     * \return ST_ERR_NOTFOUND if there is no such Credential
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordToWifiCredential(const ndefRecord *record, uint32_t index, ndefType *wifi);
+
+
     /*!
      *****************************************************************************
      * Convert a wifi type to an NDEF record
@@ -2049,6 +2428,27 @@ class NdefClass {
     ReturnCode ndefRecordToVCard(const ndefRecord *record, ndefType *vCard);
 
 
+    /*!
+     *****************************************************************************
+     * Convert an NDEF record to a vCard using caller-provided entries
+     *
+     * Unlike ndefRecordToVCard(), the number of entries is not limited to
+     * NDEF_VCARD_ENTRY_MAX. BEGIN, VERSION and END are not stored as entries.
+     * Values of folded lines are returned as they appear in the payload.
+     *
+     * \param[in]  record:   Record to convert
+     * \param[out] vCard:    The converted vCard type
+     * \param[out] entries:  Entry array to fill, must remain valid while vCard is used
+     * \param[in]  capacity: Number of entries in the array
+     *
+     * \return ST_ERR_NOMEM  if the vCard holds more than capacity entries
+     * \return ST_ERR_SYNTAX if BEGIN, VERSION or END is missing
+     * \return ST_ERR_NONE   if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRecordToVCardEntries(const ndefRecord *record, ndefType *vCard, ndefVCardEntry *entries, uint32_t capacity);
+
+
     /*!
      *****************************************************************************
      * Convert a vCard type to an NDEF record
@@ -2251,6 +2651,25 @@ class NdefClass {
     ReturnCode ndefRtdUri(ndefType *uri, uint8_t protocol, const ndefConstBuffer *bufUriString);
 
 
+    /*!
+     *****************************************************************************
+     * Initialize URI RTD types and convert them to NDEF records in one call
+     *
+     * The protocol of each URI string is autodetected.
+     * The records point to the types, which in turn point to the URI strings:
+     * all three arrays must remain valid while the records are in use.
+     *
+     * \param[out] uris:          Array of count types to initialize
+     * \param[out] records:       Array of count records to fill
+     * \param[in]  bufUriStrings: Array of count URI string buffers
+     * \param[in]  count:         Number of URIs
+     *
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefRtdUriBatch(ndefType *uris, ndefRecord *records, const ndefConstBuffer *bufUriStrings, uint32_t count);
+
+
     /*!
      *****************************************************************************
      * Get URI RTD type content
@@ -2368,13 +2787,62 @@ class NdefClass {
     ReturnCode ndefRecordTypeStringToTypeId(const ndefRecord *record, ndefTypeId *typeId);
 
 
+    /*!
+     *****************************************************************************
+     * Register an NDEF record type
+     *
+     * Associate a TNF and type string to a type Id, so that records of that type
+     * are identified by ndefRecordTypeStringToTypeId(). The built-in types are
+     * registered at construction. Lookup is a hash, it does not depend on the
+     * number of registered types. The type string is referenced, not copied.
+     *
+     * With a handler, ndefRecordToType() and ndefTypeToRecord() process the
+     * application type like a built-in one: the payload is referenced in place,
+     * passed to handler->decode, and encoded through handler->getPayloadItem.
+     *
+     * \param[in] tnf:           TNF
+     * \param[in] bufTypeString: Type string, must remain valid
+     * \param[in] typeId:        Type Id, NDEF_TYPE_ID_COUNT and above for application types
+     * \param[in] handler:       Application type handler, must remain valid, NULL for none
+     *
+     * \return ST_ERR_PARAM if already registered, or handler given for a built-in or used Id
+     * \return ST_ERR_NOMEM if NDEF_TYPE_MAP_SIZE is reached
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefTypeRegister(uint8_t tnf, const ndefConstBuffer8 *bufTypeString, ndefTypeId typeId, const ndefTypeHandler *handler = NULL);
+
+
+    /*!
+     *****************************************************************************
+     * Initialize an application type
+     *
+     * Prepare a type registered with a handler, to be converted to a record
+     * with ndefTypeToRecord().
+     *
+     * \param[out] type:       Type to initialize
+     * \param[in]  typeId:     Registered application type Id
+     * \param[in]  bufPayload: Payload used by the default payload handlers, may be NULL
+     * \param[in]  data:       Application data for the handler, may be NULL
+     *
+     * \return ST_ERR_NONE if successful or a standard error code
+     *****************************************************************************
+     */
+    ReturnCode ndefCustomTypeInit(ndefType *type, ndefTypeId typeId, const ndefConstBuffer *bufPayload, void *data);
+
+
     /*!
      *****************************************************************************
      * Convert a record to a supported type
      *
+     * Types reference the record payload in place. The payload of a chunked
+     * record is not contiguous and must first be joined with
+     * ndefRecordJoinChunks().
+     *
      * \param[in]  record: Record to read
      * \param[out] type:   Type to store the converted record
      *
+     * \return ST_ERR_NOMEM if the record payload is chunked
      * \return ST_ERR_NONE if successful or a standard error code
      *****************************************************************************
      */
@@ -2431,10 +2899,18 @@ class NdefClass {
     uint8_t                      ccBuf[NDEF_CC_BUF_LEN];       /*!< buffer for CC                                      */
     union {
       ndefT1TContext t1t;                                    /*!< T1T context                                        */
+#if NDEF_FEATURE_T2T
       ndefT2TContext t2t;                                    /*!< T2T context                                        */
+#endif
+#if NDEF_FEATURE_T3T
       ndefT3TContext t3t;                                    /*!< T3T context                                        */
+#endif
+#if NDEF_FEATURE_T4T
       ndefT4TContext t4t;                                    /*!< T4T context                                        */
+#endif
+#if NDEF_FEATURE_T5T
       ndefT5TContext t5t;                                    /*!< T5T context                                        */
+#endif
     } subCtx;                                                  /*!< Sub-context union                                  */
 
 
@@ -2442,7 +2918,9 @@ class NdefClass {
 
     ndefDeviceType ndefPollerGetDeviceType(rfalNfcDevice *dev);
     ReturnCode ndefT2TPollerReadBlock(uint16_t blockAddr, uint8_t *buf);
+    ReturnCode ndefT2TPollerReadBlocks(uint16_t blockAddr, uint8_t nbReads, uint8_t *buf);
     ReturnCode ndefT2TPollerWriteBlock(uint16_t blockAddr, const uint8_t *buf);
+    ReturnCode ndefT2TPollerPersonalize(const ndefCapabilityContainer *cc, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report);
     ReturnCode ndefT3TPollerReadBlocks(uint16_t blockNum, uint8_t nbBlocks, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
     ReturnCode ndefT3TPollerReadAttributeInformationBlock();
     ReturnCode ndefT3TPollerWriteBlocks(uint16_t blockNum, uint8_t nbBlocks, const uint8_t *dataBlocks);
@@ -2452,27 +2930,76 @@ class NdefClass {
     ReturnCode ndefT4TReadAndParseCCFile();
     ReturnCode ndefT5TPollerReadSingleBlock(uint16_t blockNum, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
     ReturnCode ndefT5TGetSystemInformation(bool extended);
+    uint8_t ndefT5TEncodeCC(uint8_t *buf);
     ReturnCode ndefT5TWriteCC();
+    ReturnCode ndefT5TPollerReadAhead(void);
+    ReturnCode ndefT5TPollerProbe(void);
     ReturnCode ndefT5TPollerWriteSingleBlock(uint16_t blockNum, const uint8_t *wrData);
+    ReturnCode ndefT5TPollerWriteMultipleBlocks(uint16_t firstBlockNum, uint8_t numOfBlocks, const uint8_t *wrData);
+    ReturnCode ndefT5TPollerPersonalize(const ndefCapabilityContainer *cc, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report);
     ReturnCode ndefT5TPollerReadMultipleBlocks(uint16_t firstBlockNum, uint8_t numOfBlocks, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
-    ndefRecord *ndefAllocRecord(void);
+    uint32_t ndefPollerBlockLen(void);
+    void ndefPollerSinkInit(ndefWriteSink *sink, uint32_t offset);
+    ReturnCode ndefPollerSinkWrite(ndefWriteSink *sink, const uint8_t *buf, uint32_t len);
+    ReturnCode ndefPollerSinkFlush(ndefWriteSink *sink);
+    void ndefPollerPersonalizeInit(ndefPersonalizePlan *plan, uint32_t blockLen, uint32_t runMax, uint32_t headOffset);
+    ReturnCode ndefPollerPersonalizeWriteBlocks(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *buf, uint32_t len);
+    ReturnCode ndefPollerPersonalizeFlush(ndefPersonalizePlan *plan);
+    ReturnCode ndefPollerPersonalizeEmit(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *buf, uint32_t len);
+    ReturnCode ndefPollerPersonalizeStream(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *prefix, uint32_t prefixLen, const ndefMessage *message, bool terminator);
+    void ndefPollerDropReadCache(void);
+    ReturnCode ndefPollerReadBack(uint32_t offset, uint32_t len, uint8_t *buf);
+    ReturnCode ndefRecordEncodeChunkHeader(const ndefRecord *record, bool first, bool last, uint32_t chunkLen, ndefBuffer *bufHeader);
+    ReturnCode ndefRecordEmitBytes(ndefBuffer *bufRecord, uint32_t *offset, ndefWriteSink *sink, const uint8_t *buf, uint32_t len);
+    ReturnCode ndefRecordEmit(const ndefRecord *record, ndefBuffer *bufRecord, uint32_t *offset, ndefWriteSink *sink);
     ReturnCode ndefRecordPayloadEncode(const ndefRecord *record, ndefBuffer *bufPayload);
     ReturnCode ndefPayloadToWifi(const ndefConstBuffer *bufPayload, ndefType *wifi);
-    ReturnCode ndefVCardFindMarker(const ndefConstBuffer *bufPayload, const ndefConstBuffer *bufMarker, uint32_t *offset);
-    ReturnCode ndefVCardExtractLine(const ndefConstBuffer *bufPayload, const ndefConstBuffer *bufMarker, ndefConstBuffer *bufLine);
-    ReturnCode ndefVCardParseLine(const ndefConstBuffer *bufLine, ndefVCardEntry *vCardEntry);
-    bool ndefIsVCardTypeFound(const ndefTypeVCard *vCard, const uint8_t *typeString);
-    ReturnCode ndefPayloadToVcard(const ndefConstBuffer *bufPayload, ndefType *vCard);
+    ReturnCode ndefPayloadToWifiCredential(const ndefConstBuffer *bufPayload, uint32_t index, ndefType *wifi);
+    ReturnCode ndefWifiParseAttributes(const ndefConstBuffer *bufAttributes, bool nested, uint32_t index, ndefTypeWifi *wifiConfig);
+    ReturnCode ndefVCardParseLine(const uint8_t *line, uint32_t semicolon, uint32_t colon, uint32_t lineEnd, ndefVCardEntry *vCardEntry);
+    ReturnCode ndefPayloadToVcard(const ndefConstBuffer *bufPayload, ndefType *vCard, ndefVCardEntry *entries, uint32_t capacity);
     ReturnCode ndefPayloadToRtdDeviceInfo(const ndefConstBuffer *bufDevInfo, ndefType *devInfo);
     ReturnCode ndefPayloadToRtdText(const ndefConstBuffer *bufText, ndefType *text);
     ReturnCode ndefRtdUriProtocolAutodetect(uint8_t *protocol, ndefConstBuffer *bufUriString);
     ReturnCode ndefPayloadToRtdUri(const ndefConstBuffer *bufUri, ndefType *uri);
     ReturnCode ndefTypeStringToTypeId(uint8_t tnf, const ndefConstBuffer8 *bufTypeString, ndefTypeId *typeId);
+    uint32_t ndefTypeHash(uint8_t tnf, const ndefConstBuffer8 *bufTypeString);
+    ndefTypeMapEntry *ndefTypeMapFind(uint8_t tnf, const ndefConstBuffer8 *bufTypeString);
+    void ndefTypeMapReset(void);
+    const ndefTypeMapEntry *ndefTypeMapFindId(ndefTypeId typeId);
+    ReturnCode ndefRecordToCustomType(const ndefRecord *record, ndefTypeId typeId, ndefType *type);
+    ReturnCode ndefCustomTypeToRecord(const ndefType *type, ndefRecord *record);
+    ndefCacheEntry *ndefCacheLookup(const rfalNfcDevice *dev);
+    void ndefCacheStore(void);
+    bool ndefCacheIsValid(uint32_t ccLen);
+    void ndefCacheDrop(void);
+    void ndefBlockCacheInvalidate(void);
+    ndefBlockCacheEntry *ndefBlockCacheFind(uint16_t blockNum);
+    uint32_t ndefBlockCacheRunMax(void);
+    ReturnCode ndefBlockCacheReadDevice(uint16_t blockNum, uint8_t *buf);
+    ReturnCode ndefBlockCacheWriteDevice(uint16_t blockNum, uint8_t nbBlocks, const uint8_t *buf);
+    void ndefBlockCacheFill(uint16_t blockNum, const uint8_t *data);
+    void ndefBlockCacheUpdate(uint16_t blockNum, uint32_t nbBlocks, const uint8_t *data, bool written);
+    ReturnCode ndefBlockCacheGet(uint16_t blockNum, bool fetch, ndefBlockCacheEntry **entry);
+    ReturnCode ndefBlockCacheRead(uint32_t offset, uint32_t len, uint8_t *buf);
+    ReturnCode ndefBlockCacheWrite(uint32_t offset, const uint8_t *buf, uint32_t len);
+    ReturnCode ndefBlockCacheFlush(void);
 
     RfalNfcClass *rfal_nfc;
 
-    uint8_t ndefRecordPoolIndex;
+    ndefCache *tagCache;
+    ndefCacheEntry *tagCacheEntry;
+
+    uint8_t *workArea;
+    uint32_t workAreaLen;
+
+#if NDEF_FEATURE_BLOCK_CACHE
+    ndefBlockCache blockCache;
+#endif
+
     ndefRecord ndefRecordPool[NDEF_MAX_RECORD];
+
+    ndefTypeMapEntry typeMap[NDEF_TYPE_MAP_SIZE];
 };
 
 #endif /* NDEF_CLASS_H */
@@ -64,17 +64,6 @@
  */
 
 
-/*****************************************************************************/
-ndefRecord *NdefClass::ndefAllocRecord(void)
-{
-  if (ndefRecordPoolIndex >= NDEF_MAX_RECORD) {
-    return NULL;
-  }
-
-  return &ndefRecordPool[ndefRecordPoolIndex++];
-}
-
-
 /*
  ******************************************************************************
  * GLOBAL FUNCTIONS
@@ -90,15 +79,53 @@ ReturnCode NdefClass::ndefMessageInit(ndefMessage *message)
   }
 
   message->record           = NULL;
+  message->tail             = NULL;
   message->info.length      = 0;
   message->info.recordCount = 0;
 
-  ndefRecordPoolIndex = 0;
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordArenaInit(ndefRecordArena *arena, ndefRecord *record, uint32_t capacity)
+{
+  if ((arena == NULL) || ((record == NULL) && (capacity != 0U))) {
+    return ST_ERR_PARAM;
+  }
+
+  arena->record   = record;
+  arena->capacity = capacity;
+  arena->count    = 0;
 
   return ST_ERR_NONE;
 }
 
 
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordArenaReset(ndefRecordArena *arena)
+{
+  if (arena == NULL) {
+    return ST_ERR_PARAM;
+  }
+
+  arena->count = 0;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ndefRecord *NdefClass::ndefRecordArenaAlloc(ndefRecordArena *arena)
+{
+  if ((arena == NULL) || (arena->count >= arena->capacity)) {
+    return NULL;
+  }
+
+  return &arena->record[arena->count++];
+}
+
+
 /*****************************************************************************/
 ReturnCode NdefClass::ndefMessageGetInfo(const ndefMessage *message, ndefMessageInfo *info)
 {
@@ -129,13 +156,12 @@ ReturnCode NdefClass::ndefMessageGetInfo(const ndefMessage *message, ndefMessage
 /*****************************************************************************/
 uint32_t NdefClass::ndefMessageGetRecordCount(const ndefMessage *message)
 {
-  ndefMessageInfo info;
-
-  if (ndefMessageGetInfo(message, &info) == ST_ERR_NONE) {
-    return info.recordCount;
+  if (message == NULL) {
+    return 0;
   }
 
-  return 0;
+  /* Records cannot be added or removed without updating the count */
+  return message->info.recordCount;
 }
 
 
@@ -160,21 +186,15 @@ ReturnCode NdefClass::ndefMessageAppend(ndefMessage *message, ndefRecord *record
 
     message->record = record;
   } else {
-    ndefRecord *current = message->record;
-
-    /* Go through the list of records */
-    while (current->next != NULL) {
-      current = current->next;
-    }
-
     /* Clear the Message End bit to the record before the one being appended */
-    ndefHeaderClearME(current);
+    ndefHeaderClearME(message->tail);
 
     /* Append to the last record */
-    current->next = record;
+    message->tail->next = record;
   }
 
-  message->info.length      += ndefRecordGetLength(record);
+  message->tail = record;
+
   message->info.recordCount += 1U;
 
   return ST_ERR_NONE;
@@ -183,11 +203,26 @@ ReturnCode NdefClass::ndefMessageAppend(ndefMessage *message, ndefRecord *record
 
 /*****************************************************************************/
 ReturnCode NdefClass::ndefMessageDecode(const ndefConstBuffer *bufPayload, ndefMessage *message)
+{
+  ndefRecordArena arena;
+
+  /* Records decoded with the default pool are valid until the next call */
+  (void)ndefRecordArenaInit(&arena, ndefRecordPool, NDEF_MAX_RECORD);
+
+  return ndefMessageDecodeArena(bufPayload, message, &arena);
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefMessageDecodeArena(const ndefConstBuffer *bufPayload, ndefMessage *message, ndefRecordArena *arena)
 {
   ReturnCode err;
   uint32_t offset;
+  uint32_t arenaCount;
+  ndefRecord *head;
+  ndefRecord *lastChunk;
 
-  if ((bufPayload == NULL) || (bufPayload->buffer == NULL) || (message == NULL)) {
+  if ((bufPayload == NULL) || (bufPayload->buffer == NULL) || (message == NULL) || (arena == NULL)) {
     return ST_ERR_PARAM;
   }
 
@@ -196,28 +231,72 @@ ReturnCode NdefClass::ndefMessageDecode(const ndefConstBuffer *bufPayload, ndefM
     return err;
   }
 
-  offset = 0;
+  /* Give the records back to the arena if the message cannot be decoded */
+  arenaCount = arena->count;
+
+  head      = NULL;
+  lastChunk = NULL;
+  offset    = 0;
   while (offset < bufPayload->length) {
     ndefConstBuffer bufRecord;
-    ndefRecord *record = ndefAllocRecord();
+    ndefRecord *record = ndefRecordArenaAlloc(arena);
     if (record == NULL) {
-      return ST_ERR_NOMEM;
+      err = ST_ERR_NOMEM;
+      break;
     }
     bufRecord.buffer = &bufPayload->buffer[offset];
     bufRecord.length =  bufPayload->length - offset;
     err = ndefRecordDecode(&bufRecord, record);
     if (err != ST_ERR_NONE) {
-      return err;
+      break;
     }
     offset += ndefRecordGetLength(record);
 
+    if (head != NULL) {
+      /* Middle or terminating chunk: no type, no id, TNF unchanged */
+      if ((ndefHeaderTNF(record) != NDEF_TNF_UNCHANGED) || (record->typeLength != 0U) || ndefHeaderIsSetIL(record)) {
+        err = ST_ERR_PROTO;
+        break;
+      }
+      lastChunk->chunk = record;
+      lastChunk        = record;
+      if (ndefHeaderIsSetCF(record)) {
+        continue;
+      }
+      /* Chunks reassembled: the head now describes the whole record, payload is a scatter view over the chunks */
+      record = head;
+      head   = NULL;
+      ndefHeaderSetValueCF(record, 0U);
+      ndefHeaderSetValueSR(record, (ndefRecordGetPayloadLength(record) <= NDEF_SHORT_RECORD_LENGTH_MAX) ? 1U : 0U);
+    } else if (ndefHeaderTNF(record) == NDEF_TNF_UNCHANGED) {
+      err = ST_ERR_PROTO;
+      break;
+    } else if (ndefHeaderIsSetCF(record)) {
+      /* Initial chunk */
+      head      = record;
+      lastChunk = record;
+      continue;
+    } else {
+      /* Single record */
+    }
+
     err = ndefMessageAppend(message, record);
     if (err != ST_ERR_NONE) {
-      return err;
+      break;
     }
   }
 
-  return ST_ERR_NONE;
+  if ((err == ST_ERR_NONE) && (head != NULL)) {
+    /* Missing terminating chunk */
+    err = ST_ERR_PROTO;
+  }
+
+  if (err != ST_ERR_NONE) {
+    arena->count = arenaCount;
+    (void)ndefMessageInit(message);
+  }
+
+  return err;
 }
 
 
@@ -76,10 +76,19 @@ typedef struct {
 } ndefMessageInfo;
 
 
+/*! Record arena: caller supplied storage the message decoder allocates records from */
+typedef struct {
+  ndefRecord *record;   /*!< Record storage               */
+  uint32_t    capacity; /*!< Number of records in storage */
+  uint32_t    count;    /*!< Number of records allocated  */
+} ndefRecordArena;
+
+
 /*! NDEF message */
 struct ndefMessageStruct {
-  ndefRecord     *record; /*!< Pointer to a record */
-  ndefMessageInfo info;   /*!< Message information, e.g. length in bytes, record count */
+  ndefRecord     *record;    /*!< Pointer to a record */
+  ndefRecord     *tail;      /*!< Pointer to the last record */
+  ndefMessageInfo info;      /*!< Message information, only the record count is maintained */
 };
 
 
@@ -95,19 +95,56 @@ ReturnCode NdefClass::ndefPollerContextInitialization(rfalNfcDevice *dev)
   /* Save NDEF Device type */
   ndefPollerGetDeviceType(dev);
 
+  /* Look for this tag geometry in the cache */
+  tagCacheEntry = ndefCacheLookup(dev);
+
   switch (type) {
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerContextInitialization(dev);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerContextInitialization(dev);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerContextInitialization(dev);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerContextInitialization(dev);
+#endif
+  }
+}
+
+/*******************************************************************************/
+void NdefClass::ndefPollerSetWorkArea(uint8_t *buf, uint32_t bufLen)
+{
+  workArea    = buf;
+  workAreaLen = (buf != NULL) ? bufLen : 0U;
+}
+
+/*******************************************************************************/
+uint32_t NdefClass::ndefPollerGetWorkAreaLen(const rfalNfcDevice *dev)
+{
+  if (dev == NULL) {
+    return 0U;
+  }
+
+  switch (dev->type) {
+    case RFAL_NFC_LISTEN_TYPE_NFCA:
+      return (dev->dev.nfca.type == RFAL_NFCA_T4T) ? (uint32_t)NDEF_T4T_WORK_AREA_LEN : 0U;
+    case RFAL_NFC_LISTEN_TYPE_NFCB:
+      return (uint32_t)NDEF_T4T_WORK_AREA_LEN;
+    case RFAL_NFC_LISTEN_TYPE_NFCF:
+      return (uint32_t)NDEF_T3T_WORK_AREA_LEN;
+    default:
+      return 0U;
   }
 }
 
@@ -123,14 +160,22 @@ ReturnCode NdefClass::ndefPollerNdefDetect(ndefInfo *info)
     case NDEF_DEV_T1T:
     default:
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerNdefDetect(info);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerNdefDetect(info);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerNdefDetect(info);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerNdefDetect(info);
+#endif
   }
 }
 
@@ -145,15 +190,24 @@ ReturnCode NdefClass::ndefPollerReadRawMessage(uint8_t *buf, uint32_t bufLen, ui
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(bufLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerReadRawMessage(buf, bufLen, rcvdLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerReadRawMessage(buf, bufLen, rcvdLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerReadRawMessage(buf, bufLen, rcvdLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerReadRawMessage(buf, bufLen, rcvdLen);
+#endif
   }
 }
 
@@ -168,15 +222,25 @@ ReturnCode NdefClass::ndefPollerReadBytes(uint32_t offset, uint32_t len, uint8_t
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(offset);
+      NO_WARNING(len);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerReadBytes(offset, len, buf, rcvdLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerReadBytes(offset, len, buf, rcvdLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerReadBytes(offset, len, buf, rcvdLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerReadBytes(offset, len, buf, rcvdLen);
+#endif
   }
 }
 
@@ -191,15 +255,24 @@ ReturnCode NdefClass::ndefPollerWriteRawMessage(const uint8_t *buf, uint32_t buf
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(bufLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerWriteRawMessage(buf, bufLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerWriteRawMessage(buf, bufLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerWriteRawMessage(buf, bufLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerWriteRawMessage(buf, bufLen);
+#endif
   }
 }
 
@@ -210,15 +283,25 @@ ReturnCode NdefClass::ndefPollerTagFormat(const ndefCapabilityContainer *cc_p, u
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(cc_p);
+      NO_WARNING(options);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerTagFormat(cc_p, options);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerTagFormat(cc_p, options);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerTagFormat(cc_p, options);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerTagFormat(cc_p, options);
+#endif
   }
 }
 
@@ -229,21 +312,32 @@ ReturnCode NdefClass::ndefPollerWriteRawMessageLen(uint32_t rawMessageLen)
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(rawMessageLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerWriteRawMessageLen(rawMessageLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerWriteRawMessageLen(rawMessageLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerWriteRawMessageLen(rawMessageLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerWriteRawMessageLen(rawMessageLen);
+#endif
   }
 }
 
 /*******************************************************************************/
 ReturnCode NdefClass::ndefPollerWriteBytes(uint32_t offset, const uint8_t *buf, uint32_t len)
 {
+  ReturnCode ret;
+
   if (buf == NULL) {
     return ST_ERR_PARAM;
   }
@@ -252,16 +346,39 @@ ReturnCode NdefClass::ndefPollerWriteBytes(uint32_t offset, const uint8_t *buf,
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(offset);
+      NO_WARNING(len);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
-      return ndefT2TPollerWriteBytes(offset, buf, len);
+      ret = ndefT2TPollerWriteBytes(offset, buf, len);
+      break;
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
-      return ndefT3TPollerWriteBytes(offset, buf, len);
+      ret = ndefT3TPollerWriteBytes(offset, buf, len);
+      break;
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerWriteBytes(offset, buf, len);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
-      return ndefT5TPollerWriteBytes(offset, buf, len);
+      ret = ndefT5TPollerWriteBytes(offset, buf, len);
+      break;
+#endif
+  }
+  if (ret != ST_ERR_NONE) {
+    return ret;
   }
+
+#if NDEF_FEATURE_BLOCK_CACHE
+  /* The bytes are on the tag when the call returns */
+  return ndefBlockCacheFlush();
+#else
+  return ST_ERR_NONE;
+#endif
 }
 
 /*******************************************************************************/
@@ -272,14 +389,22 @@ ReturnCode NdefClass::ndefPollerCheckPresence()
     case NDEF_DEV_T1T:
     default:
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerCheckPresence();
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerCheckPresence();
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerCheckPresence();
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerCheckPresence();
+#endif
   }
 }
 
@@ -290,15 +415,24 @@ ReturnCode NdefClass::ndefPollerCheckAvailableSpace(uint32_t messageLen)
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(messageLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerCheckAvailableSpace(messageLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerCheckAvailableSpace(messageLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerCheckAvailableSpace(messageLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerCheckAvailableSpace(messageLen);
+#endif
   }
 }
 
@@ -309,15 +443,24 @@ ReturnCode NdefClass::ndefPollerBeginWriteMessage(uint32_t messageLen)
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(messageLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerBeginWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerBeginWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerBeginWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerBeginWriteMessage(messageLen);
+#endif
   }
 }
 
@@ -328,29 +471,144 @@ ReturnCode NdefClass::ndefPollerEndWriteMessage(uint32_t messageLen)
     case NDEF_DEV_NONE:
     case NDEF_DEV_T1T:
     default:
+      NO_WARNING(messageLen);
       return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
     case NDEF_DEV_T2T:
       return ndefT2TPollerEndWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T3T
     case NDEF_DEV_T3T:
       return ndefT3TPollerEndWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T4T
     case NDEF_DEV_T4T:
       return ndefT4TPollerEndWriteMessage(messageLen);
+#endif
+#if NDEF_FEATURE_T5T
     case NDEF_DEV_T5T:
       return ndefT5TPollerEndWriteMessage(messageLen);
+#endif
+  }
+}
+
+/*******************************************************************************/
+uint32_t NdefClass::ndefPollerBlockLen(void)
+{
+  switch (type) {
+#if NDEF_FEATURE_T2T
+    case NDEF_DEV_T2T:
+      return NDEF_T2T_BLOCK_SIZE;
+#endif
+#if NDEF_FEATURE_T3T
+    case NDEF_DEV_T3T:
+      return NDEF_T3T_BLOCK_SIZE;
+#endif
+#if NDEF_FEATURE_T5T
+    case NDEF_DEV_T5T:
+      return subCtx.t5t.blockLen;
+#endif
+#if NDEF_FEATURE_T4T
+    case NDEF_DEV_T4T:
+      /* No block constraint: one UPDATE BINARY carries up to MLc bytes */
+      return subCtx.t4t.curMLc;
+#endif
+    default:
+      return 0U;
   }
 }
 
+/*******************************************************************************/
+void NdefClass::ndefPollerSinkInit(ndefWriteSink *sink, uint32_t offset)
+{
+  sink->blockLen = ndefPollerBlockLen();
+
+  if ((sink->blockLen == 0U) || (sink->blockLen > NDEF_WRITE_SINK_BUF_LEN)) {
+    sink->blockLen = NDEF_WRITE_SINK_BUF_LEN;
+  }
+
+  sink->offset = offset;
+  sink->len    = 0U;
+  sink->plan   = NULL;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerSinkFlush(ndefWriteSink *sink)
+{
+  ReturnCode err;
+
+  if (sink->len == 0U) {
+    return ST_ERR_NONE;
+  }
+
+  if (sink->plan != NULL) {
+    err = ndefPollerPersonalizeEmit(sink->plan, sink->offset, sink->buf, sink->len);
+  } else {
+    err = ndefPollerWriteBytes(sink->offset, sink->buf, sink->len);
+  }
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  sink->offset += sink->len;
+  sink->len     = 0U;
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerSinkWrite(ndefWriteSink *sink, const uint8_t *buf, uint32_t len)
+{
+  ReturnCode err;
+  uint32_t   room;
+  uint32_t   directLen;
+
+  while (len != 0U) {
+    if ((sink->len == 0U) && ((sink->offset % sink->blockLen) == 0U) && (len >= sink->blockLen)) {
+      /* Aligned and nothing pending: whole blocks go straight to the tag */
+      directLen = len - (len % sink->blockLen);
+      if (sink->plan != NULL) {
+        err = ndefPollerPersonalizeEmit(sink->plan, sink->offset, buf, directLen);
+      } else {
+        err = ndefPollerWriteBytes(sink->offset, buf, directLen);
+      }
+      if (err != ST_ERR_NONE) {
+        return err;
+      }
+      sink->offset += directLen;
+      buf           = &buf[directLen];
+      len          -= directLen;
+      continue;
+    }
+
+    /* Fill up to the next block boundary */
+    room = sink->blockLen - ((sink->offset + sink->len) % sink->blockLen);
+    if (room > len) {
+      room = len;
+    }
+    (void)ST_MEMCPY(&sink->buf[sink->len], buf, room);
+    sink->len += room;
+    buf        = &buf[room];
+    len       -= room;
+
+    if (((sink->offset + sink->len) % sink->blockLen) == 0U) {
+      err = ndefPollerSinkFlush(sink);
+      if (err != ST_ERR_NONE) {
+        return err;
+      }
+    }
+  }
+
+  return ST_ERR_NONE;
+}
+
 /*******************************************************************************/
 ReturnCode NdefClass::ndefPollerWriteMessage(const ndefMessage *message)
 {
   ReturnCode      err;
   ndefMessageInfo info;
   ndefRecord     *record;
-  uint8_t         recordHeaderBuf[NDEF_RECORD_HEADER_LEN];
-  ndefBuffer      bufHeader;
-  ndefConstBuffer bufPayloadItem;
-  uint32_t        offset;
-  bool            firstPayloadItem;
+  ndefWriteSink   sink;
 
   if ((message == NULL)) {
     return ST_ERR_PARAM;
@@ -378,61 +636,623 @@ ReturnCode NdefClass::ndefPollerWriteMessage(const ndefMessage *message)
   }
 
   if (info.length != 0U) {
-    offset = messageOffset;
+    /* Stream the records through a one block sink: each block is written once */
+    ndefPollerSinkInit(&sink, messageOffset);
     record = ndefMessageGetFirstRecord(message);
 
     while (record != NULL) {
-      bufHeader.buffer = recordHeaderBuf;
-      bufHeader.length = sizeof(recordHeaderBuf);
-      (void)ndefRecordEncodeHeader(record, &bufHeader);
-      err = ndefPollerWriteBytes(offset, bufHeader.buffer, bufHeader.length);
+      err = ndefRecordEmit(record, NULL, NULL, &sink);
       if (err != ST_ERR_NONE) {
+        /* Conclude procedure */
+        state = NDEF_STATE_INVALID;
         return err;
       }
-      offset += bufHeader.length;
-      // TODO Use API to access record internal
-      if (record->typeLength != 0U) {
-        err = ndefPollerWriteBytes(offset, record->type, record->typeLength);
-        if (err != ST_ERR_NONE) {
-          /* Conclude procedure */
-          state = NDEF_STATE_INVALID;
-          return err;
+      record = ndefMessageGetNextRecord(record);
+    }
+
+    err = ndefPollerSinkFlush(&sink);
+    if (err == ST_ERR_NONE) {
+      err = ndefPollerEndWriteMessage(info.length);
+    }
+    if (err != ST_ERR_NONE) {
+      /* Conclude procedure */
+      state = NDEF_STATE_INVALID;
+      return err;
+    }
+  }
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerWriteRawMessageDelta(const uint8_t *buf, uint32_t bufLen, const uint8_t *current, uint32_t currentLen)
+{
+  ReturnCode err;
+  uint8_t    tagBuf[NDEF_DELTA_BUF_LEN];
+  uint32_t   tagBufOffset;
+  uint32_t   tagBufLen;
+  uint32_t   blockLen;
+  uint32_t   refLen;
+  uint32_t   pos;
+  uint32_t   blockStart;
+  uint32_t   blockEnd;
+  uint32_t   dirtyStart;
+  uint32_t   dirtyEnd;
+  uint32_t   i;
+  bool       lengthChanged;
+  bool       framed;
+  bool       dirty;
+  bool       pending;
+
+  if ((buf == NULL) && (bufLen != 0U)) {
+    return ST_ERR_PARAM;
+  }
+
+  if ((state != NDEF_STATE_INITIALIZED) && (state != NDEF_STATE_READWRITE)) {
+    return ST_ERR_WRONG_STATE;
+  }
+
+  err = ndefPollerCheckAvailableSpace(bufLen);
+  if (err != ST_ERR_NONE) {
+    /* Conclude procedure */
+    return ST_ERR_PARAM;
+  }
+
+  blockLen = ndefPollerBlockLen();
+  if ((blockLen == 0U) || (blockLen > NDEF_DELTA_BUF_LEN)) {
+    blockLen = NDEF_DELTA_BUF_LEN;
+  }
+
+  /* Without a copy of the current message, compare against the tag content */
+  if (current == NULL) {
+    currentLen = messageLen;
+  }
+
+  /* A length change keeps the regular sequence: L-field/NLEN reset first, updated last */
+  lengthChanged = (bufLen != currentLen);
+  framed        = lengthChanged;
+#if NDEF_FEATURE_T3T
+  if (type == NDEF_DEV_T3T) {
+    /* TS T3T v1.0 7.4.3: any update of the NDEF data is enclosed by WriteFlag ON and OFF */
+    framed = true;
+  }
+#endif
+  refLen        = currentLen;
+  if (framed) {
+    pos = messageOffset;
+    err = ndefPollerBeginWriteMessage(bufLen);
+    if (err != ST_ERR_NONE) {
+      state = NDEF_STATE_INVALID;
+      /* Conclude procedure */
+      return err;
+    }
+    if (messageOffset != pos) {
+      /* The message moved (longer L-field): nothing can be reused */
+      refLen = 0U;
+    }
+  }
+
+  /* Walk the message block by block and write back runs of changed blocks only */
+  tagBufOffset = 0U;
+  tagBufLen    = 0U;
+  dirtyStart   = 0U;
+  dirtyEnd     = 0U;
+  pending      = false;
+  for (pos = messageOffset - (messageOffset % blockLen); pos < (messageOffset + bufLen); pos += blockLen) {
+    blockStart = (pos < messageOffset) ? messageOffset : pos;
+    blockEnd   = ((pos + blockLen) > (messageOffset + bufLen)) ? (messageOffset + bufLen) : (pos + blockLen);
+
+    dirty = false;
+    for (i = blockStart - messageOffset; (i < (blockEnd - messageOffset)) && (dirty == false); i++) {
+      if (i >= refLen) {
+        dirty = true;
+      } else if (current != NULL) {
+        dirty = (current[i] != buf[i]);
+      } else {
+        if ((i < tagBufOffset) || (i >= (tagBufOffset + tagBufLen))) {
+          tagBufOffset = i;
+          tagBufLen    = ((refLen - i) < sizeof(tagBuf)) ? (refLen - i) : sizeof(tagBuf);
+          err = ndefPollerReadBytes(messageOffset + tagBufOffset, tagBufLen, tagBuf, &tagBufLen);
+          if ((err != ST_ERR_NONE) || (tagBufLen == 0U)) {
+            /* Conclude procedure */
+            state = NDEF_STATE_INVALID;
+            return (err != ST_ERR_NONE) ? err : ST_ERR_PROTO;
+          }
         }
-        offset += record->typeLength;
+        dirty = (tagBuf[i - tagBufOffset] != buf[i]);
       }
-      if (record->idLength != 0U) {
-        err = ndefPollerWriteBytes(offset, record->id, record->idLength);
-        if (err != ST_ERR_NONE) {
-          /* Conclude procedure */
-          state = NDEF_STATE_INVALID;
-          return err;
-        }
-        offset += record->idLength;
+    }
+
+    if (dirty) {
+      if (pending == false) {
+        dirtyStart = blockStart;
+        pending    = true;
+      }
+      dirtyEnd = blockEnd;
+    }
+
+    if (pending && ((dirty == false) || (blockEnd == (messageOffset + bufLen)))) {
+      err = ndefPollerWriteBytes(dirtyStart, &buf[dirtyStart - messageOffset], dirtyEnd - dirtyStart);
+      if (err != ST_ERR_NONE) {
+        /* Conclude procedure */
+        state = NDEF_STATE_INVALID;
+        return err;
+      }
+      pending = false;
+    }
+  }
+
+  if (framed && ((bufLen != 0U) || (type == NDEF_DEV_T3T))) {
+    err = ndefPollerEndWriteMessage(bufLen);
+    if (err != ST_ERR_NONE) {
+      /* Conclude procedure */
+      state = NDEF_STATE_INVALID;
+      return err;
+    }
+  }
+
+  messageLen = bufLen;
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+void NdefClass::ndefPollerDropReadCache(void)
+{
+  /* Everything is on the tag: forget the RAM copies so that reads hit the tag */
+#if NDEF_FEATURE_BLOCK_CACHE
+  ndefBlockCacheInvalidate();
+#endif
+#if NDEF_FEATURE_T5T
+  if (type == NDEF_DEV_T5T) {
+    subCtx.t5t.readAheadLen = 0U;
+  }
+#endif
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerReadBack(uint32_t offset, uint32_t len, uint8_t *buf)
+{
+  ReturnCode err;
+  uint32_t   rcvdLen;
+#if NDEF_FEATURE_T5T
+  uint8_t    rxBuf[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + NDEF_VERIFY_BUF_LEN + NDEF_BLOCK_CACHE_BLOCK_MAX_LEN + NDEF_T5T_TxRx_BUFF_FOOTER_SIZE];
+  uint32_t   blockLen;
+  uint32_t   firstBlock;
+  uint32_t   nbBlocks;
+  uint16_t   rxLen;
+
+  /* T5T byte reads use single blocks: cover the chunk with one Read Multiple Blocks when supported */
+  if ((type == NDEF_DEV_T5T) && cc.t5t.multipleBlockRead && (subCtx.t5t.blockLen != 0U)) {
+    blockLen   = subCtx.t5t.blockLen;
+    firstBlock = offset / blockLen;
+    nbBlocks   = (((offset + len - 1U) / blockLen) - firstBlock) + 1U;
+    if ((len <= NDEF_VERIFY_BUF_LEN) && ((nbBlocks * blockLen) <= (NDEF_VERIFY_BUF_LEN + NDEF_BLOCK_CACHE_BLOCK_MAX_LEN))) {
+      /* Number of blocks is encoded minus one */
+      err = ndefT5TPollerReadMultipleBlocks((uint16_t)firstBlock, (uint8_t)(nbBlocks - 1U), rxBuf, (uint16_t)sizeof(rxBuf), &rxLen);
+      if ((err == ST_ERR_NONE) && (rxBuf[0U] == 0U) && (rxLen >= (NDEF_T5T_TxRx_BUFF_HEADER_SIZE + (nbBlocks * blockLen)))) {
+        (void)ST_MEMCPY(buf, &rxBuf[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + (offset - (firstBlock * blockLen))], len);
+        return ST_ERR_NONE;
+      }
+      /* Fall back to the regular read */
+    }
+  }
+#endif
+
+  err = ndefPollerReadBytes(offset, len, buf, &rcvdLen);
+  if ((err == ST_ERR_NONE) && (rcvdLen != len)) {
+    err = ST_ERR_PROTO;
+  }
+  return err;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerWriteRawMessageVerified(const uint8_t *buf, uint32_t bufLen)
+{
+  ReturnCode err;
+  ndefInfo   info;
+  uint8_t    tagBuf[NDEF_VERIFY_BUF_LEN];
+  uint32_t   blockLen;
+  uint32_t   pos;
+  uint32_t   chunkLen;
+  uint32_t   blockStart;
+  uint32_t   blockEnd;
+  uint32_t   dirtyStart;
+  uint32_t   dirtyEnd;
+  uint32_t   retry;
+  uint32_t   i;
+  bool       dirty;
+  bool       pending;
+  bool       failed;
+
+  if ((buf == NULL) && (bufLen != 0U)) {
+    return ST_ERR_PARAM;
+  }
+
+  err = ndefPollerWriteRawMessage(buf, bufLen);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  blockLen = ndefPollerBlockLen();
+  if ((blockLen == 0U) || (blockLen > NDEF_VERIFY_BUF_LEN)) {
+    blockLen = NDEF_VERIFY_BUF_LEN;
+  }
+
+  ndefPollerDropReadCache();
+
+  /* Chunks end on a block boundary so that a failing block is never split */
+  for (pos = 0U; pos < bufLen; pos += chunkLen) {
+    chunkLen = ((((messageOffset + pos + NDEF_VERIFY_BUF_LEN) / blockLen) * blockLen) - messageOffset) - pos;
+    if (chunkLen > (bufLen - pos)) {
+      chunkLen = bufLen - pos;
+    }
+
+    for (retry = 0U; ; retry++) {
+      err = ndefPollerReadBack(messageOffset + pos, chunkLen, tagBuf);
+      if (err != ST_ERR_NONE) {
+        /* Conclude procedure */
+        state = NDEF_STATE_INVALID;
+        return err;
       }
-      if (ndefRecordGetPayloadLength(record) != 0U) {
-        firstPayloadItem = true;
-        while (ndefRecordGetPayloadItem(record, &bufPayloadItem, firstPayloadItem) != NULL) {
-          firstPayloadItem = false;
-          err = ndefPollerWriteBytes(offset, bufPayloadItem.buffer, bufPayloadItem.length);
+
+      /* Compare block by block and write back runs of failing blocks */
+      failed     = false;
+      pending    = false;
+      dirtyStart = 0U;
+      dirtyEnd   = 0U;
+      for (blockStart = messageOffset + pos; blockStart < (messageOffset + pos + chunkLen); blockStart = blockEnd) {
+        blockEnd = ((blockStart / blockLen) + 1U) * blockLen;
+        if (blockEnd > (messageOffset + pos + chunkLen)) {
+          blockEnd = messageOffset + pos + chunkLen;
+        }
+
+        dirty = false;
+        for (i = blockStart; (i < blockEnd) && (dirty == false); i++) {
+          dirty = (tagBuf[i - messageOffset - pos] != buf[i - messageOffset]);
+        }
+
+        if (dirty) {
+          failed = true;
+          if (retry == NDEF_VERIFY_RETRIES) {
+            break;
+          }
+          if (pending == false) {
+            dirtyStart = blockStart;
+            pending    = true;
+          }
+          dirtyEnd = blockEnd;
+        }
+
+        if (pending && ((dirty == false) || (blockEnd == (messageOffset + pos + chunkLen)))) {
+          err = ndefPollerWriteBytes(dirtyStart, &buf[dirtyStart - messageOffset], dirtyEnd - dirtyStart);
           if (err != ST_ERR_NONE) {
             /* Conclude procedure */
             state = NDEF_STATE_INVALID;
             return err;
           }
-          offset += bufPayloadItem.length;
+          pending = false;
         }
       }
-      record = ndefMessageGetNextRecord(record);
+
+      if (failed == false) {
+        break;
+      }
+      if (retry == NDEF_VERIFY_RETRIES) {
+        /* Conclude procedure */
+        state = NDEF_STATE_INVALID;
+        return ST_ERR_WRITE;
+      }
+      ndefPollerDropReadCache();
     }
+  }
+
+  /* The L-field/NLEN must announce the written message */
+  ndefPollerDropReadCache();
+  err = ndefPollerNdefDetect(&info);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  if (info.messageLen != bufLen) {
+    state = NDEF_STATE_INVALID;
+    return ST_ERR_WRITE;
+  }
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerPersonalize(const ndefCapabilityContainer *cc_p, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report)
+{
+  ndefPersonalizeReport dummy;
+
+  if ((cc_p == NULL) || (message == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (report == NULL) {
+    report = &dummy;
+  }
+  (void)ST_MEMSET(report, 0x00, sizeof(ndefPersonalizeReport));
+
+  switch (type) {
+    case NDEF_DEV_NONE:
+    case NDEF_DEV_T1T:
+    case NDEF_DEV_T3T:
+    case NDEF_DEV_T4T:
+    default:
+      NO_WARNING(lockOptions);
+      return ST_ERR_NOTSUPP;
+#if NDEF_FEATURE_T2T
+    case NDEF_DEV_T2T:
+      return ndefT2TPollerPersonalize(cc_p, message, lockOptions, report);
+#endif
+#if NDEF_FEATURE_T5T
+    case NDEF_DEV_T5T:
+      return ndefT5TPollerPersonalize(cc_p, message, lockOptions, report);
+#endif
+  }
+}
+
+/*******************************************************************************/
+void NdefClass::ndefPollerPersonalizeInit(ndefPersonalizePlan *plan, uint32_t blockLen, uint32_t runMax, uint32_t headOffset)
+{
+  (void)ST_MEMSET(plan, 0x00, sizeof(ndefPersonalizePlan));
+
+  plan->blockLen   = blockLen;
+  plan->runMax     = runMax - (runMax % blockLen);
+  plan->headOffset = headOffset - (headOffset % blockLen);
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerPersonalizeWriteBlocks(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+  ReturnCode err;
+#if NDEF_FEATURE_T2T
+  uint32_t   i;
+#endif
+
+  err = ST_ERR_NONE;
+
+  switch (type) {
+#if NDEF_FEATURE_T2T
+    case NDEF_DEV_T2T:
+      /* WRITE is the only write command: one per block */
+      for (i = 0U; (i < len) && (err == ST_ERR_NONE); i += NDEF_T2T_BLOCK_SIZE) {
+        err = ndefT2TPollerWriteBlock((uint16_t)((offset + i) / NDEF_T2T_BLOCK_SIZE), &buf[i]);
+        plan->writeCmds++;
+      }
+      break;
+#endif
+#if NDEF_FEATURE_T5T
+    case NDEF_DEV_T5T:
+      err = ndefT5TPollerWriteMultipleBlocks((uint16_t)(offset / plan->blockLen), (uint8_t)(len / plan->blockLen), buf);
+      plan->writeCmds++;
+      break;
+#endif
+    default:
+      NO_WARNING(offset);
+      NO_WARNING(buf);
+      err = ST_ERR_NOTSUPP;
+      break;
+  }
+
+  if (err == ST_ERR_NONE) {
+    plan->bytesWritten += len;
+  }
+  return err;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerPersonalizeFlush(ndefPersonalizePlan *plan)
+{
+  ReturnCode err;
+
+  if (plan->runLen == 0U) {
+    return ST_ERR_NONE;
+  }
+
+  err = ndefPollerPersonalizeWriteBlocks(plan, plan->runOffset, plan->run, plan->runLen);
+  plan->runOffset += plan->runLen;
+  plan->runLen     = 0U;
+
+  return err;
+}
 
-    err = ndefPollerEndWriteMessage(info.length);
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerPersonalizeEmit(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *buf, uint32_t len)
+{
+  ReturnCode err;
+
+  /* The sink only hands over whole blocks: the image is padded up to a block boundary */
+  while (len >= plan->blockLen) {
+    if (offset == plan->headOffset) {
+      /* Hold back the block with the L-field: the message only becomes visible once complete */
+      (void)ST_MEMCPY(plan->head, buf, plan->blockLen);
+      plan->headValid = true;
+    } else {
+      if ((plan->runLen != 0U) && ((plan->runOffset + plan->runLen) != offset)) {
+        err = ndefPollerPersonalizeFlush(plan);
+        if (err != ST_ERR_NONE) {
+          return err;
+        }
+      }
+      if (plan->runLen == 0U) {
+        plan->runOffset = offset;
+      }
+      (void)ST_MEMCPY(&plan->run[plan->runLen], buf, plan->blockLen);
+      plan->runLen += plan->blockLen;
+
+      if (plan->runLen >= plan->runMax) {
+        err = ndefPollerPersonalizeFlush(plan);
+        if (err != ST_ERR_NONE) {
+          return err;
+        }
+      }
+    }
+    offset += plan->blockLen;
+    buf     = &buf[plan->blockLen];
+    len    -= plan->blockLen;
+  }
+
+  return (len == 0U) ? ST_ERR_NONE : ST_ERR_INTERNAL;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerPersonalizeStream(ndefPersonalizePlan *plan, uint32_t offset, const uint8_t *prefix, uint32_t prefixLen, const ndefMessage *message, bool terminator)
+{
+  ReturnCode           err;
+  ndefWriteSink        sink;
+  ndefRecord          *record;
+  uint8_t              tail;
+  static const uint8_t padding[NDEF_WRITE_SINK_BUF_LEN] = { 0U };
+
+  ndefPollerSinkInit(&sink, offset);
+  sink.blockLen = plan->blockLen;
+  sink.plan     = plan;
+
+  /* CC and/or TLV header, then the records encoded on the fly */
+  err = ndefPollerSinkWrite(&sink, prefix, prefixLen);
+
+  record = ndefMessageGetFirstRecord(message);
+  while ((record != NULL) && (err == ST_ERR_NONE)) {
+    err = ndefRecordEmit(record, NULL, NULL, &sink);
+    record = ndefMessageGetNextRecord(record);
+  }
+
+  if ((err == ST_ERR_NONE) && terminator) {
+    tail = NDEF_TERMINATOR_TLV_T;
+    err  = ndefPollerSinkWrite(&sink, &tail, NDEF_TERMINATOR_TLV_LEN);
+  }
+
+  /* Complete the last block so that no block has to be read first */
+  if ((err == ST_ERR_NONE) && (((sink.offset + sink.len) % sink.blockLen) != 0U)) {
+    err = ndefPollerSinkWrite(&sink, padding, sink.blockLen - ((sink.offset + sink.len) % sink.blockLen));
+  }
+
+  if (err == ST_ERR_NONE) {
+    err = ndefPollerPersonalizeFlush(plan);
+  }
+
+  /* The block holding the L-field goes last */
+  if ((err == ST_ERR_NONE) && plan->headValid) {
+    err = ndefPollerPersonalizeWriteBlocks(plan, plan->headOffset, plan->head, plan->blockLen);
+  }
+
+  return err;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerReaderInit(ndefReader *reader, uint8_t *buf, uint32_t bufLen)
+{
+  if ((reader == NULL) || (buf == NULL) || (bufLen < NDEF_RECORD_HEADER_LEN)) {
+    return ST_ERR_PARAM;
+  }
+
+  /* NDEF Detect must have been called before */
+  if (state == NDEF_STATE_INVALID) {
+    return ST_ERR_WRONG_STATE;
+  }
+
+  reader->buf       = buf;
+  reader->bufLen    = bufLen;
+  reader->offset    = 0U;
+  reader->recordLen = 0U;
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefPollerReaderNext(ndefReader *reader, ndefRecord *record)
+{
+  ReturnCode      err;
+  ndefConstBuffer bufRecord;
+  uint32_t        remaining;
+  uint32_t        hdrLen;
+  uint32_t        rcvdLen;
+  uint32_t        payloadLen;
+  uint32_t        idx;
+  uint8_t         idLen;
+
+  if ((reader == NULL) || (reader->buf == NULL) || (record == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (reader->offset >= messageLen) {
+    return ST_ERR_NOTFOUND;
+  }
+  remaining = messageLen - reader->offset;
+
+  /* Read the fixed part of the header, it tells the record length */
+  hdrLen = (remaining < NDEF_RECORD_HEADER_LEN) ? remaining : NDEF_RECORD_HEADER_LEN;
+  err = ndefPollerReadBytes(messageOffset + reader->offset, hdrLen, reader->buf, &rcvdLen);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+  if (rcvdLen != hdrLen) {
+    return ST_ERR_PROTO;
+  }
+
+  idx = 3U; /* Header + Type length + short Payload length */
+  if ((reader->buf[0U] & 0x10U) != 0U) {
+    if (hdrLen < idx) {
+      return ST_ERR_PROTO;
+    }
+    payloadLen = reader->buf[2U];
+  } else {
+    idx = 6U;
+    if (hdrLen < idx) {
+      return ST_ERR_PROTO;
+    }
+    payloadLen = ((uint32_t)reader->buf[2U] << 24U) | ((uint32_t)reader->buf[3U] << 16U) | ((uint32_t)reader->buf[4U] << 8U) | (uint32_t)reader->buf[5U];
+  }
+  idLen = 0U;
+  if ((reader->buf[0U] & 0x08U) != 0U) {
+    if (hdrLen <= idx) {
+      return ST_ERR_PROTO;
+    }
+    idLen = reader->buf[idx];
+    idx++;
+  }
+
+  if (((idx + (uint32_t)reader->buf[1U] + idLen) > remaining) ||
+      (payloadLen > (remaining - idx - reader->buf[1U] - idLen))) {
+    return ST_ERR_PROTO;
+  }
+  reader->recordLen = idx + reader->buf[1U] + idLen + payloadLen;
+
+  if (((reader->buf[0U] & 0x20U) != 0U) || ((reader->buf[0U] & 0x07U) == NDEF_TNF_UNCHANGED)) {
+    /* Chunks are not reassembled: skip them one at a time so that the next record can still be read */
+    reader->offset += reader->recordLen;
+    return ST_ERR_NOTSUPP;
+  }
+
+  if (reader->recordLen > reader->bufLen) {
+    /* Skip the record so that the next one can still be read */
+    reader->offset += reader->recordLen;
+    return ST_ERR_NOMEM;
+  }
+
+  /* Read the rest of the record */
+  if (reader->recordLen > hdrLen) {
+    err = ndefPollerReadBytes(messageOffset + reader->offset + hdrLen, reader->recordLen - hdrLen, &reader->buf[hdrLen], &rcvdLen);
     if (err != ST_ERR_NONE) {
-      /* Conclude procedure */
-      state = NDEF_STATE_INVALID;
       return err;
     }
+    if (rcvdLen != (reader->recordLen - hdrLen)) {
+      return ST_ERR_PROTO;
+    }
   }
 
+  bufRecord.buffer = reader->buf;
+  bufRecord.length = reader->recordLen;
+  err = ndefRecordDecode(&bufRecord, record);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  reader->offset += reader->recordLen;
+
   return ST_ERR_NONE;
 }
 
@@ -85,6 +85,7 @@
 #define NDEF_TERMINATOR_TLV_LEN      1U                                                /*!< Terminator TLV size                                          */
 #define NDEF_TERMINATOR_TLV_T     0xFEU                                                /*!< Terminator TLV T=FEh                                         */
 
+#define NDEF_T2T_BLOCK_SIZE          4U                                                /*!< size for a block in t2t                                      */
 #define NDEF_T2T_READ_RESP_SIZE     16U                                                /*!< Size of the READ response i.e. four blocks                   */
 
 #define NDEF_T3T_BLOCK_SIZE         16U                                                /*!< size for a block in t3t                                      */
@@ -98,6 +99,56 @@
 #define NDEF_T5T_TxRx_BUFF_SIZE               \
           (32U +  NDEF_T5T_TxRx_BUFF_HEADER_SIZE + NDEF_T5T_TxRx_BUFF_FOOTER_SIZE)     /*!< T5T working buffer size                                      */
 
+#ifndef NDEF_T5T_READ_AHEAD_LEN
+#define NDEF_T5T_READ_AHEAD_LEN              64U                                       /*!< T5T bytes read with one Read Multiple Blocks at NDEF detect  */
+#endif
+
+#define NDEF_WRITE_SINK_BUF_LEN              32U                                       /*!< Write sink buffer len, i.e. largest block (T5T) and T4T chunk */
+#define NDEF_DELTA_BUF_LEN                   64U                                       /*!< Delta write buffer len used to read back the current message */
+#define NDEF_VERIFY_BUF_LEN                  64U                                       /*!< Verified write read-back chunk len                           */
+#ifndef NDEF_VERIFY_RETRIES
+#define NDEF_VERIFY_RETRIES                   2U                                       /*!< Verified write: rewrites of a failing chunk before giving up */
+#endif
+#define NDEF_PERSONALIZE_RUN_MAX_LEN         32U                                       /*!< Personalization: largest payload of one write command        */
+#define NDEF_PERSONALIZE_RUN_MAX_BLOCKS       4U                                       /*!< Personalization: max blocks of one T5T Write Multiple Blocks */
+
+#define NDEF_PERSONALIZE_LOCK_NONE         0x00U                                       /*!< Personalization: leave the tag writable                      */
+#define NDEF_PERSONALIZE_LOCK_READ_ONLY    0x01U                                       /*!< Personalization: CC write access set to read-only            */
+#define NDEF_PERSONALIZE_LOCK_PERMANENT    0x02U                                       /*!< Personalization: read-only CC and lock bits / Lock Block     */
+
+#ifndef NDEF_CACHE_ENTRIES
+#define NDEF_CACHE_ENTRIES                    8U                                       /*!< Number of tags remembered by the tag geometry cache          */
+#endif
+#define NDEF_CACHE_UID_MAX_LEN               10U                                       /*!< Max UID length stored in the tag geometry cache              */
+#define NDEF_CACHE_CC_MAX_LEN                 8U                                       /*!< Max CC length stored in the tag geometry cache (T2T/T5T)     */
+#define NDEF_CACHE_FLAG_SYSINFO            0x01U                                       /*!< Cache entry flag: System Information supported and stored    */
+#define NDEF_CACHE_FLAG_LEGACY_HD          0x02U                                       /*!< Cache entry flag: Legacy ST High Density T5T                 */
+
+#ifndef NDEF_BLOCK_CACHE_BLOCKS
+#define NDEF_BLOCK_CACHE_BLOCKS               8U                                       /*!< Number of tag blocks held by the block cache                 */
+#endif
+#define NDEF_BLOCK_CACHE_BLOCK_MAX_LEN       32U                                       /*!< Largest block held by the block cache i.e. T5T               */
+
+#ifndef NDEF_FEATURE_T2T
+#define NDEF_FEATURE_T2T                      1U                                       /*!< Build the T2T poller, 0 to strip it                          */
+#endif
+#ifndef NDEF_FEATURE_T3T
+#define NDEF_FEATURE_T3T                      1U                                       /*!< Build the T3T poller, 0 to strip it                          */
+#endif
+#ifndef NDEF_FEATURE_T4T
+#define NDEF_FEATURE_T4T                      1U                                       /*!< Build the T4T poller and its APDU buffers, 0 to strip it     */
+#endif
+#ifndef NDEF_FEATURE_T5T
+#define NDEF_FEATURE_T5T                      1U                                       /*!< Build the T5T poller, 0 to strip it                          */
+#endif
+#define NDEF_FEATURE_BLOCK_CACHE  (NDEF_FEATURE_T2T || NDEF_FEATURE_T3T || NDEF_FEATURE_T5T) /*!< Block cache, only used by block based tags              */
+
+#ifndef NDEF_EXTERNAL_WORK_AREA
+#define NDEF_EXTERNAL_WORK_AREA               0U                                       /*!< 1: T3T/T4T buffers only come from ndefPollerSetWorkArea()    */
+#endif
+#define NDEF_T3T_WORK_AREA_LEN    (NDEF_T3T_MAX_TX_SIZE + NDEF_T3T_MAX_RX_SIZE)                                   /*!< Work area taken by a T3T context */
+#define NDEF_T4T_WORK_AREA_LEN    ((2U * sizeof(rfalIsoDepApduBufFormat)) + sizeof(rfalIsoDepBufFormat))         /*!< Work area taken by a T4T context */
+
 /*
  ******************************************************************************
  * GLOBAL MACROS
@@ -238,28 +289,35 @@ typedef struct {
 /*! NDEF T2T sub context structure */
 typedef struct {
   uint8_t                     currentSecNo;                      /*!< Current sector number                          */
-  uint8_t                     cacheBuf[NDEF_T2T_READ_RESP_SIZE]; /*!< Cache buffer                                   */
-  uint32_t                    cacheAddr;                         /*!< Address of cached data                         */
   uint32_t                    offsetNdefTLV;                     /*!< NDEF TLV message offset                        */
 } ndefT2TContext;
 
 /*! NDEF T3T sub context structure */
 typedef struct {
-  uint8_t                      txbuf[NDEF_T3T_MAX_TX_SIZE];         /*!< Tx buffer dedicated for T3T internal operations         */
-  uint8_t                      rxbuf[NDEF_T3T_MAX_RX_SIZE];         /*!< Rx buffer dedicated for T3T internal operations         */
+  uint8_t                     *txbuf;                               /*!< Tx buffer dedicated for T3T internal operations         */
+  uint8_t                     *rxbuf;                               /*!< Rx buffer dedicated for T3T internal operations         */
   rfalNfcfBlockListElem        listBlocks[NDEF_T3T_MAX_NB_BLOCKS];  /*!< block number list for T3T internal operations           */
+#if !NDEF_EXTERNAL_WORK_AREA
+  uint8_t                      txbufStore[NDEF_T3T_MAX_TX_SIZE];    /*!< Embedded txbuf, used when no work area is set           */
+  uint8_t                      rxbufStore[NDEF_T3T_MAX_RX_SIZE];    /*!< Embedded rxbuf, used when no work area is set           */
+#endif
 } ndefT3TContext;
 
 /*! NDEF T4T sub context structure */
 typedef struct {
   uint8_t                      curMLe;                       /*!< Current MLe. Default Fh until CC file is read      */
-  uint8_t                      curMLc;                       /*!< Current MLc. Default Dh until CC file is read      */
+  uint16_t                     curMLc;                       /*!< Current MLc. Default Dh until CC file is read      */
   bool                         mv1Flag;                      /*!< Mapping version 1 flag                             */
-  rfalIsoDepApduBufFormat      cApduBuf;                     /*!< Command-APDU buffer                                */
-  rfalIsoDepApduBufFormat      rApduBuf;                     /*!< Response-APDU buffer                               */
+  rfalIsoDepApduBufFormat     *cApduBuf;                     /*!< Command-APDU buffer                                */
+  rfalIsoDepApduBufFormat     *rApduBuf;                     /*!< Response-APDU buffer                               */
   rfalT4tRApduParam            respAPDU;                     /*!< Response-APDU params                               */
-  rfalIsoDepBufFormat          tmpBuf;                       /*!< I-Block temporary buffer                           */
+  rfalIsoDepBufFormat         *tmpBuf;                       /*!< I-Block temporary buffer                           */
   uint16_t                     rApduBodyLen;                 /*!< Response Body Len                                  */
+#if !NDEF_EXTERNAL_WORK_AREA
+  rfalIsoDepApduBufFormat      cApduStore;                   /*!< Embedded cApduBuf, used when no work area is set   */
+  rfalIsoDepApduBufFormat      rApduStore;                   /*!< Embedded rApduBuf, used when no work area is set   */
+  rfalIsoDepBufFormat          tmpStore;                     /*!< Embedded tmpBuf, used when no work area is set     */
+#endif
 } ndefT4TContext;
 
 /*! NDEF T5T sub context structure */
@@ -271,8 +329,87 @@ typedef struct {
   bool                         sysInfoSupported;             /*!< System Information Supported flag                  */
   bool                         legacySTHighDensity;          /*!< Legacy ST High Density flag                        */
   uint8_t                      txrxBuf[NDEF_T5T_TxRx_BUFF_SIZE];  /*!< Tx Rx Buffer                                  */
+  uint8_t                      readAhead[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + NDEF_T5T_READ_AHEAD_LEN + NDEF_T5T_TxRx_BUFF_FOOTER_SIZE]; /*!< Status + first bytes of the tag, read at NDEF detect */
+  uint16_t                     readAheadLen;                 /*!< Number of valid bytes in readAhead, 0 when empty   */
 } ndefT5TContext;
 
+/*! NDEF personalization plan: block writes of the tag image, run in ascending order, TLV head block last */
+typedef struct {
+  uint32_t                     blockLen;                     /*!< Block length                                       */
+  uint32_t                     runMax;                       /*!< Largest write command payload, multiple of blockLen */
+  uint32_t                     runOffset;                    /*!< Tag offset of run[0]                               */
+  uint32_t                     runLen;                       /*!< Number of bytes pending in run                     */
+  uint32_t                     headOffset;                   /*!< Offset of the block holding the NDEF TLV T and L   */
+  bool                         headValid;                    /*!< head holds the TLV head block                      */
+  uint16_t                     writeCmds;                    /*!< Write commands issued                              */
+  uint32_t                     bytesWritten;                 /*!< Bytes written                                      */
+  uint8_t                      head[NDEF_WRITE_SINK_BUF_LEN];     /*!< TLV head block, written once the rest is in   */
+  uint8_t                      run[NDEF_PERSONALIZE_RUN_MAX_LEN]; /*!< Contiguous blocks pending for one command     */
+} ndefPersonalizePlan;
+
+/*! NDEF personalization report */
+typedef struct {
+  uint32_t                     planUs;                       /*!< Checks and planning, before the first RF command   */
+  uint32_t                     writeUs;                      /*!< CC, TLV, message and terminator writes             */
+  uint32_t                     lockUs;                       /*!< Lock bits / Lock Block commands                    */
+  uint32_t                     totalUs;                      /*!< Whole personalization                              */
+  uint16_t                     writeCmds;                    /*!< Write commands issued                              */
+  uint16_t                     lockCmds;                     /*!< Lock commands issued                               */
+  uint32_t                     bytesWritten;                 /*!< Bytes written, including padding                   */
+} ndefPersonalizeReport;
+
+/*! NDEF write sink: coalesces the pieces of an encoded message into tag blocks */
+typedef struct {
+  uint32_t                     offset;                       /*!< Tag offset of buf[0]                               */
+  uint32_t                     len;                          /*!< Number of bytes pending in buf                     */
+  uint32_t                     blockLen;                     /*!< Block length the writes are aligned to             */
+  ndefPersonalizePlan         *plan;                         /*!< Plan the blocks are handed to, NULL to write them  */
+  uint8_t                      buf[NDEF_WRITE_SINK_BUF_LEN]; /*!< Pending bytes, at most one block                   */
+} ndefWriteSink;
+
+/*! NDEF incremental reader: pulls the records of the detected NDEF message one at a time */
+typedef struct {
+  uint8_t                     *buf;                          /*!< Working buffer the current record is read into     */
+  uint32_t                     bufLen;                       /*!< Working buffer length                              */
+  uint32_t                     offset;                       /*!< Offset of the next record within the message       */
+  uint32_t                     recordLen;                    /*!< Length of the last record seen                     */
+} ndefReader;
+
+/*! NDEF tag geometry cache entry, keyed by device type and UID (UID includes the manufacturer code) */
+typedef struct {
+  uint32_t                     lastUse;                      /*!< LRU stamp, the higher the more recent              */
+  uint32_t                     tlvOffset;                    /*!< NDEF TLV offset                                    */
+  ndefSystemInformation        sysInfo;                      /*!< T5T System Information (NDEF_CACHE_FLAG_SYSINFO)   */
+  uint8_t                      type;                         /*!< ndefDeviceType, NDEF_DEV_NONE for a free entry     */
+  uint8_t                      uidLen;                       /*!< UID length                                         */
+  uint8_t                      uid[NDEF_CACHE_UID_MAX_LEN];  /*!< UID                                                */
+  uint8_t                      ccLen;                        /*!< Length of the raw CC                               */
+  uint8_t                      cc[NDEF_CACHE_CC_MAX_LEN];    /*!< Raw CC, used to validate the entry                 */
+  uint8_t                      blockLen;                     /*!< T5T block length                                   */
+  uint8_t                      flags;                        /*!< NDEF_CACHE_FLAG_xxx                                */
+} ndefCacheEntry;
+
+/*! NDEF tag geometry cache (LRU)  */
+typedef struct {
+  ndefCacheEntry               entry[NDEF_CACHE_ENTRIES];    /*!< Cache entries                                      */
+  uint32_t                     useCounter;                   /*!< LRU counter                                        */
+} ndefCache;
+
+/*! NDEF block cache entry: one tag block */
+typedef struct {
+  uint32_t                     lastUse;                      /*!< LRU stamp, the higher the more recent              */
+  uint16_t                     blockNum;                     /*!< Tag block number                                   */
+  bool                         valid;                        /*!< Entry holds a block                                */
+  bool                         dirty;                        /*!< Modified in RAM, not yet written back to the tag   */
+  uint8_t                      data[NDEF_BLOCK_CACHE_BLOCK_MAX_LEN]; /*!< Block content                              */
+} ndefBlockCacheEntry;
+
+/*! NDEF block cache (write-back, LRU) shared by the T2T, T3T and T5T byte accesses */
+typedef struct {
+  ndefBlockCacheEntry          entry[NDEF_BLOCK_CACHE_BLOCKS]; /*!< Cache entries                                    */
+  uint32_t                     useCounter;                   /*!< LRU counter                                        */
+} ndefBlockCache;
+
 /*
  ******************************************************************************
  * GLOBAL FUNCTION PROTOTYPES
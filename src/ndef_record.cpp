@@ -55,6 +55,173 @@
  ******************************************************************************
  */
 
+#define ndefRecordPayloadLengthLen(len)  (((len) <= NDEF_SHORT_RECORD_LENGTH_MAX) ? sizeof(uint8_t) : sizeof(uint32_t))  /*!< Size of the Payload length field */
+
+
+/*
+ ******************************************************************************
+ * LOCAL FUNCTIONS
+ ******************************************************************************
+ */
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordEncodeChunkHeader(const ndefRecord *record, bool first, bool last, uint32_t chunkLen, ndefBuffer *bufHeader)
+{
+  uint32_t offset;
+  uint8_t  il = (first && ndefHeaderIsSetIL(record)) ? 1U : 0U;
+
+  if (bufHeader->length < NDEF_RECORD_HEADER_LEN) {
+    bufHeader->length = NDEF_RECORD_HEADER_LEN;
+    return ST_ERR_NOMEM;
+  }
+
+  /* Only the first chunk carries MB, type and id; the last one ends the chunk sequence and carries ME */
+  offset = 0;
+  bufHeader->buffer[offset] = (uint8_t)ndefHeader(first ? ndefHeaderMB(record) : 0U,
+                                                  last  ? ndefHeaderME(record) : 0U,
+                                                  last  ? 0U : 1U,
+                                                  (chunkLen <= NDEF_SHORT_RECORD_LENGTH_MAX) ? 1U : 0U,
+                                                  il,
+                                                  first ? ndefHeaderTNF(record) : NDEF_TNF_UNCHANGED);
+  offset++;
+
+  bufHeader->buffer[offset] = first ? record->typeLength : 0U;
+  offset++;
+
+  if (chunkLen <= NDEF_SHORT_RECORD_LENGTH_MAX) {
+    bufHeader->buffer[offset] = (uint8_t)chunkLen;
+    offset++;
+  } else {
+    bufHeader->buffer[offset] = (uint8_t)(chunkLen >> 24);
+    offset++;
+    bufHeader->buffer[offset] = (uint8_t)(chunkLen >> 16);
+    offset++;
+    bufHeader->buffer[offset] = (uint8_t)(chunkLen >> 8);
+    offset++;
+    bufHeader->buffer[offset] = (uint8_t)(chunkLen);
+    offset++;
+  }
+
+  if (il != 0U) {
+    bufHeader->buffer[offset] = record->idLength;
+    offset++;
+  }
+
+  bufHeader->length = offset;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordEmitBytes(ndefBuffer *bufRecord, uint32_t *offset, ndefWriteSink *sink, const uint8_t *buf, uint32_t len)
+{
+  if (len == 0U) {
+    return ST_ERR_NONE;
+  }
+
+  if (sink != NULL) {
+    return ndefPollerSinkWrite(sink, buf, len);
+  }
+
+  if ((bufRecord->length - *offset) < len) {
+    return ST_ERR_NOMEM;
+  }
+  (void)ST_MEMCPY(&bufRecord->buffer[*offset], buf, len);
+  *offset += len;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordEmit(const ndefRecord *record, ndefBuffer *bufRecord, uint32_t *offset, ndefWriteSink *sink)
+{
+  ReturnCode      err;
+  uint8_t         headerBuf[NDEF_RECORD_HEADER_LEN];
+  ndefBuffer      bufHeader;
+  ndefConstBuffer bufCursor;
+  ndefConstBuffer bufItem;
+  uint32_t        payloadLength;
+  uint32_t        chunkOffset;
+  uint32_t        chunkLen;
+  uint32_t        remaining;
+  uint32_t        len;
+  bool            begin;
+
+  payloadLength = ndefRecordGetPayloadLength(record);
+
+  chunkOffset = 0;
+  begin       = true;
+  bufItem.buffer = NULL;
+  bufItem.length = 0;
+  do {
+    bufHeader.buffer = headerBuf;
+    bufHeader.length = sizeof(headerBuf);
+    if ((record->chunkLength == 0U) || (payloadLength <= record->chunkLength)) {
+      /* Single record */
+      chunkLen = payloadLength;
+      err = ndefRecordEncodeHeader(record, &bufHeader);
+    } else {
+      chunkLen = payloadLength - chunkOffset;
+      if (chunkLen > record->chunkLength) {
+        chunkLen = record->chunkLength;
+      }
+      err = ndefRecordEncodeChunkHeader(record, (chunkOffset == 0U), ((chunkOffset + chunkLen) == payloadLength), chunkLen, &bufHeader);
+    }
+    if (err == ST_ERR_NONE) {
+      err = ndefRecordEmitBytes(bufRecord, offset, sink, bufHeader.buffer, bufHeader.length);
+    }
+    if ((err == ST_ERR_NONE) && (chunkOffset == 0U)) {
+      err = ndefRecordEmitBytes(bufRecord, offset, sink, record->type, record->typeLength);
+      if (err == ST_ERR_NONE) {
+        err = ndefRecordEmitBytes(bufRecord, offset, sink, record->id, record->idLength);
+      }
+    }
+    if (err != ST_ERR_NONE) {
+      return err;
+    }
+
+    /* Built-in types may write the whole payload in one go */
+    remaining = chunkLen;
+    if ((sink == NULL) && (chunkLen == payloadLength) && (remaining > 0U) &&
+        (record->ndeftype != NULL) && (record->ndeftype->encodeInto != NULL)) {
+      if ((bufRecord->length - *offset) < remaining) {
+        return ST_ERR_NOMEM;
+      }
+      if (record->ndeftype->encodeInto(record->ndeftype, &bufRecord->buffer[*offset]) == remaining) {
+        *offset  += remaining;
+        remaining = 0;
+      }
+    }
+
+    /* Payload items do not follow the chunk boundaries, split them as needed */
+    while (remaining > 0U) {
+      if (bufItem.length == 0U) {
+        if (ndefRecordGetPayloadItem(record, &bufCursor, begin) == NULL) {
+          return ST_ERR_INTERNAL;
+        }
+        begin   = false;
+        bufItem = bufCursor;
+        continue;
+      }
+      len = (bufItem.length < remaining) ? bufItem.length : remaining;
+      err = ndefRecordEmitBytes(bufRecord, offset, sink, bufItem.buffer, len);
+      if (err != ST_ERR_NONE) {
+        return err;
+      }
+      bufItem.buffer  = &bufItem.buffer[len];
+      bufItem.length -= len;
+      remaining      -= len;
+    }
+
+    chunkOffset += chunkLen;
+  } while (chunkOffset < payloadLength);
+
+  return ST_ERR_NONE;
+}
+
 
 /*
  ******************************************************************************
@@ -84,6 +251,9 @@ ReturnCode NdefClass::ndefRecordReset(ndefRecord *record)
 
   record->ndeftype = NULL;
 
+  record->chunk       = NULL;
+  record->chunkLength = 0;
+
   record->next = NULL;
 
   return ST_ERR_NONE;
@@ -139,13 +309,33 @@ uint32_t NdefClass::ndefRecordGetHeaderLength(const ndefRecord *record)
 uint32_t NdefClass::ndefRecordGetLength(const ndefRecord *record)
 {
   uint32_t length;
+  uint32_t payloadLength;
+  uint32_t chunkCount;
 
   if (record == NULL) {
     return 0;
   }
 
-  length  = ndefRecordGetHeaderLength(record);  /* Header */
-  length += ndefRecordGetPayloadLength(record); /* Payload */
+  payloadLength = ndefRecordGetPayloadLength(record);
+
+  if ((record->chunkLength == 0U) || (payloadLength <= record->chunkLength)) {
+    length  = ndefRecordGetHeaderLength(record); /* Header */
+    length += payloadLength;                     /* Payload */
+    return length;
+  }
+
+  /* Chunked: the first chunk carries type and id, then one short header per chunk */
+  chunkCount = ((payloadLength - 1U) / record->chunkLength) + 1U;
+
+  length  = sizeof(uint8_t) + sizeof(uint8_t) + ndefRecordPayloadLengthLen(record->chunkLength);
+  if (ndefHeaderIsSetIL(record)) {
+    length += sizeof(uint8_t);
+  }
+  length += record->typeLength;
+  length += record->idLength;
+  length += (chunkCount - 2U) * (sizeof(uint8_t) + sizeof(uint8_t) + ndefRecordPayloadLengthLen(record->chunkLength));
+  length += sizeof(uint8_t) + sizeof(uint8_t) + ndefRecordPayloadLengthLen(payloadLength - ((chunkCount - 1U) * record->chunkLength));
+  length += payloadLength;
 
   return length;
 }
@@ -250,6 +440,7 @@ ReturnCode NdefClass::ndefRecordSetPayload(ndefRecord *record, const ndefConstBu
 
   record->bufPayload.buffer = bufPayload->buffer;
   record->bufPayload.length = bufPayload->length;
+  record->chunk             = NULL;
 
   return ST_ERR_NONE;
 }
@@ -262,6 +453,13 @@ ReturnCode NdefClass::ndefRecordGetPayload(const ndefRecord *record, ndefConstBu
     return ST_ERR_PARAM;
   }
 
+  if (record->chunk != NULL) {
+    /* Payload is not contiguous, only provide the first chunk */
+    bufPayload->buffer = record->bufPayload.buffer;
+    bufPayload->length = record->bufPayload.length;
+    return ST_ERR_NOMEM;
+  }
+
   bufPayload->buffer = record->bufPayload.buffer;
   bufPayload->length = ndefRecordGetPayloadLength(record);
 
@@ -269,6 +467,48 @@ ReturnCode NdefClass::ndefRecordGetPayload(const ndefRecord *record, ndefConstBu
 }
 
 
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordSetChunkLength(ndefRecord *record, uint32_t chunkLength)
+{
+  if (record == NULL) {
+    return ST_ERR_PARAM;
+  }
+
+  record->chunkLength = chunkLength;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordJoinChunks(ndefRecord *record, ndefBuffer *bufPayload)
+{
+  ReturnCode err;
+
+  if ((record == NULL) || (bufPayload == NULL) || (bufPayload->buffer == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (record->chunk == NULL) {
+    /* Already contiguous */
+    bufPayload->length = 0;
+    return ST_ERR_NONE;
+  }
+
+  err = ndefRecordPayloadEncode(record, bufPayload);
+  if (err != ST_ERR_NONE) {
+    bufPayload->length = ndefRecordGetPayloadLength(record);
+    return err;
+  }
+
+  record->bufPayload.buffer = bufPayload->buffer;
+  record->bufPayload.length = bufPayload->length;
+  record->chunk             = NULL;
+
+  return ST_ERR_NONE;
+}
+
+
 /*****************************************************************************/
 ReturnCode NdefClass::ndefRecordDecode(const ndefConstBuffer *bufPayload, ndefRecord *record)
 {
@@ -437,6 +677,14 @@ ReturnCode NdefClass::ndefRecordPayloadEncode(const ndefRecord *record, ndefBuff
     return ST_ERR_NOMEM;
   }
 
+  if ((record->ndeftype != NULL) && (record->ndeftype->encodeInto != NULL) && (payloadLength > 0U)) {
+    offset = record->ndeftype->encodeInto(record->ndeftype, bufPayload->buffer);
+    if (offset == payloadLength) {
+      bufPayload->length = offset;
+      return ST_ERR_NONE;
+    }
+  }
+
   begin  = true;
   offset = 0;
   while (ndefRecordGetPayloadItem(record, &bufPayloadItem, begin) != NULL) {
@@ -457,8 +705,6 @@ ReturnCode NdefClass::ndefRecordPayloadEncode(const ndefRecord *record, ndefBuff
 ReturnCode NdefClass::ndefRecordEncode(const ndefRecord *record, ndefBuffer *bufRecord)
 {
   ReturnCode err;
-  ndefBuffer bufHeader;
-  ndefBuffer bufPayload;
   uint32_t   offset;
 
   if ((record == NULL) || (bufRecord == NULL) || (bufRecord->buffer == NULL)) {
@@ -470,37 +716,13 @@ ReturnCode NdefClass::ndefRecordEncode(const ndefRecord *record, ndefBuffer *buf
     return ST_ERR_NOMEM;
   }
 
-  /* Encode header at the beginning of buffer provided */
-  bufHeader.buffer = bufRecord->buffer;
-  bufHeader.length = bufRecord->length;
-  err = ndefRecordEncodeHeader(record, &bufHeader);
-  if (err != ST_ERR_NONE) {
-    return err;
-  }
-
-  offset = bufHeader.length;
-
-  /* Set Type */
-  if (record->typeLength > 0U) {
-    (void)ST_MEMCPY(&bufRecord->buffer[offset], record->type, record->typeLength);
-    offset += record->typeLength;
-  }
-
-  /* Set Id */
-  if (record->idLength > 0U) {
-    (void)ST_MEMCPY(&bufRecord->buffer[offset], record->id, record->idLength);
-    offset += record->idLength;
-  }
-
-  /* Set Payload */
-  bufPayload.buffer = &bufRecord->buffer[offset];
-  bufPayload.length =  bufRecord->length - offset;
-  err = ndefRecordPayloadEncode(record, &bufPayload);
+  offset = 0;
+  err = ndefRecordEmit(record, bufRecord, &offset, NULL);
   if (err != ST_ERR_NONE) {
     return err;
   }
 
-  bufRecord->length = offset + bufPayload.length;
+  bufRecord->length = offset;
 
   return ST_ERR_NONE;
 }
@@ -518,7 +740,12 @@ uint32_t NdefClass::ndefRecordGetPayloadLength(const ndefRecord *record)
   if ((record->ndeftype != NULL) && (record->ndeftype->getPayloadLength != NULL)) {
     payloadLength = record->ndeftype->getPayloadLength(record->ndeftype);
   } else {
-    payloadLength = record->bufPayload.length;
+    const ndefRecord *chunk;
+
+    payloadLength = 0;
+    for (chunk = record; chunk != NULL; chunk = chunk->chunk) {
+      payloadLength += chunk->bufPayload.length;
+    }
   }
 
   return payloadLength;
@@ -528,15 +755,38 @@ uint32_t NdefClass::ndefRecordGetPayloadLength(const ndefRecord *record)
 /*****************************************************************************/
 const uint8_t *NdefClass::ndefRecordGetPayloadItem(const ndefRecord *record, ndefConstBuffer *bufPayloadItem, bool begin)
 {
+  const ndefRecord *chunk;
+  const uint8_t    *previous;
+
   if ((record == NULL) || (bufPayloadItem == NULL)) {
     return NULL;
   }
 
+  previous = bufPayloadItem->buffer;
+
   bufPayloadItem->buffer = NULL;
   bufPayloadItem->length = 0;
 
   if ((record->ndeftype != NULL) && (record->ndeftype->getPayloadItem != NULL)) {
     record->ndeftype->getPayloadItem(record->ndeftype, bufPayloadItem, begin);
+  } else if (record->chunk != NULL) {
+    /* Chunked record: one item per non empty chunk, the previous item tells where to resume */
+    chunk = record;
+    if (begin == false) {
+      while ((chunk != NULL) && ((chunk->bufPayload.length == 0U) || (chunk->bufPayload.buffer != previous))) {
+        chunk = chunk->chunk;
+      }
+      if (chunk != NULL) {
+        chunk = chunk->chunk;
+      }
+    }
+    while ((chunk != NULL) && (chunk->bufPayload.length == 0U)) {
+      chunk = chunk->chunk;
+    }
+    if (chunk != NULL) {
+      bufPayloadItem->buffer = chunk->bufPayload.buffer;
+      bufPayloadItem->length = chunk->bufPayload.length;
+    }
   } else {
     if (begin == true) {
       (void)ndefRecordGetPayload(record, bufPayloadItem);
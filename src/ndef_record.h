@@ -107,12 +107,14 @@
 /*! Set or Clear the MB/ME bit in header byte */
 #define ndefHeaderSetValueMB(record, value)    do{ (record)->header &= 0x7FU; (record)->header |= (((uint8_t)(value)) & 1U) << 7; }while(0)   /*!< Write the value to the MB bit in the record header byte */
 #define ndefHeaderSetValueME(record, value)    do{ (record)->header &= 0xBFU; (record)->header |= (((uint8_t)(value)) & 1U) << 6; }while(0)   /*!< Write the value to the ME bit in the record header byte */
+#define ndefHeaderSetValueCF(record, value)    do{ (record)->header &= 0xDFU; (record)->header |= (((uint8_t)(value)) & 1U) << 5; }while(0)   /*!< Write the value to the CF bit in the record header byte */
 #define ndefHeaderSetValueSR(record, value)    do{ (record)->header &= 0xEFU; (record)->header |= (((uint8_t)(value)) & 1U) << 4; }while(0)   /*!< Write the value to the SR bit in the record header byte */
 
 /*! Test bit in header byte */
 #define ndefHeaderIsSetMB(record)        ( ndefHeaderMB(record) == 1U )           /*!< Return true if the Message Begin bit is set */
 #define ndefHeaderIsSetSR(record)        ( ndefHeaderSR(record) == 1U )           /*!< Return true if the Short Record bit is set  */
 #define ndefHeaderIsSetIL(record)        ( ndefHeaderIL(record) == 1U )           /*!< Return true if the Id Length bit is set     */
+#define ndefHeaderIsSetCF(record)        ( ndefHeaderCF(record) == 1U )           /*!< Return true if the Chunk Flag bit is set    */
 
 
 typedef struct ndefTypeStruct ndefType;       /*!< Forward declaration */
@@ -129,6 +131,9 @@ typedef struct ndefRecordStruct {
 
   const ndefType *ndeftype;      /*!< Well-known type data */
 
+  struct ndefRecordStruct *chunk; /*!< Next chunk of a decoded chunked record, if any */
+  uint32_t chunkLength;          /*!< Encode the payload as chunks of this length, 0 for a single record */
+
   struct ndefRecordStruct *next; /*!< Pointer to the next record, if any */
 } ndefRecord;
 
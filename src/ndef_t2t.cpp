@@ -43,13 +43,14 @@
  ******************************************************************************
  */
 
+#if NDEF_FEATURE_T2T
+
 /*
  ******************************************************************************
  * GLOBAL DEFINES
  ******************************************************************************
  */
 
-#define NDEF_T2T_BLOCK_SIZE            4U         /*!< block size                                        */
 #define NDEF_T2T_MAX_SECTOR          255U         /*!< Max Number of Sector in Sector Select Command     */ /* 00h -- FEh: 255 sectors */
 #define NDEF_T2T_BLOCKS_PER_SECTOR   256U         /*!< Number of Block per Sector                        */
 #define NDEF_T2T_BYTES_PER_SECTOR (NDEF_T2T_BLOCKS_PER_SECTOR * NDEF_T2T_BLOCK_SIZE) /*!< Number of Bytes per Sector                        */
@@ -60,6 +61,7 @@
 #define NDEF_T2T_CC_OFFSET            12U         /*!< CC offset                                         */
 #define NDEF_T2T_CC_LEN                4U         /*!< CC length                                         */
 #define NDEF_T2T_AREA_OFFSET          16U         /*!< T2T Area starts at block #4                       */
+#define NDEF_T2T_STATIC_LOCK_BLOCK     2U         /*!< Block holding the static lock bytes               */
 
 #define NDEF_T2T_MAGIC              0xE1U         /*!< CC Magic Number                                   */
 #define NDEF_T2T_CC_0                  0U         /*!< CC_0: Magic Number                                */
@@ -95,7 +97,6 @@
  */
 
 #define ndefT2TisT2TDevice(device) ((((device)->type == RFAL_NFC_LISTEN_TYPE_NFCA) && ((device)->dev.nfca.type == RFAL_NFCA_T2T)))
-#define ndefT2TInvalidateCache() { subCtx.t2t.cacheAddr = 0xFFFFFFFFU; }
 
 
 #define ndefT2TIsReadOnlyAccessGranted()  ((cc.t2t.readAccess == 0x0U) && (cc.t2t.writeAccess == 0xFU))
@@ -152,6 +153,29 @@ ReturnCode NdefClass::ndefT2TPollerReadBlock(uint16_t blockAddr, uint8_t *buf)
   return ret;
 }
 
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT2TPollerReadBlocks(uint16_t blockAddr, uint8_t nbReads, uint8_t *buf)
+{
+  ReturnCode           ret;
+  uint8_t              secNo;
+
+  if (!ndefT2TisT2TDevice(&device) || (buf == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  secNo = (uint8_t)(blockAddr >> 8U);
+
+  if (secNo != subCtx.t2t.currentSecNo) {
+    ret = rfal_nfc->rfalT2TPollerSectorSelect(secNo);
+    if (ret != ST_ERR_NONE) {
+      return ret;
+    }
+    subCtx.t2t.currentSecNo = secNo;
+  }
+
+  return rfal_nfc->rfalT2TPollerReadBatch((uint8_t)blockAddr, nbReads, buf);
+}
+
 /*******************************************************************************/
 ReturnCode NdefClass::ndefT2TPollerReadBytes(uint32_t offset, uint32_t len, uint8_t *buf, uint32_t *rcvdLen)
 {
@@ -162,50 +186,44 @@ ReturnCode NdefClass::ndefT2TPollerReadBytes(uint32_t offset, uint32_t len, uint
   uint8_t             *lvBuf    = buf;
   uint16_t             blockAddr;
   uint8_t              byteNo;
+  uint8_t              nbReads;
 
   if (!ndefT2TisT2TDevice(&device) || (lvLen == 0U) || (offset > NDEF_T2T_MAX_OFFSET)) {
     return ST_ERR_PARAM;
   }
 
-  if ((offset >= subCtx.t2t.cacheAddr) && (offset < (subCtx.t2t.cacheAddr + NDEF_T2T_READ_RESP_SIZE)) && ((offset + len) < (subCtx.t2t.cacheAddr + NDEF_T2T_READ_RESP_SIZE))) {
-    /* data in cache buffer */
-    (void)ST_MEMCPY(lvBuf, &subCtx.t2t.cacheBuf[offset - subCtx.t2t.cacheAddr], len);
-  } else {
-    do {
-      blockAddr = (uint16_t)(lvOffset / NDEF_T2T_BLOCK_SIZE);
-      byteNo    = (uint8_t)(lvOffset % NDEF_T2T_BLOCK_SIZE);
-      le = (lvLen < NDEF_T2T_READ_RESP_SIZE) ? (uint8_t)lvLen : (uint8_t)NDEF_T2T_READ_RESP_SIZE;
-
-      if ((byteNo != 0U) || (lvLen < NDEF_T2T_READ_RESP_SIZE)) {
-        ret = ndefT2TPollerReadBlock(blockAddr, subCtx.t2t.cacheBuf);
-        if (ret != ST_ERR_NONE) {
-          ndefT2TInvalidateCache();
-          return ret;
-        }
-        subCtx.t2t.cacheAddr = (uint32_t)blockAddr * NDEF_T2T_BLOCK_SIZE;
-        if ((NDEF_T2T_READ_RESP_SIZE - byteNo) < le) {
-          le = NDEF_T2T_READ_RESP_SIZE - byteNo;
-        }
-        if (le > 0U) {
-          (void)ST_MEMCPY(lvBuf, &subCtx.t2t.cacheBuf[byteNo], le);
-        }
-      } else {
-        ret = ndefT2TPollerReadBlock(blockAddr, lvBuf);
-        if (ret != ST_ERR_NONE) {
-          return ret;
-        }
-        if (lvLen == le) {
-          /* cache the last read block */
-          (void)ST_MEMCPY(&subCtx.t2t.cacheBuf[0], lvBuf, NDEF_T2T_READ_RESP_SIZE);
-          subCtx.t2t.cacheAddr = (uint32_t)blockAddr * NDEF_T2T_BLOCK_SIZE;
-        }
+  do {
+    blockAddr = (uint16_t)(lvOffset / NDEF_T2T_BLOCK_SIZE);
+    byteNo    = (uint8_t)(lvOffset % NDEF_T2T_BLOCK_SIZE);
+
+    if ((byteNo != 0U) || (lvLen < NDEF_T2T_READ_RESP_SIZE)) {
+      /* Unaligned or short: served from the block cache, up to the next block boundary or the end */
+      le = (lvLen < NDEF_T2T_READ_RESP_SIZE) ? (uint8_t)lvLen : (uint8_t)(NDEF_T2T_BLOCK_SIZE - byteNo);
+
+      ret = ndefBlockCacheRead(lvOffset, le, lvBuf);
+      if (ret != ST_ERR_NONE) {
+        return ret;
       }
-      lvBuf     = &lvBuf[le];
-      lvOffset += le;
-      lvLen    -= le;
+    } else {
+      /* Aligned: issue as many READs as possible back to back within the current sector, once pending writes are on the tag */
+      ret = ndefBlockCacheFlush();
+      if (ret != ST_ERR_NONE) {
+        return ret;
+      }
+      nbReads = (uint8_t)MIN((lvLen / NDEF_T2T_READ_RESP_SIZE), RFAL_T2T_READ_BATCH_MAX);
+      nbReads = (uint8_t)MIN(nbReads, ((NDEF_T2T_BLOCKS_PER_SECTOR - (blockAddr % NDEF_T2T_BLOCKS_PER_SECTOR)) + (NDEF_T2T_READ_RESP_SIZE / NDEF_T2T_BLOCK_SIZE) - 1U) / (NDEF_T2T_READ_RESP_SIZE / NDEF_T2T_BLOCK_SIZE));
+      le      = (uint8_t)(nbReads * NDEF_T2T_READ_RESP_SIZE);
 
-    } while (lvLen != 0U);
-  }
+      ret = ndefT2TPollerReadBlocks(blockAddr, nbReads, lvBuf);
+      if (ret != ST_ERR_NONE) {
+        return ret;
+      }
+    }
+    lvBuf     = &lvBuf[le];
+    lvOffset += le;
+    lvLen    -= le;
+
+  } while (lvLen != 0U);
 
   if (rcvdLen != NULL) {
     *rcvdLen = len;
@@ -224,7 +242,7 @@ ReturnCode NdefClass::ndefT2TPollerContextInitialization(rfalNfcDevice *dev)
 
   state                   = NDEF_STATE_INVALID;
   subCtx.t2t.currentSecNo = 0U;
-  ndefT2TInvalidateCache();
+  ndefBlockCacheInvalidate();
 
   return ST_ERR_NONE;
 }
@@ -235,6 +253,7 @@ ReturnCode NdefClass::ndefT2TPollerNdefDetect(ndefInfo *info)
   ReturnCode           ret;
   uint8_t              data[2];
   uint32_t             offset;
+  uint32_t             tlvOffset;
   uint16_t             lenTLV;
   uint8_t              typeTLV;
 
@@ -273,6 +292,24 @@ ReturnCode NdefClass::ndefT2TPollerNdefDetect(ndefInfo *info)
   }
   /* Search for NDEF message TLV TS T2T v1.0 7.5.1.3 */
   offset = NDEF_T2T_AREA_OFFSET;
+  if (ndefCacheIsValid(NDEF_T2T_CC_LEN) && (tagCacheEntry->tlvOffset >= (NDEF_T2T_AREA_OFFSET + NDEF_T2T_READ_RESP_SIZE))) {
+    /* Known tag with unchanged CC: go straight to the NDEF message TLV if its T and L fields still fit the area.
+     * A TLV within the first READ is reached by the walk below for the price of that same READ */
+    tlvOffset = tagCacheEntry->tlvOffset;
+    ret = ndefT2TPollerReadBytes(tlvOffset, 2, data, NULL);
+    if ((ret == ST_ERR_NONE) && (data[0] == NDEF_T2T_TLV_NDEF_MESSAGE)) {
+      lenTLV = data[1];
+      tlvOffset += 2U;
+      if (lenTLV == NDEF_T2T_3_BYTES_TLV_LEN) {
+        ret = ndefT2TPollerReadBytes(tlvOffset, 2, data, NULL);
+        lenTLV = GETU16(&data[0]);
+        tlvOffset += 2U;
+      }
+      if ((ret == ST_ERR_NONE) && ((tlvOffset + lenTLV) <= (NDEF_T2T_AREA_OFFSET + areaLen))) {
+        offset = tagCacheEntry->tlvOffset;
+      }
+    }
+  }
   while ((offset < (NDEF_T2T_AREA_OFFSET + areaLen))) {
     ret = ndefT2TPollerReadBytes(offset, 1, data, NULL);
     if (ret != ST_ERR_NONE) {
@@ -345,6 +382,7 @@ ReturnCode NdefClass::ndefT2TPollerNdefDetect(ndefInfo *info)
         info->areaAvalableSpaceLen = areaLen - messageOffset;
         info->messageLen           = messageLen;
       }
+      ndefCacheStore();
       return ST_ERR_NONE;
     }
     offset += lenTLV;
@@ -406,59 +444,21 @@ ReturnCode NdefClass::ndefT2TPollerWriteBlock(uint16_t blockAddr, const uint8_t
 
   ret = rfal_nfc->rfalT2TPollerWrite(blNo, buf);
 
+  /* Keep the block cache in line with the tag */
+  ndefBlockCacheUpdate(blockAddr, 1U, buf, (ret == ST_ERR_NONE));
+
   return ret;
 }
 
 /*******************************************************************************/
 ReturnCode NdefClass::ndefT2TPollerWriteBytes(uint32_t offset, const uint8_t *buf, uint32_t len)
 {
-  ReturnCode           ret;
-  uint32_t             lvOffset = offset;
-  uint32_t             lvLen    = len;
-  const uint8_t       *lvBuf    = buf;
-  uint16_t             blockAddr;
-  uint8_t              byteNo;
-  uint8_t              le;
-  uint8_t              tempBuf[NDEF_T2T_READ_RESP_SIZE];
-
-  if (!ndefT2TisT2TDevice(&device) || (lvLen == 0U)) {
+  if (!ndefT2TisT2TDevice(&device) || (buf == NULL) || (len == 0U)) {
     return ST_ERR_PARAM;
   }
 
-  ndefT2TInvalidateCache();
-
-  do {
-    blockAddr = (uint16_t)(lvOffset / NDEF_T2T_BLOCK_SIZE);
-    byteNo    = (uint8_t)(lvOffset % NDEF_T2T_BLOCK_SIZE);
-    le = (lvLen < NDEF_T2T_BLOCK_SIZE) ? (uint8_t)lvLen : (uint8_t)NDEF_T2T_BLOCK_SIZE;
-    if ((byteNo != 0U) || (lvLen < NDEF_T2T_BLOCK_SIZE)) {
-      ret = ndefT2TPollerReadBlock(blockAddr, tempBuf);
-      if (ret != ST_ERR_NONE) {
-        return ret;
-      }
-      if ((NDEF_T2T_BLOCK_SIZE - byteNo) < le) {
-        le = NDEF_T2T_BLOCK_SIZE - byteNo;
-      }
-      if (le > 0U) {
-        (void)ST_MEMCPY(&tempBuf[byteNo], lvBuf, le);
-      }
-      ret = ndefT2TPollerWriteBlock(blockAddr, tempBuf);
-      if (ret != ST_ERR_NONE) {
-        return ret;
-      }
-    } else {
-      ret = ndefT2TPollerWriteBlock(blockAddr, lvBuf);
-      if (ret != ST_ERR_NONE) {
-        return ret;
-      }
-    }
-    lvBuf     = &lvBuf[le];
-    lvOffset += le;
-    lvLen    -= le;
-
-  } while (lvLen != 0U);
-
-  return ST_ERR_NONE;
+  /* Blocks are written back by ndefBlockCacheFlush(); partial blocks are merged in RAM */
+  return ndefBlockCacheWrite(offset, buf, len);
 }
 
 /*******************************************************************************/
@@ -492,6 +492,12 @@ ReturnCode NdefClass::ndefT2TPollerWriteRawMessageLen(uint32_t rawMessageLen)
     dataIt++;
   }
 
+  /* The message data reaches the tag before the L-field that validates it */
+  ret = ndefBlockCacheFlush();
+  if (ret != ST_ERR_NONE) {
+    return ret;
+  }
+
   ret = ndefT2TPollerWriteBytes(subCtx.t2t.offsetNdefTLV, buf, dataIt);
   if ((ret != ST_ERR_NONE) && (rawMessageLen != 0U) && ((messageOffset + rawMessageLen) < areaLen)) {
     /* Write Terminator TLV */
@@ -500,6 +506,9 @@ ReturnCode NdefClass::ndefT2TPollerWriteRawMessageLen(uint32_t rawMessageLen)
     dataIt++;
     (void)ndefT2TPollerWriteBytes(messageOffset + rawMessageLen, buf, dataIt);
   }
+  if (ret == ST_ERR_NONE) {
+    ret = ndefBlockCacheFlush();
+  }
 
   return ret;
 }
@@ -580,8 +589,6 @@ ReturnCode NdefClass::ndefT2TPollerTagFormat(const ndefCapabilityContainer *cc_p
     return ret;
   }
 
-  ndefT2TInvalidateCache();
-
   /*
    * Write CC only in case of virgin CC area
    */
@@ -622,23 +629,121 @@ ReturnCode NdefClass::ndefT2TPollerTagFormat(const ndefCapabilityContainer *cc_p
 }
 
 /*******************************************************************************/
-ReturnCode NdefClass::ndefT2TPollerCheckPresence()
+ReturnCode NdefClass::ndefT2TPollerPersonalize(const ndefCapabilityContainer *cc_p, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report)
 {
   ReturnCode           ret;
+  ndefMessageInfo      info;
+  ndefPersonalizePlan  plan;
+  uint8_t              prefix[NDEF_T2T_CC_LEN + NDEF_T2T_TLV_T_LEN + NDEF_T2T_TLV_L_3_BYTES_LEN];
+  uint32_t             prefixLen;
+  uint32_t             tlvLen;
+  uint32_t             area;
+  uint8_t              writeAccess;
+  uint32_t             startUs;
+  uint32_t             stepUs;
+  static const uint8_t lockBytes[NDEF_T2T_BLOCK_SIZE] = { 0x00U, 0x00U, 0xFFU, 0xFFU }; /* Serial bytes are read-only, lock bytes are OR-ed */
+
+  if (!ndefT2TisT2TDevice(&device)) {
+    return ST_ERR_PARAM;
+  }
+
+  startUs = rfal_nfc->rfalNfcGetTimeUs();
+
+  /*
+   * Plan: everything is checked before the first command
+   */
+  (void)ndefMessageGetInfo(message, &info);
+
+  tlvLen = NDEF_T2T_TLV_T_LEN + ((info.length > NDEF_SHORT_VFIELD_MAX_LEN) ? NDEF_T2T_TLV_L_3_BYTES_LEN : NDEF_T2T_TLV_L_1_BYTES_LEN) + info.length;
+  area   = (uint32_t)cc_p->t2t.size * NDEF_T2T_SIZE_DIVIDER;
+  if (tlvLen > area) {
+    return ST_ERR_NOMEM;
+  }
+
+  /* Static lock bytes only cover the static memory, dynamic lock bits are not handled */
+  if (((lockOptions & NDEF_PERSONALIZE_LOCK_PERMANENT) != 0U) && (area > NDEF_T2T_STATIC_MEM_SIZE)) {
+    return ST_ERR_NOTSUPP;
+  }
+
+  writeAccess = (lockOptions != NDEF_PERSONALIZE_LOCK_NONE) ? 0xFU : cc_p->t2t.writeAccess;
+
+  prefixLen = 0U;
+  prefix[prefixLen++] = cc_p->t2t.magicNumber;
+  prefix[prefixLen++] = (uint8_t)(cc_p->t2t.majorVersion << 4U) | cc_p->t2t.minorVersion;
+  prefix[prefixLen++] = cc_p->t2t.size;
+  prefix[prefixLen++] = (uint8_t)(cc_p->t2t.readAccess << 4U) | writeAccess;
+  prefix[prefixLen++] = NDEF_T2T_TLV_NDEF_MESSAGE;
+  if (info.length > NDEF_SHORT_VFIELD_MAX_LEN) {
+    prefix[prefixLen++] = 0xFFU;
+    prefix[prefixLen++] = (uint8_t)(info.length >> 8U);
+  }
+  prefix[prefixLen++] = (uint8_t)info.length;
+
+  /* CC block first, message blocks, then the TLV head block */
+  ndefPollerPersonalizeInit(&plan, NDEF_T2T_BLOCK_SIZE, NDEF_T2T_BLOCK_SIZE, NDEF_T2T_AREA_OFFSET);
+  ndefPollerDropReadCache();
+
+  stepUs         = rfal_nfc->rfalNfcGetTimeUs();
+  report->planUs = stepUs - startUs;
+
+  /*
+   * Write
+   */
+  ret = ndefPollerPersonalizeStream(&plan, NDEF_T2T_CC_OFFSET, prefix, prefixLen, message, (tlvLen < area));
+
+  report->writeCmds    = plan.writeCmds;
+  report->bytesWritten = plan.bytesWritten;
+  report->writeUs      = rfal_nfc->rfalNfcGetTimeUs() - stepUs;
+  stepUs               = rfal_nfc->rfalNfcGetTimeUs();
+
+  /*
+   * Lock
+   */
+  if ((ret == ST_ERR_NONE) && ((lockOptions & NDEF_PERSONALIZE_LOCK_PERMANENT) != 0U)) {
+    ret = ndefT2TPollerWriteBlock(NDEF_T2T_STATIC_LOCK_BLOCK, lockBytes);
+    report->lockCmds++;
+  }
+  report->lockUs = rfal_nfc->rfalNfcGetTimeUs() - stepUs;
+
+  ndefPollerDropReadCache();
+
+  if (ret == ST_ERR_NONE) {
+    /* Update info about current NDEF */
+    cc.t2t.magicNumber       = cc_p->t2t.magicNumber;
+    cc.t2t.majorVersion      = cc_p->t2t.majorVersion;
+    cc.t2t.minorVersion      = cc_p->t2t.minorVersion;
+    cc.t2t.size              = cc_p->t2t.size;
+    cc.t2t.readAccess        = cc_p->t2t.readAccess;
+    cc.t2t.writeAccess       = writeAccess;
+    areaLen                  = area;
+    subCtx.t2t.offsetNdefTLV = NDEF_T2T_AREA_OFFSET;
+    messageOffset            = NDEF_T2T_AREA_OFFSET + (tlvLen - info.length);
+    messageLen               = info.length;
+    if (writeAccess != 0U) {
+      state = NDEF_STATE_READONLY;
+    } else {
+      state = (messageLen == 0U) ? NDEF_STATE_INITIALIZED : NDEF_STATE_READWRITE;
+    }
+  } else {
+    state = NDEF_STATE_INVALID;
+  }
+
+  report->totalUs = rfal_nfc->rfalNfcGetTimeUs() - startUs;
+  return ret;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT2TPollerCheckPresence()
+{
   uint16_t             blockAddr;
+  uint8_t              rsp[NDEF_T2T_READ_RESP_SIZE];
 
   if (!ndefT2TisT2TDevice(&device)) {
     return ST_ERR_PARAM;
   }
 
   blockAddr = 0U;
-  ret = ndefT2TPollerReadBlock(blockAddr, subCtx.t2t.cacheBuf);
-  if (ret != ST_ERR_NONE) {
-    ndefT2TInvalidateCache();
-    return ret;
-  }
-  subCtx.t2t.cacheAddr = (uint32_t)blockAddr * NDEF_T2T_BLOCK_SIZE;
-  return ST_ERR_NONE;
+  return ndefT2TPollerReadBlock(blockAddr, rsp);
 }
 
 /*******************************************************************************/
@@ -718,3 +823,5 @@ ReturnCode NdefClass::ndefT2TPollerEndWriteMessage(uint32_t messageLen)
   state = (messageLen == 0U) ? NDEF_STATE_INITIALIZED : NDEF_STATE_READWRITE;
   return ST_ERR_NONE;
 }
+
+#endif /* NDEF_FEATURE_T2T */
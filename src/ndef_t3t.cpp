@@ -43,6 +43,8 @@
  ******************************************************************************
  */
 
+#if NDEF_FEATURE_T3T
+
 /*
  ******************************************************************************
  * GLOBAL DEFINES
@@ -138,7 +140,7 @@ ReturnCode NdefClass::ndefT3TPollerReadBlocks(uint16_t blockNum, uint8_t nbBlock
   servBlock.numBlock  = nbBlocks;
   servBlock.blockList = listBlocks;
 
-  ret = rfal_nfc->rfalNfcfPollerCheck(device.dev.nfcf.sensfRes.NFCID2, &servBlock, subCtx.t3t.rxbuf, (uint16_t)sizeof(subCtx.t3t.rxbuf), &rcvdLen);
+  ret = rfal_nfc->rfalNfcfPollerCheck(device.dev.nfcf.sensfRes.NFCID2, &servBlock, subCtx.t3t.rxbuf, (uint16_t)NDEF_T3T_MAX_RX_SIZE, &rcvdLen);
   if (ret != ST_ERR_NONE) {
     return ret;
   }
@@ -158,7 +160,7 @@ ReturnCode NdefClass::ndefT3TPollerReadBlocks(uint16_t blockNum, uint8_t nbBlock
 ReturnCode NdefClass::ndefT3TPollerReadBytes(uint32_t offset, uint32_t len, uint8_t *buf, uint32_t *rcvdLen)
 {
   uint16_t        res;
-  uint16_t        nbRead;
+  uint16_t        nbRead     = 0U;
   ReturnCode      result     = ST_ERR_NONE;
   uint32_t        currentLen = len;
   uint32_t        lvRcvLen   = 0U;
@@ -176,28 +178,23 @@ ReturnCode NdefClass::ndefT3TPollerReadBytes(uint32_t offset, uint32_t len, uint
   }
 
   if (startOffset != 0U) {
-    /* Unaligned read, need to use a tmp buffer */
-    res = ndefT3TPollerReadBlocks(startBlock, 1U /* One block */, subCtx.t3t.rxbuf, blockLen, &nbRead);
-    if (res != ST_ERR_NONE) {
-      /* Check result */
-      result = res;
-    } else if (nbRead != NDEF_T3T_BLOCKLEN) {
-      /* Check len */
-      result = ST_ERR_MEM_CORRUPT;
-    } else {
-      nbRead = (uint16_t)(nbRead - (uint16_t)startOffset);
-      if ((uint32_t) nbRead > currentLen) {
-        nbRead = (uint16_t) currentLen;
-      }
-      if (nbRead > 0U) {
-        (void)ST_MEMCPY(buf, &subCtx.t3t.rxbuf[offset], (uint32_t)nbRead);
-      }
+    /* Unaligned read, served from the block cache */
+    nbRead = (uint16_t)(blockLen - startOffset);
+    if ((uint32_t) nbRead > currentLen) {
+      nbRead = (uint16_t) currentLen;
+    }
+    result = ndefBlockCacheRead(offset, nbRead, buf);
+    if (result == ST_ERR_NONE) {
       lvRcvLen   += (uint32_t) nbRead;
       currentLen -= (uint32_t) nbRead;
       startBlock++;
     }
   }
 
+  if ((currentLen >= (uint32_t)blockLen) && (result == ST_ERR_NONE)) {
+    /* Pending writes reach the tag before the blocks are read directly */
+    result = ndefBlockCacheFlush();
+  }
   while ((currentLen >= (uint32_t)blockLen) && (result == ST_ERR_NONE)) {
     if (currentLen < ((uint32_t)blockLen * nbBlocks)) {
       /* Reduce the nb of blocks to read */
@@ -211,28 +208,21 @@ ReturnCode NdefClass::ndefT3TPollerReadBytes(uint32_t offset, uint32_t len, uint
       /* Check len */
       return ST_ERR_MEM_CORRUPT;
     } else {
-      (void)ST_MEMCPY(&buf[lvRcvLen], subCtx.t3t.rxbuf, (uint32_t)currentLen);
+      (void)ST_MEMCPY(&buf[lvRcvLen], subCtx.t3t.rxbuf, (uint32_t)nbRead);
       lvRcvLen   += nbRead;
       currentLen -= nbRead;
       startBlock += nbBlocks;
     }
   }
   if ((currentLen > 0U) && (result == ST_ERR_NONE)) {
-    /* Unaligned read, need to use a tmp buffer */
-    res = ndefT3TPollerReadBlocks(startBlock, 1U /* One block */, subCtx.t3t.rxbuf, blockLen, &nbRead);
+    /* Unaligned read, served from the block cache */
+    res = ndefBlockCacheRead((uint32_t)startBlock * blockLen, currentLen, &buf[lvRcvLen]);
     if (res != ST_ERR_NONE) {
       /* Check result */
       return res;
-    } else if (nbRead != NDEF_T3T_BLOCKLEN) {
-      /* Check len */
-      return ST_ERR_MEM_CORRUPT;
-    } else {
-      if (currentLen > 0U) {
-        (void)ST_MEMCPY(&buf[lvRcvLen], subCtx.t3t.rxbuf, (uint32_t)currentLen);
-      }
-      lvRcvLen   += (uint32_t) currentLen;
-      currentLen -= (uint32_t) currentLen;
     }
+    lvRcvLen   += (uint32_t) currentLen;
+    currentLen -= (uint32_t) currentLen;
   }
   if ((currentLen == 0U) && (result == ST_ERR_NONE)) {
     result = ST_ERR_NONE;
@@ -292,9 +282,25 @@ ReturnCode NdefClass::ndefT3TPollerContextInitialization(rfalNfcDevice *dev)
     return ST_ERR_PARAM;
   }
 
+  if (workArea != NULL) {
+    if (workAreaLen < NDEF_T3T_WORK_AREA_LEN) {
+      return ST_ERR_NOMEM;
+    }
+    subCtx.t3t.txbuf = workArea;
+    subCtx.t3t.rxbuf = &workArea[NDEF_T3T_MAX_TX_SIZE];
+  } else {
+#if NDEF_EXTERNAL_WORK_AREA
+    return ST_ERR_NOMEM;
+#else
+    subCtx.t3t.txbuf = subCtx.t3t.txbufStore;
+    subCtx.t3t.rxbuf = subCtx.t3t.rxbufStore;
+#endif
+  }
+
   (void)ST_MEMCPY(&device, dev, sizeof(device));
 
   state                   = NDEF_STATE_INVALID;
+  ndefBlockCacheInvalidate();
 
   return ST_ERR_NONE;
 }
@@ -428,7 +434,10 @@ ReturnCode NdefClass::ndefT3TPollerWriteBlocks(uint16_t blockNum, uint8_t nbBloc
   servBlock.numBlock  = nbBlocks;
   servBlock.blockList = listBlocks;
 
-  ret = rfal_nfc->rfalNfcfPollerUpdate(device.dev.nfcf.sensfRes.NFCID2, &servBlock, subCtx.t3t.txbuf, (uint16_t)sizeof(subCtx.t3t.txbuf), dataBlocks, subCtx.t3t.rxbuf, (uint16_t)sizeof(subCtx.t3t.rxbuf));
+  ret = rfal_nfc->rfalNfcfPollerUpdate(device.dev.nfcf.sensfRes.NFCID2, &servBlock, subCtx.t3t.txbuf, (uint16_t)NDEF_T3T_MAX_TX_SIZE, dataBlocks, subCtx.t3t.rxbuf, (uint16_t)NDEF_T3T_MAX_RX_SIZE);
+
+  /* Keep the block cache in line with the tag */
+  ndefBlockCacheUpdate(blockNum, nbBlocks, dataBlocks, (ret == ST_ERR_NONE));
 
   return ret;
 }
@@ -436,92 +445,12 @@ ReturnCode NdefClass::ndefT3TPollerWriteBlocks(uint16_t blockNum, uint8_t nbBloc
 /*******************************************************************************/
 ReturnCode NdefClass::ndefT3TPollerWriteBytes(uint32_t offset, const uint8_t *buf, uint32_t len)
 {
-  uint16_t        nbRead;
-  uint16_t        nbWrite;
-  uint16_t        res;
-  ReturnCode      result     = ST_ERR_NONE;
-  uint32_t        currentLen = len;
-  uint32_t        txtLen     = 0U;
-  const uint16_t  blockLen   = (uint16_t)NDEF_T3T_BLOCKLEN;
-  uint16_t        nbBlocks   = (uint16_t) NDEF_T3T_NBBLOCKSMAX;
-  uint16_t        startBlock = (uint16_t)(offset / blockLen);
-  uint16_t        startAddr  = (uint16_t)(startBlock * blockLen);
-  uint16_t        startOffset = (uint16_t)(offset - (uint32_t) startAddr);
-  uint8_t         tmpBuf[NDEF_T3T_BLOCKLEN];
-
-  if (!ndefT3TisT3TDevice(&device) || (len == 0U)) {
+  if (!ndefT3TisT3TDevice(&device) || (buf == NULL) || (len == 0U)) {
     return ST_ERR_PARAM;
   }
-  if (state != NDEF_STATE_INVALID) {
-    nbBlocks = cc.t3t.nbW;
-  }
 
-  if (startOffset != 0U) {
-    /* Unaligned write, need to use a tmp buffer */
-    res = ndefT3TPollerReadBlocks(startBlock, 1, tmpBuf, blockLen, &nbRead);
-    if (res != ST_ERR_NONE) {
-      /* Check result */
-      result = res;
-    } else if (nbRead != blockLen) {
-      /* Check len */
-      result = ST_ERR_MEM_CORRUPT;
-    } else {
-      /* Fill the rest of the buffer with user data */
-      nbWrite =  NDEF_T3T_BLOCKLEN - startOffset;
-      if (nbWrite >  len) {
-        nbWrite = (uint16_t) len;
-      }
-      (void)ST_MEMCPY(&tmpBuf[startOffset], buf, nbWrite);
-      res = ndefT3TPollerWriteBlocks(startBlock, 1U /* One block */, tmpBuf);
-      if (res == ST_ERR_NONE) {
-        txtLen     += (uint32_t) nbWrite;
-        currentLen -= (uint32_t) nbWrite;
-        startBlock++;
-      } else {
-        result = res; /* Copy the error code */
-      }
-    }
-  }
-  while ((currentLen >= (uint32_t)blockLen) && (result == ST_ERR_NONE)) {
-    if (currentLen < ((uint32_t)blockLen * nbBlocks)) {
-      /* Reduce the nb of blocks to read */
-      nbBlocks = (uint16_t)(currentLen / blockLen);
-    }
-    nbWrite = blockLen * nbBlocks;
-    res     = ndefT3TPollerWriteBlocks(startBlock, (uint8_t) nbBlocks, &buf[txtLen]);
-    if (res != ST_ERR_NONE) {
-      /* Check result */
-      result = res;
-    } else {
-      txtLen     += nbWrite;
-      currentLen -= nbWrite;
-      startBlock += nbBlocks;
-    }
-  }
-  if ((currentLen > 0U) && (result == ST_ERR_NONE)) {
-    /* Unaligned write, need to use a tmp buffer */
-    res = ndefT3TPollerReadBlocks(startBlock, 1U /* One block */, tmpBuf, blockLen, &nbRead);
-    if (res != ST_ERR_NONE) {
-      /* Check result */
-      result = res;
-    } else if (nbRead != blockLen) {
-      /* Check len */
-      result = ST_ERR_MEM_CORRUPT;
-    } else {
-      /* Fill the beginning of the buffer with user data */
-      (void)ST_MEMCPY(tmpBuf, &buf[txtLen], currentLen);
-      res = ndefT3TPollerWriteBlocks(startBlock, 1U /* One block */, tmpBuf);
-      if (res == ST_ERR_NONE) {
-        currentLen = 0U;
-      } else {
-        result = res; /* Copy the error code */
-      }
-    }
-  }
-  if ((currentLen == 0U) && (result == ST_ERR_NONE)) {
-    result = ST_ERR_NONE;
-  }
-  return result;
+  /* Consecutive dirty blocks are written back nbW at a time by ndefBlockCacheFlush() */
+  return ndefBlockCacheWrite(offset, buf, len);
 }
 
 /*******************************************************************************/
@@ -538,6 +467,11 @@ ReturnCode NdefClass::ndefT3TPollerWriteAttributeInformationBlock()
   if (state < NDEF_STATE_INITIALIZED) {
     return ST_ERR_WRONG_STATE;
   }
+  /* The message data reaches the tag before Ln and WriteFlag are updated */
+  ret = ndefBlockCacheFlush();
+  if (ret != ST_ERR_NONE) {
+    return ret;
+  }
   dataIt        = 0U;
   buf           = ccBuf;
   checksum      = 0U;
@@ -770,3 +704,5 @@ ReturnCode NdefClass::ndefT3TPollerWriteRawMessageLen(uint32_t rawMessageLen)
   }
   return ndefT3TPollerEndWriteMessage(rawMessageLen);
 }
+
+#endif /* NDEF_FEATURE_T3T */
@@ -43,6 +43,8 @@
  ******************************************************************************
  */
 
+#if NDEF_FEATURE_T4T
+
 /*
  ******************************************************************************
  * GLOBAL DEFINES
@@ -64,6 +66,8 @@
 
 #define NDEF_T4T_FID_SIZE              2U        /*!< File Id size                                      */
 #define NDEF_T4T_WRITE_ODO_PREFIX_SIZE 7U        /*!< Size of ODO for Write Binary: 54 03 xxyyzz 53 Ld  */
+#define NDEF_T4T_WRITE_ODO_LD_EXT_SIZE 2U        /*!< Extra Ld bytes when Ld exceeds FFh: 82 Ld1 Ld2    */
+#define NDEF_T4T_MAX_SHORT_LC        255U        /*!< Maximum Lc value with short field coding          */
 
 #define NDEF_T4T_DEFAULT_MLC      0x000DU        /*!< Defauit Max Lc value before reading CCFILE values */
 #define NDEF_T4T_DEFAULT_MLE      0x000FU        /*!< Defauit Max Le value before reading CCFILE values */
@@ -91,7 +95,7 @@
 #define NDEF_T4T_MV2_MAX_OFSSET   0x7FFFU        /*!< ReadBinary maximum Offset (offset range 0000-7FFFh)*/
 
 #define NDEF_T4T_MAX_MLE             255U        /*!< Maximum MLe value supported in this implementation (short field coding). Le=0 (MLe=256) not supported by some tag. */
-#define NDEF_T4T_MAX_MLC             255U        /*!< Maximum MLc value supported in this implementation (short field coding).                                           */
+#define NDEF_T4T_MAX_MLC  (RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN - RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN - RFAL_T4T_LC_EXT_LEN) /*!< Maximum MLc value supported in this implementation (extended field coding, chained over ISO-DEP). */
 
 /*
  ******************************************************************************
@@ -132,14 +136,14 @@
 void NdefClass::ndefT4TInitializeIsoDepTxRxParam(rfalIsoDepApduTxRxParam *isoDepAPDU)
 {
   /* Initialize the ISO-DEP protocol transceive context */
-  isoDepAPDU->txBuf        = &subCtx.t4t.cApduBuf;
+  isoDepAPDU->txBuf        = subCtx.t4t.cApduBuf;
   isoDepAPDU->DID          = device.proto.isoDep.info.DID;
   isoDepAPDU->FWT          = device.proto.isoDep.info.FWT;
   isoDepAPDU->dFWT         = device.proto.isoDep.info.dFWT;
   isoDepAPDU->FSx          = device.proto.isoDep.info.FSx;
   isoDepAPDU->ourFSx       = RFAL_ISODEP_FSX_KEEP;
-  isoDepAPDU->rxBuf        = &subCtx.t4t.rApduBuf;
-  isoDepAPDU->tmpBuf       = &subCtx.t4t.tmpBuf;
+  isoDepAPDU->rxBuf        = subCtx.t4t.rApduBuf;
+  isoDepAPDU->tmpBuf       = subCtx.t4t.tmpBuf;
 }
 
 /*******************************************************************************/
@@ -148,7 +152,7 @@ ReturnCode NdefClass::ndefT4TTransceiveTxRx(rfalIsoDepApduTxRxParam *isoDepAPDU)
   ReturnCode               ret;
 
   /* Initialize respAPDU */
-  subCtx.t4t.respAPDU.rApduBuf = &subCtx.t4t.rApduBuf;
+  subCtx.t4t.respAPDU.rApduBuf = subCtx.t4t.rApduBuf;
   isoDepAPDU->rxLen                 = &subCtx.t4t.respAPDU.rcvdLen;
 
   ret = rfal_nfc->rfalIsoDepStartApduTransceive(*isoDepAPDU);
@@ -192,7 +196,7 @@ ReturnCode NdefClass::ndefT4TReadAndParseCCFile()
     /* Conclude procedure TS T4T v1.0 7.2.1.6 */
     return ret;
   }
-  (void)ST_MEMCPY(ccBuf, subCtx.t4t.rApduBuf.apdu, NDEF_T4T_CCFILEV2_LEN);
+  (void)ST_MEMCPY(ccBuf, subCtx.t4t.rApduBuf->apdu, NDEF_T4T_CCFILEV2_LEN);
   dataIt = 0;
   cc.t4t.ccLen = GETU16(&ccBuf[dataIt]);
   dataIt += (uint8_t)sizeof(uint16_t);
@@ -210,7 +214,7 @@ ReturnCode NdefClass::ndefT4TReadAndParseCCFile()
   }
 
   subCtx.t4t.curMLe   = (uint8_t)MIN(cc.t4t.mLe, NDEF_T4T_MAX_MLE); /* Only short field codind supported */
-  subCtx.t4t.curMLc   = (uint8_t)MIN(cc.t4t.mLc, NDEF_T4T_MAX_MLC); /* Only short field codind supported */
+  subCtx.t4t.curMLc   = (uint16_t)MIN(cc.t4t.mLc, NDEF_T4T_MAX_MLC); /* Extended field coding above FFh, APDU chained by ISO-DEP */
 
   /* TS T4T v1.0 7.2.1.7 and 4.3.2.4 verify support of mapping version */
   if (ndefMajorVersion(cc.t4t.vNo) > ndefMajorVersion(NDEF_T4T_MAPPING_VERSION_3_0)) {
@@ -224,7 +228,7 @@ ReturnCode NdefClass::ndefT4TReadAndParseCCFile()
       /* Conclude procedure TS T4T v1.0 7.2.1.6 */
       return ret;
     }
-    (void)ST_MEMCPY(&ccBuf[NDEF_T4T_CCFILEV2_LEN], subCtx.t4t.rApduBuf.apdu, NDEF_T4T_CCFILEV3_LEN - NDEF_T4T_CCFILEV2_LEN);
+    (void)ST_MEMCPY(&ccBuf[NDEF_T4T_CCFILEV2_LEN], subCtx.t4t.rApduBuf->apdu, NDEF_T4T_CCFILEV3_LEN - NDEF_T4T_CCFILEV2_LEN);
 
     /* TS T4T v1.0 7.2.1.7 verify coding as in table 5 */
     if (ccBuf[dataIt] != NDEF_T4T_ENDEF_CTLV_T) {
@@ -397,7 +401,7 @@ ReturnCode NdefClass::ndefT4TPollerReadBytes(uint32_t offset, uint32_t len, uint
     if (subCtx.t4t.rApduBodyLen >  lvLen) {
       return ST_ERR_SYSTEM;
     }
-    (void)ST_MEMCPY(lvBuf, subCtx.t4t.rApduBuf.apdu, subCtx.t4t.rApduBodyLen);
+    (void)ST_MEMCPY(lvBuf, subCtx.t4t.rApduBuf->apdu, subCtx.t4t.rApduBodyLen);
     lvBuf     = &lvBuf[subCtx.t4t.rApduBodyLen];
     lvOffset += subCtx.t4t.rApduBodyLen;
     lvLen    -= subCtx.t4t.rApduBodyLen;
@@ -416,6 +420,23 @@ ReturnCode NdefClass::ndefT4TPollerContextInitialization(rfalNfcDevice *dev)
     return ST_ERR_PARAM;
   }
 
+  if (workArea != NULL) {
+    if (workAreaLen < NDEF_T4T_WORK_AREA_LEN) {
+      return ST_ERR_NOMEM;
+    }
+    subCtx.t4t.cApduBuf = (rfalIsoDepApduBufFormat *)workArea;
+    subCtx.t4t.rApduBuf = (rfalIsoDepApduBufFormat *)&workArea[sizeof(rfalIsoDepApduBufFormat)];
+    subCtx.t4t.tmpBuf   = (rfalIsoDepBufFormat *)&workArea[2U * sizeof(rfalIsoDepApduBufFormat)];
+  } else {
+#if NDEF_EXTERNAL_WORK_AREA
+    return ST_ERR_NOMEM;
+#else
+    subCtx.t4t.cApduBuf = &subCtx.t4t.cApduStore;
+    subCtx.t4t.rApduBuf = &subCtx.t4t.rApduStore;
+    subCtx.t4t.tmpBuf   = &subCtx.t4t.tmpStore;
+#endif
+  }
+
   (void)ST_MEMCPY(&device, dev, sizeof(device));
 
   state             = NDEF_STATE_INVALID;
@@ -483,7 +504,7 @@ ReturnCode NdefClass::ndefT4TPollerNdefDetect(ndefInfo *info)
     /* Conclude procedure TS T4T v1.0 7.2.1.11 */
     return ret;
   }
-  nLen = subCtx.t4t.rApduBuf.apdu;
+  nLen = subCtx.t4t.rApduBuf->apdu;
   messageLen    = (nlenLen == NDEF_T4T_ENLEN_LEN) ?  GETU32(&nLen[0]) : (uint32_t)ndefBytes2Uint16(nLen[0], nLen[1]);
   messageOffset = nlenLen;
   areaLen       = cc.t4t.fileSize;
@@ -545,7 +566,7 @@ ReturnCode NdefClass::ndefT4TPollerReadRawMessage(uint8_t *buf, uint32_t bufLen,
 }
 
 /*******************************************************************************/
-ReturnCode NdefClass::ndefT4TPollerWriteBinary(uint16_t offset, const uint8_t *data, uint8_t len)
+ReturnCode NdefClass::ndefT4TPollerWriteBinary(uint16_t offset, const uint8_t *data, uint16_t len)
 {
   ReturnCode               ret;
   rfalIsoDepApduTxRxParam  isoDepAPDU;
@@ -562,7 +583,7 @@ ReturnCode NdefClass::ndefT4TPollerWriteBinary(uint16_t offset, const uint8_t *d
 }
 
 /*******************************************************************************/
-ReturnCode NdefClass::ndefT4TPollerWriteBinaryODO(uint32_t offset, const uint8_t *data, uint8_t len)
+ReturnCode NdefClass::ndefT4TPollerWriteBinaryODO(uint32_t offset, const uint8_t *data, uint16_t len)
 {
   ReturnCode               ret;
   rfalIsoDepApduTxRxParam  isoDepAPDU;
@@ -582,7 +603,8 @@ ReturnCode NdefClass::ndefT4TPollerWriteBinaryODO(uint32_t offset, const uint8_t
 ReturnCode NdefClass::ndefT4TPollerWriteBytes(uint32_t offset, const uint8_t *buf, uint32_t len)
 {
   ReturnCode           ret;
-  uint8_t              lc;
+  uint16_t             lc;
+  uint16_t             maxLc;
   uint32_t             lvOffset = offset;
   uint32_t             lvLen    = len;
   const uint8_t       *lvBuf    = buf;
@@ -591,13 +613,19 @@ ReturnCode NdefClass::ndefT4TPollerWriteBytes(uint32_t offset, const uint8_t *bu
     return ST_ERR_PARAM;
   }
 
+  /* Each UpdateBinary carries up to MLc bytes straight from the caller's buffer;
+   * above FFh the C-APDU uses extended Lc and ISO-DEP chains it over several I-Blocks */
   do {
 
     if (lvOffset > NDEF_T4T_MV2_MAX_OFSSET) {
-      lc = (lvLen > ((uint32_t)subCtx.t4t.curMLc - NDEF_T4T_WRITE_ODO_PREFIX_SIZE)) ? (uint8_t)(subCtx.t4t.curMLc - NDEF_T4T_WRITE_ODO_PREFIX_SIZE) : (uint8_t)lvLen;
+      maxLc = subCtx.t4t.curMLc - NDEF_T4T_WRITE_ODO_PREFIX_SIZE;
+      if (maxLc > NDEF_T4T_MAX_SHORT_LC) {
+        maxLc -= NDEF_T4T_WRITE_ODO_LD_EXT_SIZE;
+      }
+      lc = (lvLen > maxLc) ? maxLc : (uint16_t)lvLen;
       ret = ndefT4TPollerWriteBinaryODO(lvOffset, lvBuf, lc);
     } else {
-      lc = (lvLen > subCtx.t4t.curMLc) ? subCtx.t4t.curMLc : (uint8_t)lvLen;
+      lc = (lvLen > subCtx.t4t.curMLc) ? subCtx.t4t.curMLc : (uint16_t)lvLen;
       ret = ndefT4TPollerWriteBinary((uint16_t)lvOffset, lvBuf, lc);
     }
     if (ret != ST_ERR_NONE) {
@@ -751,7 +779,7 @@ ReturnCode NdefClass::ndefT4TPollerCheckPresence()
   (void)rfal_nfc->rfalT4TPollerComposeReadData(isoDepAPDU.txBuf, 0, 1, &isoDepAPDU.txBufLen);
 
   /* Initialize respAPDU */
-  subCtx.t4t.respAPDU.rApduBuf = &subCtx.t4t.rApduBuf;
+  subCtx.t4t.respAPDU.rApduBuf = subCtx.t4t.rApduBuf;
   isoDepAPDU.rxLen                  = &subCtx.t4t.respAPDU.rcvdLen;
 
   (void)rfal_nfc->rfalIsoDepStartApduTransceive(isoDepAPDU);
@@ -835,3 +863,5 @@ ReturnCode NdefClass::ndefT4TPollerEndWriteMessage(uint32_t messageLen)
   state = (messageLen == 0U) ? NDEF_STATE_INITIALIZED : NDEF_STATE_READWRITE;
   return ST_ERR_NONE;
 }
+
+#endif /* NDEF_FEATURE_T4T */
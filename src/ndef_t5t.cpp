@@ -43,6 +43,8 @@
 ******************************************************************************
 */
 
+#if NDEF_FEATURE_T5T
+
 /*
  ******************************************************************************
  * GLOBAL DEFINES
@@ -68,6 +70,8 @@
 
 #define NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR       256U    /*!< Max number of blocks for 1 byte addressing        */
 #define NDEF_T5T_MAX_MLEN_1_BYTE_ENCODING    256U    /*!< MLEN max value for 1 byte encoding                */
+#define NDEF_T5T_WR_MUL_REQ_HEADER_LEN         6U    /*!< (Extended) Write Multiple header: flags, cmd, block number, number of blocks */
+#define NDEF_T5T_ACCESS_NEVER               0x03U    /*!< CC write access: no write access                  */
 
 #define NDEF_T5T_TL_MAX_SIZE  (NDEF_T5T_TLV_T_LEN \
                        + NDEF_T5T_TLV_L_3_BYTES_LEN) /*!< Max TL size                                       */
@@ -122,8 +126,34 @@ ReturnCode NdefClass::ndefT5TPollerReadBytes(uint32_t offset, uint32_t len, uint
   ReturnCode      result     = ST_ERR_PARAM;
   uint32_t        currentLen = len;
   uint32_t        lvRcvLen   = 0U;
+  uint32_t        cachedLen  = 0U;
+
+  /* Pending writes reach the tag, and the read-ahead, first */
+  result = ndefBlockCacheFlush();
+  if (result != ST_ERR_NONE) {
+    return result;
+  }
+  result = ST_ERR_PARAM;
+
+  /* Serve what the NDEF detect read-ahead already holds */
+  if ((offset < subCtx.t5t.readAheadLen) && (buf != NULL) && (len > 0U)) {
+    cachedLen = subCtx.t5t.readAheadLen - offset;
+    if (cachedLen > len) {
+      cachedLen = len;
+    }
+    (void)ST_MEMCPY(buf, &subCtx.t5t.readAhead[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + offset], cachedLen);
+    offset     += cachedLen;
+    buf         = &buf[cachedLen];
+    currentLen -= cachedLen;
+    if (currentLen == 0U) {
+      if (rcvdLen != NULL) {
+        *rcvdLen = cachedLen;
+      }
+      return ST_ERR_NONE;
+    }
+  }
 
-  if ((subCtx.t5t.blockLen > 0U) && (buf != NULL) && (len > 0U)) {
+  if ((subCtx.t5t.blockLen > 0U) && (buf != NULL) && (currentLen > 0U)) {
     blockLen   = (uint16_t)subCtx.t5t.blockLen;
     if (blockLen == 0U) {
       return ST_ERR_SYSTEM;
@@ -131,18 +161,16 @@ ReturnCode NdefClass::ndefT5TPollerReadBytes(uint32_t offset, uint32_t len, uint
     startBlock = (uint16_t)(offset / blockLen);
     startAddr  = (uint16_t)(startBlock * blockLen);
 
-    res = ndefT5TPollerReadSingleBlock(startBlock, subCtx.t5t.txrxBuf, blockLen + 3U, &nbRead);
-    if ((res == ST_ERR_NONE) && (subCtx.t5t.txrxBuf[0U] == 0U) && (nbRead > 0U)) {
-      nbRead = (uint16_t)(nbRead  + startAddr - (uint16_t)offset - 1U);
-      if ((uint32_t) nbRead > currentLen) {
-        nbRead = (uint16_t) currentLen;
-      }
-      if (nbRead > 0U) {
-        (void)ST_MEMCPY(buf, &subCtx.t5t.txrxBuf[1U - startAddr + (uint16_t)offset], (uint32_t)nbRead);
-      }
+    /* First block served from the block cache */
+    nbRead = (uint16_t)(startAddr + blockLen - offset);
+    if ((uint32_t) nbRead > currentLen) {
+      nbRead = (uint16_t) currentLen;
+    }
+    res = ndefBlockCacheRead(offset, nbRead, buf);
+    if (res == ST_ERR_NONE) {
       lvRcvLen   += (uint32_t) nbRead;
       currentLen -= (uint32_t) nbRead;
-      while (currentLen >= ((uint32_t)blockLen + 2U)) {
+      while ((res == ST_ERR_NONE) && (currentLen >= ((uint32_t)blockLen + 2U))) {
         startBlock++;
         lastVal = buf[lvRcvLen - 1U];
         res = ndefT5TPollerReadSingleBlock(startBlock, &buf[lvRcvLen - 1U], blockLen + 3U, &nbRead);
@@ -155,21 +183,12 @@ ReturnCode NdefClass::ndefT5TPollerReadBytes(uint32_t offset, uint32_t len, uint
           break;
         }
       }
-      while (currentLen > 0U) {
-        startBlock++;
-        res = ndefT5TPollerReadSingleBlock(startBlock, subCtx.t5t.txrxBuf, blockLen + 3U, &nbRead);
-        if ((res == ST_ERR_NONE) && (subCtx.t5t.txrxBuf[0U] == 0U) && (nbRead > 0U)) {
-          -- nbRead; /* remove status char */
-          if (nbRead > currentLen) {
-            nbRead = (uint16_t)currentLen;
-          }
-          if (nbRead > 0U) {
-            (void)ST_MEMCPY(&buf[lvRcvLen], & subCtx.t5t.txrxBuf[1U], nbRead);
-          }
-          lvRcvLen   += nbRead;
-          currentLen -= nbRead;
-        } else {
-          break;
+      if ((res == ST_ERR_NONE) && (currentLen > 0U)) {
+        /* Last block(s) served from the block cache */
+        res = ndefBlockCacheRead(offset + lvRcvLen, currentLen, &buf[lvRcvLen]);
+        if (res == ST_ERR_NONE) {
+          lvRcvLen   += currentLen;
+          currentLen  = 0U;
         }
       }
     }
@@ -178,17 +197,55 @@ ReturnCode NdefClass::ndefT5TPollerReadBytes(uint32_t offset, uint32_t len, uint
     result = ST_ERR_NONE;
   }
   if (rcvdLen != NULL) {
-    * rcvdLen = lvRcvLen;
+    * rcvdLen = cachedLen + lvRcvLen;
   }
   return result;
 }
 
 /*******************************************************************************/
-ReturnCode NdefClass::ndefT5TPollerContextInitialization(rfalNfcDevice *dev)
+ReturnCode NdefClass::ndefT5TPollerReadAhead(void)
 {
-  ReturnCode    result;
-  uint16_t      rcvLen;
+  ReturnCode result;
+  uint16_t   rcvLen;
+  uint32_t   nbBlocks;
+
+  subCtx.t5t.readAheadLen = 0U;
 
+  if (subCtx.t5t.blockLen == 0U) {
+    return ST_ERR_SYSTEM;
+  }
+
+  /* Known tag without Read Multiple Blocks support (CC MBREAD bit cleared): don't even try */
+  if ((tagCacheEntry != NULL) && (tagCacheEntry->ccLen >= NDEF_T5T_CC_LEN_4_BYTES) && ((tagCacheEntry->cc[3U] & 0x01U) == 0U)) {
+    return ST_ERR_NOTSUPP;
+  }
+
+  nbBlocks = NDEF_T5T_READ_AHEAD_LEN / subCtx.t5t.blockLen;
+  if ((subCtx.t5t.sysInfoSupported == true) && (ndefT5TSysInfoMemSizePresent(subCtx.t5t.sysInfo.infoFlags) != 0U) &&
+      (nbBlocks > subCtx.t5t.sysInfo.numberOfBlock)) {
+    nbBlocks = subCtx.t5t.sysInfo.numberOfBlock;
+  }
+  if (nbBlocks == 0U) {
+    return ST_ERR_NOMEM;
+  }
+
+  /* Number of blocks is encoded minus one */
+  result = ndefT5TPollerReadMultipleBlocks(0U, (uint8_t)(nbBlocks - 1U), subCtx.t5t.readAhead, (uint16_t)sizeof(subCtx.t5t.readAhead), &rcvLen);
+  if ((result != ST_ERR_NONE) || (rcvLen <= NDEF_T5T_TxRx_BUFF_HEADER_SIZE) || (subCtx.t5t.readAhead[0U] != 0U)) {
+    return (result != ST_ERR_NONE) ? result : ST_ERR_PROTO;
+  }
+
+  subCtx.t5t.readAheadLen = (uint16_t)(rcvLen - NDEF_T5T_TxRx_BUFF_HEADER_SIZE);
+  if (subCtx.t5t.readAheadLen > (nbBlocks * subCtx.t5t.blockLen)) {
+    subCtx.t5t.readAheadLen = (uint16_t)(nbBlocks * subCtx.t5t.blockLen);
+  }
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT5TPollerContextInitialization(rfalNfcDevice *dev)
+{
   if ((dev == NULL) || !ndefT5TisT5TDevice(dev)) {
     return ST_ERR_PARAM;
   }
@@ -204,6 +261,39 @@ ReturnCode NdefClass::ndefT5TPollerContextInitialization(rfalNfcDevice *dev)
   subCtx.t5t.TlvNDEFOffset = 0U; /* Offset for TLV */
 
   subCtx.t5t.legacySTHighDensity = false;
+  subCtx.t5t.sysInfoSupported = false;
+  subCtx.t5t.readAheadLen = 0U;
+  ndefBlockCacheInvalidate();
+
+  if (tagCacheEntry != NULL) {
+    /* Known tag: restore its geometry instead of probing it, the CC read during detection validates it */
+    subCtx.t5t.blockLen            = tagCacheEntry->blockLen;
+    subCtx.t5t.legacySTHighDensity = ((tagCacheEntry->flags & NDEF_CACHE_FLAG_LEGACY_HD) != 0U);
+    subCtx.t5t.sysInfoSupported    = ((tagCacheEntry->flags & NDEF_CACHE_FLAG_SYSINFO) != 0U);
+    (void)ST_MEMCPY(&subCtx.t5t.sysInfo, &tagCacheEntry->sysInfo, sizeof(ndefSystemInformation));
+
+    if (rfal_nfc->rfalNfcvPollerSelect((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT, device.dev.nfcv.InvRes.UID)  == ST_ERR_NONE) {
+      subCtx.t5t.pAddressedUid = NULL; /* Switch to selected mode */
+    }
+    return ST_ERR_NONE;
+  }
+
+  return ndefT5TPollerProbe();
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT5TPollerProbe(void)
+{
+  ReturnCode    result;
+  uint16_t      rcvLen;
+
+  /* Probe the geometry from scratch, in addressed mode */
+  subCtx.t5t.blockLen            = 0U;
+  subCtx.t5t.pAddressedUid       = device.dev.nfcv.InvRes.UID;
+  subCtx.t5t.legacySTHighDensity = false;
+  subCtx.t5t.sysInfoSupported    = false;
+  subCtx.t5t.readAheadLen        = 0U;
+
   result = ndefT5TPollerReadSingleBlock(0U, subCtx.t5t.txrxBuf, (uint16_t)sizeof(subCtx.t5t.txrxBuf), &rcvLen);
   if ((result != ST_ERR_NONE) && (device.dev.nfcv.InvRes.UID[NDEF_T5T_UID_MANUFACTURER_ID_POS] == NDEF_T5T_MANUFACTURER_ID_ST)) {
     /* Try High Density Legacy mode */
@@ -224,8 +314,6 @@ ReturnCode NdefClass::ndefT5TPollerContextInitialization(rfalNfcDevice *dev)
     subCtx.t5t.pAddressedUid = NULL; /* Switch to selected mode */
   }
 
-  subCtx.t5t.sysInfoSupported = false;
-
   if (!subCtx.t5t.legacySTHighDensity) {
     /* Extended Get System Info */
     if (ndefT5TGetSystemInformation(true) == ST_ERR_NONE) {
@@ -251,6 +339,7 @@ ReturnCode NdefClass::ndefT5TPollerNdefDetect(ndefInfo *info)
   uint16_t   length;
   uint32_t   TlvOffset;
   bool       bExit;
+  bool       bCached;
   uint32_t   rcvLen;
 
   if (!ndefT5TisT5TDevice(&device)) {
@@ -272,7 +361,20 @@ ReturnCode NdefClass::ndefT5TPollerNdefDetect(ndefInfo *info)
     info->messageLen           = 0U;
   }
 
+  /* One Read Multiple Blocks covering the CC, the first TLVs and a small message, reused by the reads below */
+  (void)ndefT5TPollerReadAhead();
+
   result = ndefT5TPollerReadBytes(0U, 8U, ccBuf, &rcvLen);
+  if ((tagCacheEntry != NULL) && ((result != ST_ERR_NONE) || !ndefCacheIsValid(rcvLen))) {
+    /* CC differs from the cached one: the restored geometry cannot be trusted, forget it and probe the tag */
+    ndefCacheDrop();
+    ndefBlockCacheInvalidate();
+    result = ndefT5TPollerProbe();
+    if (result == ST_ERR_NONE) {
+      (void)ndefT5TPollerReadAhead();
+      result = ndefT5TPollerReadBytes(0U, 8U, ccBuf, &rcvLen);
+    }
+  }
   if ((result == ST_ERR_NONE) && (rcvLen == 8U) && ((ccBuf[0] == (uint8_t)0xE1U) || (ccBuf[0] == (uint8_t)0xE2U))) {
     cc.t5t.magicNumber           =  ccBuf[0U];
     cc.t5t.majorVersion          = (ccBuf[1U] >> 6U) & 0x03U;
@@ -306,9 +408,20 @@ ReturnCode NdefClass::ndefT5TPollerNdefDetect(ndefInfo *info)
     messageLen     = 0U;
     messageOffset  = cc.t5t.ccLen;
     TlvOffset = cc.t5t.ccLen;
+    bCached   = ndefCacheIsValid(rcvLen);
+    if (bCached) {
+      /* Known tag with unchanged CC: go straight to the NDEF message TLV */
+      TlvOffset = tagCacheEntry->tlvOffset;
+    }
     bExit     = false;
     do {
       result = ndefT5TPollerReadBytes(TlvOffset, NDEF_T5T_TL_MAX_SIZE, tmpBuf, &rcvLen);
+      if (bCached && ((result != ST_ERR_NONE) || (rcvLen != NDEF_T5T_TL_MAX_SIZE) || (tmpBuf[0U] != (uint8_t)NDEF_T5T_TLV_NDEF))) {
+        /* Cached NDEF TLV offset no longer valid: walk the TLVs from the beginning */
+        bCached   = false;
+        TlvOffset = cc.t5t.ccLen;
+        continue;
+      }
       if ((result != ST_ERR_NONE) || (rcvLen != NDEF_T5T_TL_MAX_SIZE)) {
         break;
       }
@@ -319,6 +432,13 @@ ReturnCode NdefClass::ndefT5TPollerNdefDetect(ndefInfo *info)
         length = (((uint16_t)tmpBuf[2U]) << 8U) + (uint16_t)tmpBuf[3U];
         offset += 2U;
       }
+      if (bCached && ((TlvOffset + offset + length) > ((uint32_t)cc.t5t.ccLen + ((uint32_t)cc.t5t.memoryLen * NDEF_T5T_MLEN_DIVIDER)))) {
+        /* Cached NDEF TLV does not fit the area any more, e.g. tag reformatted with another TLV layout */
+        bCached   = false;
+        TlvOffset = cc.t5t.ccLen;
+        continue;
+      }
+      bCached = false;
       if (tmpBuf[0U] == (uint8_t)NDEF_T5T_TLV_NDEF) {
         /* NDEF record return it */
         returnCode                    = ST_ERR_NONE;  /* Default */
@@ -376,6 +496,9 @@ ReturnCode NdefClass::ndefT5TPollerNdefDetect(ndefInfo *info)
     info->areaAvalableSpaceLen = (uint32_t)cc.t5t.ccLen + areaLen - messageOffset;
     info->messageLen           = messageLen;
   }
+  if (returnCode == ST_ERR_NONE) {
+    ndefCacheStore();
+  }
   return returnCode;
 }
 
@@ -399,89 +522,12 @@ ReturnCode NdefClass::ndefT5TPollerReadRawMessage(uint8_t *buf, uint32_t bufLen,
 /*******************************************************************************/
 ReturnCode NdefClass::ndefT5TPollerWriteBytes(uint32_t offset, const uint8_t *buf, uint32_t len)
 {
-  ReturnCode      result = ST_ERR_REQUEST;
-  ReturnCode      res;
-  uint16_t        nbRead;
-  uint16_t        blockLen16;
-  uint16_t        startBlock;
-  uint16_t        startAddr ;
-  const uint8_t *wrbuf      = buf;
-  uint32_t        currentLen = len;
-
-  if (!ndefT5TisT5TDevice(&device) || (len == 0U) || (subCtx.t5t.blockLen == 0U)) {
+  if (!ndefT5TisT5TDevice(&device) || (buf == NULL) || (len == 0U) || (subCtx.t5t.blockLen == 0U)) {
     return ST_ERR_PARAM;
   }
-  blockLen16 = (uint16_t)subCtx.t5t.blockLen;
-  if (blockLen16 == 0U) {
-    return ST_ERR_SYSTEM;
-  }
-  startBlock = (uint16_t)(offset     / blockLen16);
-  startAddr  = (uint16_t)(startBlock * blockLen16);
 
-  if (startAddr != offset) {
-    /* Unaligned start offset must read the first block before */
-    res = ndefT5TPollerReadSingleBlock(startBlock, subCtx.t5t.txrxBuf, blockLen16 + 3U, &nbRead);
-    if ((res == ST_ERR_NONE) && (subCtx.t5t.txrxBuf[0U] == 0U) && (nbRead > 0U)) {
-      nbRead = (uint16_t)((uint32_t)nbRead - 1U  + startAddr - offset);
-      if (nbRead > (uint32_t) currentLen) {
-        nbRead = (uint16_t) currentLen;
-      }
-      if (nbRead > 0U) {
-        (void)ST_MEMCPY(&subCtx.t5t.txrxBuf[1U - startAddr + (uint16_t)offset], wrbuf, nbRead);
-      }
-      res = ndefT5TPollerWriteSingleBlock(startBlock, &subCtx.t5t.txrxBuf[1U]);
-      if (res != ST_ERR_NONE) {
-        return res;
-      }
-    } else {
-      if (res != ST_ERR_NONE) {
-        result = res;
-      } else {
-        result = ST_ERR_PARAM;
-      }
-      return result;
-    }
-    currentLen -= nbRead;
-    wrbuf       = &wrbuf[nbRead];
-    startBlock++;
-  }
-  while (currentLen >= blockLen16) {
-    res = ndefT5TPollerWriteSingleBlock(startBlock, wrbuf);
-    if (res == ST_ERR_NONE) {
-      currentLen -= blockLen16;
-      wrbuf       = &wrbuf[blockLen16];
-      startBlock++;
-    } else {
-      result = res;
-      break;
-    }
-  }
-  if ((currentLen != 0U) && (currentLen < blockLen16)) {
-    /* Unaligned end, must read the first block before */
-    res = ndefT5TPollerReadSingleBlock(startBlock, subCtx.t5t.txrxBuf, blockLen16 + 3U, &nbRead);
-    if ((res == ST_ERR_NONE) && (subCtx.t5t.txrxBuf[0U] == 0U) && (nbRead > 0U)) {
-      if (currentLen > 0U) {
-        (void)ST_MEMCPY(&subCtx.t5t.txrxBuf[1U], wrbuf, currentLen);
-      }
-      res = ndefT5TPollerWriteSingleBlock(startBlock, &subCtx.t5t.txrxBuf[1U]);
-      if (res != ST_ERR_NONE) {
-        result = res;
-      } else {
-        currentLen = 0U;
-      }
-    } else {
-      if (res != ST_ERR_NONE) {
-        result = res;
-      } else {
-        result = ST_ERR_PARAM;
-      }
-      return result;
-    }
-  }
-  if (currentLen == 0U) {
-    result = ST_ERR_NONE;
-  }
-  return result;
+  /* Blocks are written back by ndefBlockCacheFlush(); partial blocks are merged in RAM */
+  return ndefBlockCacheWrite(offset, buf, len);
 }
 
 /*******************************************************************************/
@@ -511,7 +557,11 @@ ReturnCode NdefClass::ndefT5TPollerWriteRawMessageLen(uint32_t rawMessageLen)
         len++;
       }
 
-      result = ndefT5TPollerWriteBytes(subCtx.t5t.TlvNDEFOffset, TLV, len);
+      /* The message data reaches the tag before the L-field that validates it */
+      result = ndefBlockCacheFlush();
+      if (result == ST_ERR_NONE) {
+        result = ndefT5TPollerWriteBytes(subCtx.t5t.TlvNDEFOffset, TLV, len);
+      }
       if ((result == ST_ERR_NONE) && (rawMessageLen != 0U)) {
         /* T5T need specific terminator */
         len = 0U;
@@ -519,6 +569,9 @@ ReturnCode NdefClass::ndefT5TPollerWriteRawMessageLen(uint32_t rawMessageLen)
         len++;
         result = ndefT5TPollerWriteBytes(messageOffset + rawMessageLen, TLV, len);
       }
+      if (result == ST_ERR_NONE) {
+        result = ndefBlockCacheFlush();
+      }
     }
   }
   return result;
@@ -577,17 +630,10 @@ ReturnCode NdefClass::ndefT5TPollerWriteRawMessage(const uint8_t *buf, uint32_t
 }
 
 /*******************************************************************************/
-ReturnCode NdefClass::ndefT5TWriteCC()
+uint8_t NdefClass::ndefT5TEncodeCC(uint8_t *buf)
 {
-  ReturnCode  ret;
-  uint8_t    *buf;
   uint8_t     dataIt;
 
-  if (!ndefT5TisT5TDevice(&device)) {
-    return ST_ERR_PARAM;
-  }
-
-  buf    = ccBuf;
   dataIt = 0U;
   /* Encode CC */
   buf[dataIt] = cc.t5t.magicNumber;                                                                /* Byte 0 */
@@ -624,7 +670,25 @@ ReturnCode NdefClass::ndefT5TWriteCC()
     dataIt++;
   }
 
-  ret = ndefT5TPollerWriteBytes(0U, buf, cc.t5t.ccLen);
+  return dataIt;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT5TWriteCC()
+{
+  ReturnCode  ret;
+
+  if (!ndefT5TisT5TDevice(&device)) {
+    return ST_ERR_PARAM;
+  }
+
+  (void)ndefT5TEncodeCC(ccBuf);
+
+  ret = ndefT5TPollerWriteBytes(0U, ccBuf, cc.t5t.ccLen);
+  if (ret == ST_ERR_NONE) {
+    /* Written through: the caller retries with special frames on failure */
+    ret = ndefBlockCacheFlush();
+  }
   return ret;
 }
 
@@ -696,7 +760,7 @@ ReturnCode NdefClass::ndefT5TPollerTagFormat(const ndefCapabilityContainer *cc_p
   if (result != ST_ERR_NONE) {
     /* If write fails, try to use special frame if not yet used */
     if (!cc.t5t.specialFrame) {
-      delay(20U); /* Wait to be sure that previous command has ended */
+      rfal_nfc->rfalNfcDelayMs(20U); /* Wait to be sure that previous command has ended */
       cc.t5t.specialFrame = true; /* Add option flag */
       result = ndefT5TWriteCC();
       if (result != ST_ERR_NONE) {
@@ -712,6 +776,9 @@ ReturnCode NdefClass::ndefT5TPollerTagFormat(const ndefCapabilityContainer *cc_p
   subCtx.t5t.TlvNDEFOffset = cc.t5t.ccLen;
 
   result = ndefT5TPollerWriteBytes(subCtx.t5t.TlvNDEFOffset, emptyNDEF, sizeof(emptyNDEF));
+  if (result == ST_ERR_NONE) {
+    result = ndefBlockCacheFlush();
+  }
   if (result == ST_ERR_NONE) {
     /* Update info about current NDEF */
     messageOffset = (uint32_t)cc.t5t.ccLen + 0x02U;
@@ -720,6 +787,134 @@ ReturnCode NdefClass::ndefT5TPollerTagFormat(const ndefCapabilityContainer *cc_p
   return result;
 }
 
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT5TPollerPersonalize(const ndefCapabilityContainer *cc_p, const ndefMessage *message, uint32_t lockOptions, ndefPersonalizeReport *report)
+{
+  ReturnCode           ret;
+  ndefMessageInfo      info;
+  ndefPersonalizePlan  plan;
+  uint8_t              prefix[NDEF_T5T_CC_LEN_8_BYTES + NDEF_T5T_TLV_T_LEN + NDEF_T5T_TLV_L_3_BYTES_LEN];
+  uint32_t             prefixLen;
+  uint32_t             tlvLen;
+  uint32_t             area;
+  uint32_t             runMax;
+  uint16_t             nbBlocks;
+  uint16_t             blockNum;
+  uint8_t              flags;
+  bool                 multiple;
+  uint32_t             startUs;
+  uint32_t             stepUs;
+
+  if (!ndefT5TisT5TDevice(&device)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (((cc_p->t5t.ccLen != NDEF_T5T_CC_LEN_8_BYTES) && (cc_p->t5t.ccLen != NDEF_T5T_CC_LEN_4_BYTES)) || (subCtx.t5t.blockLen == 0U) || (subCtx.t5t.blockLen > NDEF_WRITE_SINK_BUF_LEN)) {
+    return ST_ERR_PARAM;
+  }
+
+  startUs = rfal_nfc->rfalNfcGetTimeUs();
+
+  /*
+   * Plan: everything is checked before the first command, the geometry
+   * and the command set come from the context, nothing is read from the tag
+   */
+  (void)ndefMessageGetInfo(message, &info);
+
+  tlvLen = NDEF_T5T_TLV_T_LEN + ((info.length > NDEF_SHORT_VFIELD_MAX_LEN) ? NDEF_T5T_TLV_L_3_BYTES_LEN : NDEF_T5T_TLV_L_1_BYTES_LEN) + info.length;
+  area   = (uint32_t)cc_p->t5t.memoryLen * NDEF_T5T_MLEN_DIVIDER;
+  if (tlvLen > area) {
+    return ST_ERR_NOMEM;
+  }
+
+  nbBlocks = (uint16_t)(((uint32_t)cc_p->t5t.ccLen + area + subCtx.t5t.blockLen - 1U) / subCtx.t5t.blockLen);
+  if (subCtx.t5t.sysInfoSupported && (nbBlocks > subCtx.t5t.sysInfo.numberOfBlock)) {
+    nbBlocks = subCtx.t5t.sysInfo.numberOfBlock;
+  }
+
+  if ((lockOptions & NDEF_PERSONALIZE_LOCK_PERMANENT) != 0U) {
+    if (subCtx.t5t.legacySTHighDensity ||
+        (subCtx.t5t.sysInfoSupported && (ndefT5TSysInfoCmdListPresent(subCtx.t5t.sysInfo.infoFlags) != 0U) &&
+         (ndefT5TSysInfoLockSingleBlockSupported(subCtx.t5t.sysInfo.supportedCmd) == 0U))) {
+      return ST_ERR_NOTSUPP;
+    }
+  }
+
+  /* Write Multiple Blocks only when the command list advertises it for the whole area */
+  multiple = !cc_p->t5t.specialFrame && !subCtx.t5t.legacySTHighDensity && subCtx.t5t.sysInfoSupported &&
+             (ndefT5TSysInfoCmdListPresent(subCtx.t5t.sysInfo.infoFlags) != 0U) &&
+             (ndefT5TSysInfoWriteMultipleBlocksSupported(subCtx.t5t.sysInfo.supportedCmd) != 0U) &&
+             ((nbBlocks <= NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR) || (ndefT5TSysInfoExtWriteMultipleBlocksSupported(subCtx.t5t.sysInfo.supportedCmd) != 0U));
+  runMax   = multiple ? MIN((NDEF_PERSONALIZE_RUN_MAX_BLOCKS * (uint32_t)subCtx.t5t.blockLen), NDEF_PERSONALIZE_RUN_MAX_LEN) : subCtx.t5t.blockLen;
+
+  (void)ST_MEMCPY(&cc, cc_p, sizeof(ndefCapabilityContainer));
+  if (lockOptions != NDEF_PERSONALIZE_LOCK_NONE) {
+    cc.t5t.writeAccess = NDEF_T5T_ACCESS_NEVER;
+  }
+
+  prefixLen = ndefT5TEncodeCC(prefix);
+  prefix[prefixLen++] = NDEF_T5T_TLV_NDEF;
+  if (info.length > NDEF_SHORT_VFIELD_MAX_LEN) {
+    prefix[prefixLen++] = 0xFFU;
+    prefix[prefixLen++] = (uint8_t)(info.length >> 8U);
+  }
+  prefix[prefixLen++] = (uint8_t)info.length;
+
+  /* Blocks in ascending order with the widest write, the TLV head block (possibly with the CC) last */
+  ndefPollerPersonalizeInit(&plan, subCtx.t5t.blockLen, runMax, cc.t5t.ccLen);
+  ndefPollerDropReadCache();
+
+  stepUs         = rfal_nfc->rfalNfcGetTimeUs();
+  report->planUs = stepUs - startUs;
+
+  /*
+   * Write
+   */
+  ret = ndefPollerPersonalizeStream(&plan, 0U, prefix, prefixLen, message, (tlvLen < area));
+
+  report->writeCmds    = plan.writeCmds;
+  report->bytesWritten = plan.bytesWritten;
+  report->writeUs      = rfal_nfc->rfalNfcGetTimeUs() - stepUs;
+  stepUs               = rfal_nfc->rfalNfcGetTimeUs();
+
+  /*
+   * Lock: NFC Forum read-only transition locks every block of the T5T area
+   */
+  if ((ret == ST_ERR_NONE) && ((lockOptions & NDEF_PERSONALIZE_LOCK_PERMANENT) != 0U)) {
+    flags = cc.t5t.specialFrame ? ((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT | (uint8_t)RFAL_NFCV_REQ_FLAG_OPTION) : (uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT;
+
+    for (blockNum = 0U; (blockNum < nbBlocks) && (ret == ST_ERR_NONE); blockNum++) {
+      if (blockNum < NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR) {
+        ret = rfal_nfc->rfalNfcvPollerLockBlock(flags, subCtx.t5t.pAddressedUid, (uint8_t)blockNum);
+      } else {
+        ret = rfal_nfc->rfalNfcvPollerExtendedLockSingleBlock(flags, subCtx.t5t.pAddressedUid, blockNum);
+      }
+      report->lockCmds++;
+    }
+  }
+  report->lockUs = rfal_nfc->rfalNfcGetTimeUs() - stepUs;
+
+  ndefPollerDropReadCache();
+
+  if (ret == ST_ERR_NONE) {
+    /* Update info about current NDEF */
+    areaLen                  = area;
+    subCtx.t5t.TlvNDEFOffset = cc.t5t.ccLen;
+    messageOffset            = (uint32_t)cc.t5t.ccLen + (tlvLen - info.length);
+    messageLen               = info.length;
+    if (cc.t5t.writeAccess != 0U) {
+      state = NDEF_STATE_READONLY;
+    } else {
+      state = (messageLen == 0U) ? NDEF_STATE_INITIALIZED : NDEF_STATE_READWRITE;
+    }
+  } else {
+    state = NDEF_STATE_INVALID;
+  }
+
+  report->totalUs = rfal_nfc->rfalNfcGetTimeUs() - startUs;
+  return ret;
+}
+
 /*******************************************************************************/
 ReturnCode NdefClass::ndefT5TPollerCheckPresence()
 {
@@ -837,6 +1032,51 @@ ReturnCode NdefClass::ndefT5TPollerWriteSingleBlock(uint16_t blockNum, const uin
     }
   }
 
+  /* Keep the read-ahead in line with the tag */
+  if (((uint32_t)blockNum * subCtx.t5t.blockLen) < subCtx.t5t.readAheadLen) {
+    if ((ret == ST_ERR_NONE) && ((((uint32_t)blockNum + 1U) * subCtx.t5t.blockLen) <= subCtx.t5t.readAheadLen)) {
+      (void)ST_MEMCPY(&subCtx.t5t.readAhead[NDEF_T5T_TxRx_BUFF_HEADER_SIZE + ((uint32_t)blockNum * subCtx.t5t.blockLen)], wrData, subCtx.t5t.blockLen);
+    } else {
+      subCtx.t5t.readAheadLen = 0U;
+    }
+  }
+  ndefBlockCacheUpdate(blockNum, 1U, wrData, (ret == ST_ERR_NONE));
+
+  return ret;
+}
+
+/*******************************************************************************/
+ReturnCode NdefClass::ndefT5TPollerWriteMultipleBlocks(uint16_t firstBlockNum, uint8_t numOfBlocks, const uint8_t *wrData)
+{
+  ReturnCode                ret;
+  uint16_t                  wrDataLen;
+  uint8_t                   txBuf[NDEF_T5T_WR_MUL_REQ_HEADER_LEN + RFAL_NFCV_UID_LEN + NDEF_PERSONALIZE_RUN_MAX_LEN];
+
+  if (!ndefT5TisT5TDevice(&device)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (numOfBlocks == 1U) {
+    return ndefT5TPollerWriteSingleBlock(firstBlockNum, wrData);
+  }
+
+  wrDataLen = (uint16_t)((uint16_t)numOfBlocks * subCtx.t5t.blockLen);
+  if ((numOfBlocks == 0U) || (wrDataLen > NDEF_PERSONALIZE_RUN_MAX_LEN)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (((uint32_t)firstBlockNum + numOfBlocks) <= NDEF_T5T_MAX_BLOCK_1_BYTE_ADDR) {
+    ret = rfal_nfc->rfalNfcvPollerWriteMultipleBlocks((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT, subCtx.t5t.pAddressedUid, (uint8_t)firstBlockNum, numOfBlocks, txBuf, (uint16_t)sizeof(txBuf), subCtx.t5t.blockLen, wrData, wrDataLen);
+  } else {
+    ret = rfal_nfc->rfalNfcvPollerExtendedWriteMultipleBlocks((uint8_t)RFAL_NFCV_REQ_FLAG_DEFAULT, subCtx.t5t.pAddressedUid, firstBlockNum, numOfBlocks, txBuf, (uint16_t)sizeof(txBuf), subCtx.t5t.blockLen, wrData, wrDataLen);
+  }
+
+  /* Keep the read-ahead and the block cache in line with the tag */
+  if (((uint32_t)firstBlockNum * subCtx.t5t.blockLen) < subCtx.t5t.readAheadLen) {
+    subCtx.t5t.readAheadLen = 0U;
+  }
+  ndefBlockCacheUpdate(firstBlockNum, numOfBlocks, wrData, (ret == ST_ERR_NONE));
+
   return ret;
 }
 
@@ -962,3 +1202,5 @@ ReturnCode NdefClass::ndefT5TGetSystemInformation(bool extended)
   }
   return ST_ERR_NONE;
 }
+
+#endif /* NDEF_FEATURE_T5T */
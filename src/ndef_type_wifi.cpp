@@ -74,21 +74,17 @@ const ndefConstBuffer8 bufMediaTypeWifi      = { ndefMediaTypeWifi,      sizeof(
 #define WIFI_SSID_TYPE_LENGTH                    2U    /*!< SSID type length           */
 #define WIFI_SSID_KEY_TYPE_LENGTH                2U    /*!< SSID key type length       */
 
-#define NDEF_WIFI_ATTRIBUTE_ID_SSID_LSB       0x10U    /*!< SSID Attribute ID LSB      */
-#define NDEF_WIFI_ATTRIBUTE_ID_SSID_MSB       0x45U    /*!< SSID Attribute ID MSB      */
+#define NDEF_WIFI_ATTRIBUTE_AUTHENTICATION  0x1003U    /*!< Authentication Type attribute */
+#define NDEF_WIFI_ATTRIBUTE_CREDENTIAL      0x100EU    /*!< Credential attribute          */
+#define NDEF_WIFI_ATTRIBUTE_ENCRYPTION      0x100FU    /*!< Encryption Type attribute     */
+#define NDEF_WIFI_ATTRIBUTE_MAC_ADDRESS     0x1020U    /*!< MAC Address attribute         */
+#define NDEF_WIFI_ATTRIBUTE_NETWORK_INDEX   0x1026U    /*!< Network Index attribute       */
+#define NDEF_WIFI_ATTRIBUTE_NETWORK_KEY     0x1027U    /*!< Network Key attribute         */
+#define NDEF_WIFI_ATTRIBUTE_SSID            0x1045U    /*!< SSID attribute                */
+#define NDEF_WIFI_ATTRIBUTE_VENDOR_EXT      0x1049U    /*!< Vendor Extension attribute    */
 
-#define NDEF_WIFI_ATTRIBUTE_ID_NETWORK_LSB    0x10U    /*!< Network Attribute ID LSB   */
-#define NDEF_WIFI_ATTRIBUTE_ID_NETWORK_MSB    0x27U    /*!< Network Attribute ID MSB   */
-
-#define NDEF_WIFI_ATTRIBUTE_ENCRYPTION        0x0FU    /*!< Encryption attribute       */
-#define NDEF_WIFI_ATTRIBUTE_AUTHENTICATION    0x03U    /*!< Authentication attribute   */
-
-#define NDEF_WIFI_ATTRIBUTE_ID_OFFSET                 0x01U    /*!< Attribute Id offset */
-#define NDEF_WIFI_ATTRIBUTE_LENGTH_MSB_OFFSET         0x02U    /*!< Attribute length MSB offset     */
-#define NDEF_WIFI_ATTRIBUTE_LENGTH_LSB_OFFSET         0x03U    /*!< Attribute length LSB offset     */
-#define NDEF_WIFI_ATTRIBUTE_DATA_OFFSET               0x04U    /*!< Attribute data offset           */
-#define NDEF_WIFI_ATTRIBUTE_ENCRYPTION_LSB_OFFSET     0x05U    /*!< Attribute encryption offset     */
-#define NDEF_WIFI_ATTRIBUTE_AUTHENTICATION_LSB_OFFSET 0x05U    /*!< Attribute authentication offset */
+#define NDEF_WIFI_ATTRIBUTE_HEADER_LEN         4U    /*!< Attribute Id (2 bytes) + Length (2 bytes) */
+#define NDEF_WIFI_NETWORK_INDEX_LENGTH         1U    /*!< Network Index length       */
 
 
 static uint8_t wifiConfigToken1[] = {
@@ -147,6 +143,7 @@ extern "C" {
 #endif
 static uint32_t ndefWifiPayloadGetLength(const ndefType *wifi);
 static const uint8_t *ndefWifiToPayloadItem(const ndefType *wifi, ndefConstBuffer *bufItem, bool begin);
+static uint32_t ndefWifiEncodeInto(const ndefType *wifi, uint8_t *buffer);
 #ifdef __cplusplus
 }
 #endif
@@ -328,6 +325,63 @@ static const uint8_t *ndefWifiToPayloadItem(const ndefType *wifi, ndefConstBuffe
 
   return bufItem->buffer;
 }
+
+
+/*****************************************************************************/
+static uint32_t ndefWifiEncodeInto(const ndefType *wifi, uint8_t *buffer)
+{
+  const ndefTypeWifi *wifiData;
+  uint32_t offset;
+  uint16_t credentialLength;
+
+  const uint8_t CONFIG_TOKEN_1_CREDENTIAL_LENGTH_INDEX   =  7U;
+  const uint8_t CONFIG_TOKEN_3_AUTHENTICATION_TYPE_INDEX =  5U;
+  const uint8_t CONFIG_TOKEN_3_ENCRYPTION_TYPE_INDEX     = 11U;
+
+  if ((wifi == NULL) || (wifi->id != NDEF_TYPE_MEDIA_WIFI) || (buffer == NULL)) {
+    return 0;
+  }
+
+  wifiData = &wifi->data.wifi;
+
+  /* The default network key substituted for an empty one is left to the payload items */
+  if (wifiData->bufNetworkKey.length == 0U) {
+    return 0;
+  }
+
+  credentialLength = (uint16_t)(5U + 2U + 2U + wifiData->bufNetworkSSID.length +
+                                sizeof(wifiConfigToken3) +
+                                2U + wifiData->bufNetworkKey.length +
+                                sizeof(wifiConfigToken5));
+
+  /* Config Token1, then SSID */
+  (void)ST_MEMCPY(buffer, wifiConfigToken1, sizeof(wifiConfigToken1));
+  buffer[CONFIG_TOKEN_1_CREDENTIAL_LENGTH_INDEX]      = (uint8_t)(credentialLength >>    8U);
+  buffer[CONFIG_TOKEN_1_CREDENTIAL_LENGTH_INDEX + 1U] = (uint8_t)(credentialLength  & 0xFFU);
+  offset = sizeof(wifiConfigToken1);
+  buffer[offset]      = 0U;
+  buffer[offset + 1U] = (uint8_t)wifiData->bufNetworkSSID.length;
+  offset += WIFI_SSID_TYPE_LENGTH;
+  (void)ST_MEMCPY(&buffer[offset], wifiData->bufNetworkSSID.buffer, wifiData->bufNetworkSSID.length);
+  offset += wifiData->bufNetworkSSID.length;
+
+  /* Config Token3, then Network Key */
+  (void)ST_MEMCPY(&buffer[offset], wifiConfigToken3, sizeof(wifiConfigToken3));
+  buffer[offset + CONFIG_TOKEN_3_AUTHENTICATION_TYPE_INDEX] = wifiData->authentication;
+  buffer[offset + CONFIG_TOKEN_3_ENCRYPTION_TYPE_INDEX]     = wifiData->encryption;
+  offset += sizeof(wifiConfigToken3);
+  buffer[offset]      = 0U;
+  buffer[offset + 1U] = (uint8_t)wifiData->bufNetworkKey.length;
+  offset += WIFI_SSID_KEY_TYPE_LENGTH;
+  (void)ST_MEMCPY(&buffer[offset], wifiData->bufNetworkKey.buffer, wifiData->bufNetworkKey.length);
+  offset += wifiData->bufNetworkKey.length;
+
+  /* Config Token5 */
+  (void)ST_MEMCPY(&buffer[offset], wifiConfigToken5, sizeof(wifiConfigToken5));
+  offset += sizeof(wifiConfigToken5);
+
+  return offset;
+}
 #ifdef __cplusplus
 }
 #endif
@@ -344,6 +398,7 @@ ReturnCode NdefClass::ndefWifi(ndefType *wifi, const ndefTypeWifi *wifiConfig)
   wifi->id               = NDEF_TYPE_MEDIA_WIFI;
   wifi->getPayloadLength = ndefWifiPayloadGetLength;
   wifi->getPayloadItem   = ndefWifiToPayloadItem;
+  wifi->encodeInto       = ndefWifiEncodeInto;
   wifiData               = &wifi->data.wifi;
 
   wifiData->bufNetworkSSID = wifiConfig->bufNetworkSSID;
@@ -351,6 +406,14 @@ ReturnCode NdefClass::ndefWifi(ndefType *wifi, const ndefTypeWifi *wifiConfig)
   wifiData->authentication = wifiConfig->authentication;
   wifiData->encryption     = wifiConfig->encryption;
 
+  /* Decode only information, not encoded */
+  wifiData->networkIndex              = 1U;
+  wifiData->credentialCount           = 1U;
+  wifiData->bufMacAddress.buffer      = NULL;
+  wifiData->bufMacAddress.length      = 0;
+  wifiData->bufVendorExtension.buffer = NULL;
+  wifiData->bufVendorExtension.length = 0;
+
   return ST_ERR_NONE;
 }
 
@@ -373,6 +436,98 @@ ReturnCode NdefClass::ndefGetWifi(const ndefType *wifi, ndefTypeWifi *wifiConfig
   wifiConfig->bufNetworkKey.length  = wifiData->bufNetworkKey.length;
   wifiConfig->authentication = wifiData->authentication;
   wifiConfig->encryption     = wifiData->encryption;
+  wifiConfig->networkIndex       = wifiData->networkIndex;
+  wifiConfig->credentialCount    = wifiData->credentialCount;
+  wifiConfig->bufMacAddress      = wifiData->bufMacAddress;
+  wifiConfig->bufVendorExtension = wifiData->bufVendorExtension;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefWifiParseAttributes(const ndefConstBuffer *bufAttributes, bool nested, uint32_t index, ndefTypeWifi *wifiConfig)
+{
+  ReturnCode      err;
+  ndefConstBuffer bufValue;
+  uint32_t        offset;
+  uint16_t        attribute;
+
+  /* Step TLV by TLV: Attribute Id (2 bytes), Length (2 bytes), Value */
+  offset = 0;
+  while (offset < bufAttributes->length) {
+    if ((bufAttributes->length - offset) < NDEF_WIFI_ATTRIBUTE_HEADER_LEN) {
+      return ST_ERR_PROTO;
+    }
+    attribute       = (uint16_t)(((uint32_t)bufAttributes->buffer[offset] << 8U) | bufAttributes->buffer[offset + 1U]);
+    bufValue.length = ((uint32_t)bufAttributes->buffer[offset + 2U] << 8U) | bufAttributes->buffer[offset + 3U];
+    offset += NDEF_WIFI_ATTRIBUTE_HEADER_LEN;
+    if (bufValue.length > (bufAttributes->length - offset)) {
+      return ST_ERR_PROTO;
+    }
+    bufValue.buffer = &bufAttributes->buffer[offset];
+    offset += bufValue.length;
+
+    switch (attribute) {
+      case NDEF_WIFI_ATTRIBUTE_CREDENTIAL:
+        if (nested) {
+          return ST_ERR_PROTO;
+        }
+        /* Only the requested Credential is parsed, the others are just counted */
+        if (wifiConfig->credentialCount == index) {
+          err = ndefWifiParseAttributes(&bufValue, true, index, wifiConfig);
+          if (err != ST_ERR_NONE) {
+            return err;
+          }
+        }
+        wifiConfig->credentialCount++;
+        break;
+      case NDEF_WIFI_ATTRIBUTE_SSID:
+        if (bufValue.length > NDEF_WIFI_NETWORK_SSID_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->bufNetworkSSID = bufValue;
+        break;
+      case NDEF_WIFI_ATTRIBUTE_NETWORK_KEY:
+        if (bufValue.length > NDEF_WIFI_NETWORK_KEY_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->bufNetworkKey = bufValue;
+        break;
+      case NDEF_WIFI_ATTRIBUTE_AUTHENTICATION:
+        if (bufValue.length != NDEF_WIFI_AUTHENTICATION_TYPE_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->authentication = bufValue.buffer[1U];
+        break;
+      case NDEF_WIFI_ATTRIBUTE_ENCRYPTION:
+        if (bufValue.length != NDEF_WIFI_ENCRYPTION_TYPE_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->encryption = bufValue.buffer[1U];
+        break;
+      case NDEF_WIFI_ATTRIBUTE_NETWORK_INDEX:
+        if (bufValue.length != NDEF_WIFI_NETWORK_INDEX_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->networkIndex = bufValue.buffer[0U];
+        break;
+      case NDEF_WIFI_ATTRIBUTE_MAC_ADDRESS:
+        if (bufValue.length != NDEF_WIFI_MAC_ADDRESS_LENGTH) {
+          return ST_ERR_PROTO;
+        }
+        wifiConfig->bufMacAddress = bufValue;
+        break;
+      case NDEF_WIFI_ATTRIBUTE_VENDOR_EXT:
+        if (wifiConfig->bufVendorExtension.buffer == NULL) {
+          wifiConfig->bufVendorExtension = bufValue;
+        }
+        break;
+      default:
+        /* e.g. Version: skipped */
+        break;
+    }
+  }
 
   return ST_ERR_NONE;
 }
@@ -380,74 +535,44 @@ ReturnCode NdefClass::ndefGetWifi(const ndefType *wifi, ndefTypeWifi *wifiConfig
 
 /*****************************************************************************/
 ReturnCode NdefClass::ndefPayloadToWifi(const ndefConstBuffer *bufPayload, ndefType *wifi)
+{
+  return ndefPayloadToWifiCredential(bufPayload, 0U, wifi);
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefPayloadToWifiCredential(const ndefConstBuffer *bufPayload, uint32_t index, ndefType *wifi)
 {
   ndefTypeWifi wifiConfig;
-  uint32_t offset;
+  ReturnCode   err;
 
-  if ((bufPayload == NULL) || (wifi == NULL)) {
+  if ((bufPayload == NULL) || ((bufPayload->buffer == NULL) && (bufPayload->length != 0U)) || (wifi == NULL)) {
     return ST_ERR_PARAM;
   }
 
-  wifiConfig.bufNetworkSSID.buffer = NULL;
-  wifiConfig.bufNetworkSSID.length = 0;
-  wifiConfig.bufNetworkKey.buffer  = NULL;
-  wifiConfig.bufNetworkKey.length  = 0;
-  wifiConfig.authentication        = 0;
-  wifiConfig.encryption            = 0;
+  (void)ST_MEMSET(&wifiConfig, 0, sizeof(wifiConfig));
 
-  offset = 0;
-  while (offset < bufPayload->length) {
-    uint8_t attribute = bufPayload->buffer[offset];
-    if (attribute == NDEF_WIFI_ATTRIBUTE_ID_SSID_LSB) {
-      uint8_t data1   = bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_LENGTH_MSB_OFFSET];
-      uint8_t data2   = bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_LENGTH_LSB_OFFSET];
-      uint32_t length = ((uint32_t)data1 << 8U) | data2;
-
-      switch (bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_ID_OFFSET]) {
-        case NDEF_WIFI_ATTRIBUTE_ID_SSID_MSB:
-          /* Network SSID */
-          if (length > NDEF_WIFI_NETWORK_SSID_LENGTH) {
-            return ST_ERR_PROTO;
-          }
-          wifiConfig.bufNetworkSSID.buffer = &bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_DATA_OFFSET];
-          wifiConfig.bufNetworkSSID.length = length;
-          offset += (NDEF_WIFI_ATTRIBUTE_DATA_OFFSET + length);
-          break;
-        case NDEF_WIFI_ATTRIBUTE_ID_NETWORK_MSB:
-          /* Network key */
-          if (length > NDEF_WIFI_NETWORK_KEY_LENGTH) {
-            return ST_ERR_PROTO;
-          }
-          wifiConfig.bufNetworkKey.buffer = &bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_DATA_OFFSET];
-          wifiConfig.bufNetworkKey.length = length;
-          offset += (NDEF_WIFI_ATTRIBUTE_DATA_OFFSET + length);
-          break;
-        case NDEF_WIFI_ATTRIBUTE_AUTHENTICATION:
-          /* Authentication */
-          if (length != NDEF_WIFI_AUTHENTICATION_TYPE_LENGTH) {
-            return ST_ERR_PROTO;
-          }
-          wifiConfig.authentication = bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_AUTHENTICATION_LSB_OFFSET];
-          offset += (NDEF_WIFI_ATTRIBUTE_DATA_OFFSET + length);
-          break;
-        case NDEF_WIFI_ATTRIBUTE_ENCRYPTION:
-          /* Encryption */
-          if (length != NDEF_WIFI_ENCRYPTION_TYPE_LENGTH) {
-            return ST_ERR_PROTO;
-          }
-          wifiConfig.encryption = bufPayload->buffer[offset + NDEF_WIFI_ATTRIBUTE_ENCRYPTION_LSB_OFFSET];
-          offset += (NDEF_WIFI_ATTRIBUTE_DATA_OFFSET + length);
-          break;
-        default:
-          offset++;
-          break;
-      }
-    } else {
-      offset++;
-    }
+  err = ndefWifiParseAttributes(bufPayload, false, index, &wifiConfig);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  if ((index != 0U) && (index >= wifiConfig.credentialCount)) {
+    return ST_ERR_NOTFOUND;
   }
 
-  return ndefWifi(wifi, &wifiConfig);
+  err = ndefWifi(wifi, &wifiConfig);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  /* Decode only information */
+  wifi->data.wifi.networkIndex       = wifiConfig.networkIndex;
+  wifi->data.wifi.credentialCount    = wifiConfig.credentialCount;
+  wifi->data.wifi.bufMacAddress      = wifiConfig.bufMacAddress;
+  wifi->data.wifi.bufVendorExtension = wifiConfig.bufVendorExtension;
+
+  return ST_ERR_NONE;
 }
 
 
@@ -455,6 +580,8 @@ ReturnCode NdefClass::ndefPayloadToWifi(const ndefConstBuffer *bufPayload, ndefT
 ReturnCode NdefClass::ndefRecordToWifi(const ndefRecord *record, ndefType *wifi)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
 
   if ((record == NULL) || (wifi == NULL)) {
     return ST_ERR_PARAM;
@@ -470,7 +597,37 @@ ReturnCode NdefClass::ndefRecordToWifi(const ndefRecord *record, ndefType *wifi)
     return ST_ERR_NONE;
   }
 
-  return ndefPayloadToWifi(&record->bufPayload, wifi);
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  return ndefPayloadToWifi(&bufPayload, wifi);
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordToWifiCredential(const ndefRecord *record, uint32_t index, ndefType *wifi)
+{
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
+
+  if ((record == NULL) || (wifi == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (! ndefRecordTypeMatch(record, NDEF_TNF_MEDIA_TYPE, &bufMediaTypeWifi)) { /* "application/vnd.wfa.wsc" */
+    return ST_ERR_PROTO;
+  }
+
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  return ndefPayloadToWifiCredential(&bufPayload, index, wifi);
 }
 
 
@@ -67,6 +67,9 @@
 #define NDEF_WIFI_ENCRYPTION_AES     4U  /*!< WPS Encryption based on AES  */
 
 
+#define NDEF_WIFI_MAC_ADDRESS_LENGTH 6U  /*!< MAC Address length */
+
+
 /*
  ******************************************************************************
  * GLOBAL TYPES
@@ -76,10 +79,14 @@
 
 /*! Structure to store Network SSID, Authentication Type, Encryption Type and Network Key */
 typedef struct {
-  ndefConstBuffer bufNetworkSSID;   /*!< Network SSID        */
-  ndefConstBuffer bufNetworkKey;    /*!< Network Key         */
-  uint8_t         authentication;   /*!< Authentication type */
-  uint8_t         encryption;       /*!< Encryption          */
+  ndefConstBuffer bufNetworkSSID;     /*!< Network SSID                                   */
+  ndefConstBuffer bufNetworkKey;      /*!< Network Key                                    */
+  uint8_t         authentication;     /*!< Authentication type                            */
+  uint8_t         encryption;         /*!< Encryption                                     */
+  uint8_t         networkIndex;       /*!< Network Index (decode only)                    */
+  uint8_t         credentialCount;    /*!< Number of Credentials in the payload (decode only) */
+  ndefConstBuffer bufMacAddress;      /*!< MAC Address (decode only)                      */
+  ndefConstBuffer bufVendorExtension; /*!< First Vendor Extension (decode only)           */
 } ndefTypeWifi;
 
 
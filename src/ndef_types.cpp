@@ -50,44 +50,103 @@
  */
 
 
-/*! NDEF type table to associate a ndefTypeId and a string */
-typedef struct {
-  ndefTypeId              typeId;        /*!< NDEF Type Id       */
-  uint8_t                 tnf;           /*!< TNF                */
-  const ndefConstBuffer8 *bufTypeString; /*!< Type String buffer */
-} ndefTypeTable;
-
-
 /*
  ******************************************************************************
  * LOCAL VARIABLES
  ******************************************************************************
  */
 
+/*! Empty string */
+static const uint8_t          ndefTypeEmpty[] = "";    /*!< Empty string */
+static const ndefConstBuffer8 bufTypeEmpty    = { ndefTypeEmpty, sizeof(ndefTypeEmpty) - 1U };
+
 
 /*
  ******************************************************************************
- * LOCAL FUNCTION PROTOTYPES
+ * LOCAL FUNCTIONS
  ******************************************************************************
  */
 
 
-/*
- ******************************************************************************
- * GLOBAL FUNCTIONS
- ******************************************************************************
- */
+/*****************************************************************************/
+static uint32_t ndefCustomPayloadGetLength(const ndefType *custom)
+{
+  if (custom == NULL) {
+    return 0;
+  }
+
+  return custom->data.custom.bufPayload.length;
+}
 
 
 /*****************************************************************************/
-ReturnCode NdefClass::ndefTypeStringToTypeId(uint8_t tnf, const ndefConstBuffer8 *bufTypeString, ndefTypeId *typeId)
+static const uint8_t *ndefCustomToPayloadItem(const ndefType *custom, ndefConstBuffer *bufItem, bool begin)
 {
-  /*! Empty string */
-  static const uint8_t    ndefTypeEmpty[] = "";    /*!< Empty string */
-  static ndefConstBuffer8 bufTypeEmpty    = { ndefTypeEmpty, sizeof(ndefTypeEmpty) - 1U };
+  if ((custom == NULL) || (bufItem == NULL)) {
+    return NULL;
+  }
+
+  bufItem->buffer = NULL;
+  bufItem->length = 0;
+
+  if (begin) {
+    bufItem->buffer = custom->data.custom.bufPayload.buffer;
+    bufItem->length = custom->data.custom.bufPayload.length;
+  }
 
-  // TODO Transform the enum (u32) to defines (u8), re-order to u32-u8-u8 to compact buffer !
-  static const ndefTypeTable typeTable[] = {
+  return bufItem->buffer;
+}
+
+
+/*****************************************************************************/
+uint32_t NdefClass::ndefTypeHash(uint8_t tnf, const ndefConstBuffer8 *bufTypeString)
+{
+  uint32_t hash = 2166136261U; /* FNV-1a */
+  uint32_t i;
+
+  hash = (hash ^ tnf) * 16777619U;
+  for (i = 0; i < bufTypeString->length; i++) {
+    hash = (hash ^ bufTypeString->buffer[i]) * 16777619U;
+  }
+
+  return hash;
+}
+
+
+/*****************************************************************************/
+ndefTypeMapEntry *NdefClass::ndefTypeMapFind(uint8_t tnf, const ndefConstBuffer8 *bufTypeString)
+{
+  ndefTypeMapEntry *entry;
+  uint32_t i;
+  uint32_t probe;
+
+  /* Open addressing, linear probing: stop on the first free entry */
+  i = ndefTypeHash(tnf, bufTypeString) & (NDEF_TYPE_MAP_SIZE - 1U);
+  for (probe = 0; probe < NDEF_TYPE_MAP_SIZE; probe++) {
+    entry = &typeMap[i];
+    if (entry->bufTypeString == NULL) {
+      return entry;
+    }
+    if ((entry->tnf == tnf) &&
+        (entry->bufTypeString->length == bufTypeString->length) &&
+        ((bufTypeString->length == 0U) || (ST_BYTECMP(entry->bufTypeString->buffer, bufTypeString->buffer, bufTypeString->length) == 0))) {
+      return entry;
+    }
+    i = (i + 1U) & (NDEF_TYPE_MAP_SIZE - 1U);
+  }
+
+  return NULL;
+}
+
+
+/*****************************************************************************/
+void NdefClass::ndefTypeMapReset(void)
+{
+  static const struct {
+    ndefTypeId              typeId;
+    uint8_t                 tnf;
+    const ndefConstBuffer8 *bufTypeString;
+  } builtinTypes[] = {
     { NDEF_TYPE_EMPTY,           NDEF_TNF_EMPTY,               &bufTypeEmpty              },
     { NDEF_TYPE_RTD_DEVICE_INFO, NDEF_TNF_RTD_WELL_KNOWN_TYPE, &bufRtdTypeDeviceInfo      },
     { NDEF_TYPE_RTD_TEXT,        NDEF_TNF_RTD_WELL_KNOWN_TYPE, &bufRtdTypeText            },
@@ -96,32 +155,100 @@ ReturnCode NdefClass::ndefTypeStringToTypeId(uint8_t tnf, const ndefConstBuffer8
     { NDEF_TYPE_MEDIA_VCARD,     NDEF_TNF_MEDIA_TYPE,          &bufMediaTypeVCard         },
     { NDEF_TYPE_MEDIA_WIFI,      NDEF_TNF_MEDIA_TYPE,          &bufMediaTypeWifi          },
   };
+  uint32_t i;
+
+  (void)ST_MEMSET(typeMap, 0, sizeof(typeMap));
+
+  for (i = 0; i < SIZEOF_ARRAY(builtinTypes); i++) {
+    (void)ndefTypeRegister(builtinTypes[i].tnf, builtinTypes[i].bufTypeString, builtinTypes[i].typeId, NULL);
+  }
+}
+
+
+/*****************************************************************************/
+const ndefTypeMapEntry *NdefClass::ndefTypeMapFindId(ndefTypeId typeId)
+{
+  uint32_t i;
+
+  /* Reverse lookup, only needed to encode application types */
+  for (i = 0; i < NDEF_TYPE_MAP_SIZE; i++) {
+    if ((typeMap[i].bufTypeString != NULL) && (typeMap[i].typeId == typeId)) {
+      return &typeMap[i];
+    }
+  }
+
+  return NULL;
+}
+
+
+/*
+ ******************************************************************************
+ * GLOBAL FUNCTIONS
+ ******************************************************************************
+ */
 
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefTypeRegister(uint8_t tnf, const ndefConstBuffer8 *bufTypeString, ndefTypeId typeId, const ndefTypeHandler *handler)
+{
+  ndefTypeMapEntry *entry;
+  uint32_t count;
   uint32_t i;
 
+  if ((bufTypeString == NULL) || ((bufTypeString->buffer == NULL) && (bufTypeString->length != 0U)) || (tnf >= NDEF_TNF_RESERVED)) {
+    return ST_ERR_PARAM;
+  }
+
+  /* Keep one free entry so that a lookup always terminates on a miss */
+  count = 0;
+  for (i = 0; i < NDEF_TYPE_MAP_SIZE; i++) {
+    if (typeMap[i].bufTypeString != NULL) {
+      count++;
+    }
+  }
+
+  entry = ndefTypeMapFind(tnf, bufTypeString);
+  if (entry == NULL) {
+    return ST_ERR_NOMEM;
+  }
+  if (entry->bufTypeString != NULL) {
+    /* Already registered */
+    return ST_ERR_PARAM;
+  }
+  if (count >= (NDEF_TYPE_MAP_SIZE - 1U)) {
+    return ST_ERR_NOMEM;
+  }
+  if ((handler != NULL) && ((typeId < NDEF_TYPE_ID_COUNT) || (ndefTypeMapFindId(typeId) != NULL))) {
+    /* Handlers are for application types, each with its own Id */
+    return ST_ERR_PARAM;
+  }
+
+  entry->bufTypeString = bufTypeString;
+  entry->handler       = handler;
+  entry->typeId        = typeId;
+  entry->tnf           = tnf;
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefTypeStringToTypeId(uint8_t tnf, const ndefConstBuffer8 *bufTypeString, ndefTypeId *typeId)
+{
+  const ndefTypeMapEntry *entry;
+
   if ((bufTypeString == NULL) || (typeId == NULL)) {
     return ST_ERR_PROTO;
   }
 
-  for (i = 0; i < SIZEOF_ARRAY(typeTable); i++) {
-    /* Check TNF and length are the same, then compare the content */
-    if (typeTable[i].tnf == tnf) {
-      if (bufTypeString->length == typeTable[i].bufTypeString->length) {
-        if (bufTypeString->length == 0U) {
-          /* Empty type */
-          *typeId = typeTable[i].typeId;
-          return ST_ERR_NONE;
-        } else {
-          if (ST_BYTECMP(typeTable[i].bufTypeString->buffer, bufTypeString->buffer, bufTypeString->length) == 0) {
-            *typeId = typeTable[i].typeId;
-            return ST_ERR_NONE;
-          }
-        }
-      }
-    }
+  entry = ndefTypeMapFind(tnf, bufTypeString);
+  if ((entry == NULL) || (entry->bufTypeString == NULL)) {
+    return ST_ERR_NOTFOUND;
   }
 
-  return ST_ERR_NOTFOUND;
+  *typeId = entry->typeId;
+
+  return ST_ERR_NONE;
 }
 
 
@@ -150,6 +277,7 @@ ReturnCode NdefClass::ndefRecordTypeStringToTypeId(const ndefRecord *record, nde
     case NDEF_TNF_RTD_WELL_KNOWN_TYPE: /* Fall through */
     case NDEF_TNF_RTD_EXTERNAL_TYPE:   /* Fall through */
     case NDEF_TNF_MEDIA_TYPE:          /* Fall through */
+    case NDEF_TNF_URI:                 /* Fall through */
       err = ndefTypeStringToTypeId(tnf, &bufRecordType, typeId);
       break;
     default:
@@ -196,8 +324,95 @@ ReturnCode NdefClass::ndefRecordToType(const ndefRecord *record, ndefType *type)
     case NDEF_TYPE_MEDIA_WIFI:
       return ndefRecordToWifi(record, type);
     default:
-      return ST_ERR_NOT_IMPLEMENTED;
+      return ndefRecordToCustomType(record, typeId, type);
+  }
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordToCustomType(const ndefRecord *record, ndefTypeId typeId, ndefType *type)
+{
+  const ndefTypeMapEntry *entry;
+  ReturnCode err;
+
+  if ((record == NULL) || (type == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  entry = ndefTypeMapFindId(typeId);
+  if ((entry == NULL) || (entry->handler == NULL)) {
+    return ST_ERR_NOT_IMPLEMENTED;
+  }
+
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &type->data.custom.bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  type->id               = typeId;
+  type->getPayloadLength = (entry->handler->getPayloadLength != NULL) ? entry->handler->getPayloadLength : ndefCustomPayloadGetLength;
+  type->getPayloadItem   = (entry->handler->getPayloadItem   != NULL) ? entry->handler->getPayloadItem   : ndefCustomToPayloadItem;
+  type->encodeInto       = NULL;
+
+  if (entry->handler->decode != NULL) {
+    return entry->handler->decode(&type->data.custom.bufPayload, type);
+  }
+
+  return ST_ERR_NONE;
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefCustomTypeToRecord(const ndefType *type, ndefRecord *record)
+{
+  const ndefTypeMapEntry *entry;
+
+  if ((type == NULL) || (record == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  entry = ndefTypeMapFindId(type->id);
+  if ((entry == NULL) || (entry->handler == NULL)) {
+    return ST_ERR_NOT_IMPLEMENTED;
+  }
+
+  (void)ndefRecordReset(record);
+
+  (void)ndefRecordSetType(record, entry->tnf, entry->bufTypeString);
+
+  return ndefRecordSetNdefType(record, type);
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefCustomTypeInit(ndefType *type, ndefTypeId typeId, const ndefConstBuffer *bufPayload, void *data)
+{
+  const ndefTypeMapEntry *entry;
+
+  if (type == NULL) {
+    return ST_ERR_PARAM;
   }
+
+  entry = ndefTypeMapFindId(typeId);
+  if ((entry == NULL) || (entry->handler == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  type->id               = typeId;
+  type->getPayloadLength = (entry->handler->getPayloadLength != NULL) ? entry->handler->getPayloadLength : ndefCustomPayloadGetLength;
+  type->getPayloadItem   = (entry->handler->getPayloadItem   != NULL) ? entry->handler->getPayloadItem   : ndefCustomToPayloadItem;
+  type->encodeInto       = NULL;
+
+  type->data.custom.bufPayload.buffer = NULL;
+  type->data.custom.bufPayload.length = 0;
+  if (bufPayload != NULL) {
+    type->data.custom.bufPayload.buffer = bufPayload->buffer;
+    type->data.custom.bufPayload.length = bufPayload->length;
+  }
+  type->data.custom.data = data;
+
+  return ST_ERR_NONE;
 }
 
 
@@ -224,7 +439,7 @@ ReturnCode NdefClass::ndefTypeToRecord(const ndefType *type, ndefRecord *record)
     case NDEF_TYPE_MEDIA_WIFI:
       return ndefWifiToRecord(type, record);
     default:
-      return ST_ERR_NOT_IMPLEMENTED;
+      return ndefCustomTypeToRecord(type, record);
   }
 }
 
@@ -236,7 +451,7 @@ ReturnCode NdefClass::ndefRecordSetNdefType(ndefRecord *record, const ndefType *
 
   if ((record == NULL) ||
       (type                   == NULL)               ||
-      (type->id                > NDEF_TYPE_ID_COUNT) ||
+      ((type->id > NDEF_TYPE_ID_COUNT) && (ndefTypeMapFindId(type->id) == NULL)) ||
       (type->getPayloadLength == NULL)               ||
       (type->getPayloadItem   == NULL)) {
     return ST_ERR_PARAM;
@@ -261,7 +476,7 @@ const ndefType *NdefClass::ndefRecordGetNdefType(const ndefRecord *record)
 
   if (record->ndeftype != NULL) {
     /* Check whether it is a valid NDEF type */
-    if ((record->ndeftype->id                < NDEF_TYPE_ID_COUNT) &&
+    if (((record->ndeftype->id < NDEF_TYPE_ID_COUNT) || (ndefTypeMapFindId(record->ndeftype->id) != NULL)) &&
         (record->ndeftype->getPayloadItem   != NULL) &&
         (record->ndeftype->getPayloadLength != NULL)) {
       return record->ndeftype;
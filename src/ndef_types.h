@@ -114,6 +114,16 @@
 #define NDEF_VCARD_ENTRY_MAX                    16U    /*!< vCard maximum entries */
 
 
+/*! Type lookup defines */
+#ifndef NDEF_TYPE_MAP_SIZE
+#define NDEF_TYPE_MAP_SIZE                      16U    /*!< Type lookup hash table size, power of two, holds built-in and registered types */
+#endif
+
+#if ((NDEF_TYPE_MAP_SIZE & (NDEF_TYPE_MAP_SIZE - 1U)) != 0U)
+#error "NDEF_TYPE_MAP_SIZE must be a power of two"
+#endif
+
+
 /*
  ******************************************************************************
  * GLOBAL TYPES
@@ -195,7 +205,11 @@ typedef struct {
 
 /*! NDEF Type vCard */
 typedef struct {
-  ndefVCardEntry entry[NDEF_VCARD_ENTRY_MAX]; /*!< vCard entries */
+  ndefVCardEntry entry[NDEF_VCARD_ENTRY_MAX]; /*!< vCard entries                                  */
+  ndefVCardEntry *entries;                    /*!< Caller-provided entries, NULL to use entry[]   */
+  uint32_t entryCount;                        /*!< Number of valid entries                        */
+  const uint8_t *bufVersionBuffer;            /*!< Version buffer, NULL for the default "2.1"     */
+  uint8_t  bufVersionLength;                  /*!< Version buffer length                          */
 } ndefTypeVCard;
 
 
@@ -215,11 +229,36 @@ typedef enum {
 } ndefTypeId;
 
 
+/*! Application type: raw payload view and application data */
+typedef struct {
+  ndefConstBuffer bufPayload; /*!< Payload, as decoded or to be encoded by the default payload handlers */
+  void           *data;       /*!< Application data, e.g. the decoded structure, left untouched by the stack */
+} ndefTypeCustom;
+
+
+/*! Application type handler, registered with ndefTypeRegister() */
+typedef struct {
+  uint32_t (*getPayloadLength)(const ndefType *type);       /*!< Return payload length, NULL to use data.custom.bufPayload */
+  const uint8_t *(*getPayloadItem)(const ndefType *type, ndefConstBuffer *item, bool begin); /*!< Payload Encoder, NULL to use data.custom.bufPayload */
+  ReturnCode (*decode)(const ndefConstBuffer *bufPayload, ndefType *type); /*!< Payload decoder, called once data.custom.bufPayload is set, may be NULL */
+} ndefTypeHandler;
+
+
+/*! NDEF type lookup entry, associates a TNF and type string to a ndefTypeId */
+typedef struct {
+  const ndefConstBuffer8 *bufTypeString; /*!< Type String buffer, NULL for a free entry */
+  const ndefTypeHandler  *handler;       /*!< Application type handler, NULL for built-in types */
+  ndefTypeId              typeId;        /*!< NDEF Type Id                              */
+  uint8_t                 tnf;           /*!< TNF                                       */
+} ndefTypeMapEntry;
+
+
 /*! NDEF abstraction Struct */
 struct ndefTypeStruct {
   ndefTypeId      id;                                       /*!< Type Id           */
   uint32_t (*getPayloadLength)(const ndefType *type);       /*!< Return payload length, specific to each type */
   const uint8_t *(*getPayloadItem)(const ndefType *type, ndefConstBuffer *item, bool begin); /*!< Payload Encoder, specific to each type */
+  uint32_t (*encodeInto)(const ndefType *type, uint8_t *buffer); /*!< Optional contiguous payload encoder, returns the length written or 0 to use getPayloadItem */
   union {
     ndefTypeRtdDeviceInfo  deviceInfo;    /*!< Device Information */
     ndefTypeRtdText        text;          /*!< Text               */
@@ -228,6 +267,7 @@ struct ndefTypeStruct {
     ndefTypeMedia          media;         /*!< Media              */
     ndefTypeVCard          vCard;         /*!< vCard              */
     ndefTypeWifi           wifi;          /*!< Wifi               */
+    ndefTypeCustom         custom;        /*!< Application type   */
   } data;                               /*!< Type data union        */
 };
 
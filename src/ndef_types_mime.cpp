@@ -82,6 +82,8 @@ static const ndefConstBuffer bufTypeVersion = { TYPE_VERSION, sizeof(TYPE_VERSIO
 static const ndefConstBuffer bufValueVCard  = { VALUE_VCARD,  sizeof(VALUE_VCARD) - 1U };  /*!< "VCARD"   */
 static const ndefConstBuffer bufValue_2_1   = { VALUE_2_1,    sizeof(VALUE_2_1) - 1U };    /*!< "2.1"     */
 
+#define NDEF_VCARD_OFFSET_NONE 0xFFFFFFFFU /*!< Delimiter not found in the current line */
+
 
 /*
  ******************************************************************************
@@ -94,6 +96,11 @@ extern "C" {
 #endif
 static uint32_t ndefVCardPayloadGetLength(const ndefType *vCard);
 static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuffer *bufItem, bool begin);
+static uint32_t ndefVCardEncodeInto(const ndefType *vCard, uint8_t *buffer);
+static uint32_t ndefVCardEmit(uint8_t *buffer, uint32_t offset, const uint8_t *bufItem, uint32_t length);
+static const ndefVCardEntry *ndefVCardGetEntries(const ndefTypeVCard *vCardData);
+static void ndefVCardGetVersion(const ndefTypeVCard *vCardData, ndefConstBuffer *bufVersion);
+static bool ndefVCardKeywordMatch(const uint8_t *buffer, uint32_t length, const ndefConstBuffer *bufKeyword);
 #ifdef __cplusplus
 }
 #endif
@@ -125,6 +132,7 @@ ReturnCode NdefClass::ndefMedia(ndefType *media, const ndefConstBuffer8 *bufType
   media->id               = NDEF_TYPE_MEDIA;
   media->getPayloadLength = NULL;
   media->getPayloadItem   = NULL;
+  media->encodeInto       = NULL;
   typeMedia               = &media->data.media;
 
   typeMedia->bufType.buffer    = bufType->buffer;
@@ -162,6 +170,8 @@ ReturnCode NdefClass::ndefGetMedia(const ndefType *media, ndefConstBuffer8 *bufT
 ReturnCode NdefClass::ndefRecordToMedia(const ndefRecord *record, ndefType *media)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
   ndefConstBuffer8 bufType;
 
   if ((record == NULL) || (media == NULL)) {
@@ -178,10 +188,16 @@ ReturnCode NdefClass::ndefRecordToMedia(const ndefRecord *record, ndefType *medi
     return ST_ERR_NONE;
   }
 
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
   bufType.buffer = record->type;
   bufType.length = record->typeLength;
 
-  return ndefMedia(media, &bufType, &record->bufPayload);
+  return ndefMedia(media, &bufType, &bufPayload);
 }
 
 
@@ -214,10 +230,57 @@ ReturnCode NdefClass::ndefMediaToRecord(const ndefType *media, ndefRecord *recor
 #ifdef __cplusplus
 extern "C" {
 #endif
+/*****************************************************************************/
+static const ndefVCardEntry *ndefVCardGetEntries(const ndefTypeVCard *vCardData)
+{
+  return (vCardData->entries != NULL) ? vCardData->entries : vCardData->entry;
+}
+
+
+/*****************************************************************************/
+static void ndefVCardGetVersion(const ndefTypeVCard *vCardData, ndefConstBuffer *bufVersion)
+{
+  if (vCardData->bufVersionBuffer != NULL) {
+    bufVersion->buffer = vCardData->bufVersionBuffer;
+    bufVersion->length = vCardData->bufVersionLength;
+  } else {
+    bufVersion->buffer = bufValue_2_1.buffer;
+    bufVersion->length = bufValue_2_1.length;
+  }
+}
+
+
+/*****************************************************************************/
+static bool ndefVCardKeywordMatch(const uint8_t *buffer, uint32_t length, const ndefConstBuffer *bufKeyword)
+{
+  uint32_t i;
+  uint8_t  c;
+
+  if (length != bufKeyword->length) {
+    return false;
+  }
+
+  /* Keywords are case insensitive, the reference ones are upper case */
+  for (i = 0; i < length; i++) {
+    c = buffer[i];
+    if ((c >= (uint8_t)'a') && (c <= (uint8_t)'z')) {
+      c -= (uint8_t)('a' - 'A');
+    }
+    if (c != bufKeyword->buffer[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
 /*****************************************************************************/
 static uint32_t ndefVCardPayloadGetLength(const ndefType *vCard)
 {
-  const ndefTypeVCard *vCardData;
+  const ndefTypeVCard  *vCardData;
+  const ndefVCardEntry *entries;
+  ndefConstBuffer bufVersion;
   uint32_t payloadLength = 0;
   uint32_t i;
 
@@ -226,6 +289,13 @@ static uint32_t ndefVCardPayloadGetLength(const ndefType *vCard)
   }
 
   vCardData = &vCard->data.vCard;
+  entries   = ndefVCardGetEntries(vCardData);
+  ndefVCardGetVersion(vCardData, &bufVersion);
+
+  /* An empty vCard has an empty payload, see ndefVCardToPayloadItem() */
+  if (vCardData->entryCount == 0U) {
+    return 0;
+  }
 
   payloadLength += bufTypeBegin.length;
   payloadLength += bufDelimiterColon.length;
@@ -234,24 +304,21 @@ static uint32_t ndefVCardPayloadGetLength(const ndefType *vCard)
 
   payloadLength += bufTypeVersion.length;
   payloadLength += bufDelimiterColon.length;
-  payloadLength += bufValue_2_1.length;
+  payloadLength += bufVersion.length;
   payloadLength += bufDelimiterNewLine.length;
 
-  i = 0;
-  while (vCardData->entry[i].bufTypeBuffer != NULL) {
-    payloadLength += vCardData->entry[i].bufTypeLength;
+  for (i = 0; i < vCardData->entryCount; i++) {
+    payloadLength += entries[i].bufTypeLength;
 
-    if (vCardData->entry[i].bufSubTypeBuffer != NULL) {
+    if (entries[i].bufSubTypeBuffer != NULL) {
       payloadLength += bufDelimiterSemicolon.length;
-      payloadLength += vCardData->entry[i].bufSubTypeLength;
+      payloadLength += entries[i].bufSubTypeLength;
     }
 
     payloadLength += bufDelimiterColon.length;
 
-    payloadLength += vCardData->entry[i].bufValueLength;
+    payloadLength += entries[i].bufValueLength;
     payloadLength += bufDelimiterNewLine.length;
-
-    i++;
   }
 
   payloadLength += bufTypeEnd.length;
@@ -269,7 +336,8 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
   static uint32_t item     = 0;
   static uint32_t userItem = 0;
   static uint32_t index    = 0;
-  const ndefTypeVCard *vCardData;
+  const ndefTypeVCard  *vCardData;
+  const ndefVCardEntry *entries;
 
   if ((vCard   == NULL) || (vCard->id != NDEF_TYPE_MEDIA_VCARD) ||
       (bufItem == NULL)) {
@@ -277,6 +345,7 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
   }
 
   vCardData = &vCard->data.vCard;
+  entries   = ndefVCardGetEntries(vCardData);
 
   if (begin == true) {
     item     = 0;
@@ -288,7 +357,7 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
   bufItem->length = 0;
 
   /* Check for for empty vCard */
-  if (vCardData->entry[0].bufTypeBuffer == NULL) {
+  if (vCardData->entryCount == 0U) {
     return NULL;
   }
 
@@ -327,8 +396,7 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
       item++; /* Move to next item for next call */
       break;
     case 6:
-      bufItem->buffer = bufValue_2_1.buffer;
-      bufItem->length = bufValue_2_1.length;
+      ndefVCardGetVersion(vCardData, bufItem);
       item++; /* Move to next item for next call */
       break;
     case 7:
@@ -343,16 +411,16 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
       switch (userItem) {
         case 0:
           /* Type */
-          if (vCardData->entry[index].bufTypeBuffer == NULL) {
+          if (index >= vCardData->entryCount) {
             bufItem->buffer = bufTypeEnd.buffer;
             bufItem->length = bufTypeEnd.length;
             item++; /* Exit the user item loop */
             break;
           }
-          bufItem->buffer = vCardData->entry[index].bufTypeBuffer;
-          bufItem->length = vCardData->entry[index].bufTypeLength;
+          bufItem->buffer = entries[index].bufTypeBuffer;
+          bufItem->length = entries[index].bufTypeLength;
 
-          if (vCardData->entry[index].bufSubTypeBuffer != NULL) {
+          if (entries[index].bufSubTypeBuffer != NULL) {
             userItem++;
           } else {
             userItem += 3U; /* Skip sending semicolon and subtype, move to colon */
@@ -365,8 +433,8 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
           break;
         case 2:
           /* Subtype */
-          bufItem->buffer = vCardData->entry[index].bufSubTypeBuffer;
-          bufItem->length = vCardData->entry[index].bufSubTypeLength;
+          bufItem->buffer = entries[index].bufSubTypeBuffer;
+          bufItem->length = entries[index].bufSubTypeLength;
           userItem++;
           break;
         case 3:
@@ -376,8 +444,8 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
           break;
         case 4:
           /* Value */
-          bufItem->buffer = vCardData->entry[index].bufValueBuffer;
-          bufItem->length = vCardData->entry[index].bufValueLength;
+          bufItem->buffer = entries[index].bufValueBuffer;
+          bufItem->length = entries[index].bufValueLength;
           userItem++;
           break;
         case 5:
@@ -409,6 +477,66 @@ static const uint8_t *ndefVCardToPayloadItem(const ndefType *vCard, ndefConstBuf
 
   return bufItem->buffer;
 }
+
+
+/*****************************************************************************/
+static uint32_t ndefVCardEmit(uint8_t *buffer, uint32_t offset, const uint8_t *bufItem, uint32_t length)
+{
+  (void)ST_MEMCPY(&buffer[offset], bufItem, length);
+  return offset + length;
+}
+
+
+/*****************************************************************************/
+static uint32_t ndefVCardEncodeInto(const ndefType *vCard, uint8_t *buffer)
+{
+  const ndefTypeVCard  *vCardData;
+  const ndefVCardEntry *entries;
+  ndefConstBuffer bufVersion;
+  uint32_t offset;
+  uint32_t i;
+
+  if ((vCard == NULL) || (vCard->id != NDEF_TYPE_MEDIA_VCARD) || (buffer == NULL)) {
+    return 0;
+  }
+
+  vCardData = &vCard->data.vCard;
+  entries   = ndefVCardGetEntries(vCardData);
+  ndefVCardGetVersion(vCardData, &bufVersion);
+
+  /* Same content as ndefVCardToPayloadItem(), empty vCard included */
+  if (vCardData->entryCount == 0U) {
+    return 0;
+  }
+
+  offset = 0;
+  offset = ndefVCardEmit(buffer, offset, bufTypeBegin.buffer,        bufTypeBegin.length);
+  offset = ndefVCardEmit(buffer, offset, bufDelimiterColon.buffer,   bufDelimiterColon.length);
+  offset = ndefVCardEmit(buffer, offset, bufValueVCard.buffer,       bufValueVCard.length);
+  offset = ndefVCardEmit(buffer, offset, bufDelimiterNewLine.buffer, bufDelimiterNewLine.length);
+
+  offset = ndefVCardEmit(buffer, offset, bufTypeVersion.buffer,      bufTypeVersion.length);
+  offset = ndefVCardEmit(buffer, offset, bufDelimiterColon.buffer,   bufDelimiterColon.length);
+  offset = ndefVCardEmit(buffer, offset, bufVersion.buffer,          bufVersion.length);
+  offset = ndefVCardEmit(buffer, offset, bufDelimiterNewLine.buffer, bufDelimiterNewLine.length);
+
+  for (i = 0; i < vCardData->entryCount; i++) {
+    offset = ndefVCardEmit(buffer, offset, entries[i].bufTypeBuffer, entries[i].bufTypeLength);
+    if (entries[i].bufSubTypeBuffer != NULL) {
+      offset = ndefVCardEmit(buffer, offset, bufDelimiterSemicolon.buffer, bufDelimiterSemicolon.length);
+      offset = ndefVCardEmit(buffer, offset, entries[i].bufSubTypeBuffer, entries[i].bufSubTypeLength);
+    }
+    offset = ndefVCardEmit(buffer, offset, bufDelimiterColon.buffer,   bufDelimiterColon.length);
+    offset = ndefVCardEmit(buffer, offset, entries[i].bufValueBuffer,  entries[i].bufValueLength);
+    offset = ndefVCardEmit(buffer, offset, bufDelimiterNewLine.buffer, bufDelimiterNewLine.length);
+  }
+
+  offset = ndefVCardEmit(buffer, offset, bufTypeEnd.buffer,          bufTypeEnd.length);
+  offset = ndefVCardEmit(buffer, offset, bufDelimiterColon.buffer,   bufDelimiterColon.length);
+  offset = ndefVCardEmit(buffer, offset, bufValueVCard.buffer,       bufValueVCard.length);
+
+  return offset;
+}
 #ifdef __cplusplus
 }
 #endif
@@ -428,6 +556,7 @@ ReturnCode NdefClass::ndefVCard(ndefType *vCard, const ndefVCardInput *bufVCardI
   vCard->id               = NDEF_TYPE_MEDIA_VCARD;
   vCard->getPayloadLength = ndefVCardPayloadGetLength;
   vCard->getPayloadItem   = ndefVCardToPayloadItem;
+  vCard->encodeInto       = ndefVCardEncodeInto;
   vCardData               = &vCard->data.vCard;
 
   /* Initialize array */
@@ -439,6 +568,10 @@ ReturnCode NdefClass::ndefVCard(ndefType *vCard, const ndefVCardInput *bufVCardI
     vCardData->entry[i].bufValueBuffer   = NULL;
     vCardData->entry[i].bufValueLength   = 0;
   }
+  vCardData->entries          = NULL;
+  vCardData->entryCount       = bufVCardInputCount;
+  vCardData->bufVersionBuffer = NULL;
+  vCardData->bufVersionLength = 0;
 
   /* Pointer to user input */
   for (i = 0; i < bufVCardInputCount; i++) {
@@ -458,7 +591,8 @@ ReturnCode NdefClass::ndefVCard(ndefType *vCard, const ndefVCardInput *bufVCardI
 /*****************************************************************************/
 ReturnCode NdefClass::ndefGetVCard(const ndefType *vCard, const ndefConstBuffer *bufType, ndefConstBuffer *bufSubType, ndefConstBuffer *bufValue)
 {
-  const ndefTypeVCard *vCardData;
+  const ndefTypeVCard  *vCardData;
+  const ndefVCardEntry *entries;
   uint32_t i;
 
   if ((vCard   == NULL) || (vCard->id != NDEF_TYPE_MEDIA_VCARD) ||
@@ -467,6 +601,7 @@ ReturnCode NdefClass::ndefGetVCard(const ndefType *vCard, const ndefConstBuffer
   }
 
   vCardData = &vCard->data.vCard;
+  entries   = ndefVCardGetEntries(vCardData);
 
   bufSubType->buffer = NULL;
   bufSubType->length = 0;
@@ -474,48 +609,24 @@ ReturnCode NdefClass::ndefGetVCard(const ndefType *vCard, const ndefConstBuffer
   bufValue->buffer = NULL;
   bufValue->length = 0;
 
-  for (i = 0; i < NDEF_VCARD_ENTRY_MAX; i++) {
-    if ((vCardData->entry[i].bufTypeLength != 0U) &&
-        (vCardData->entry[i].bufTypeLength == bufType->length)) {
-      if (bufType->length > 0U) {
-        if (ST_BYTECMP(vCardData->entry[i].bufTypeBuffer, bufType->buffer, bufType->length) == 0) {
-          bufSubType->buffer = vCardData->entry[i].bufSubTypeBuffer;
-          bufSubType->length = vCardData->entry[i].bufSubTypeLength;
-
-          bufValue->buffer = vCardData->entry[i].bufValueBuffer;
-          bufValue->length = vCardData->entry[i].bufValueLength;
-
-          return ST_ERR_NONE;
-        }
-      }
-    }
+  if ((bufType->buffer != NULL) && ndefVCardKeywordMatch(bufType->buffer, bufType->length, &bufTypeVersion)) {
+    ndefVCardGetVersion(vCardData, bufValue);
+    return ST_ERR_NONE;
   }
 
-  return ST_ERR_NOTFOUND;
-}
-
+  for (i = 0; i < vCardData->entryCount; i++) {
+    if ((entries[i].bufTypeLength != 0U) &&
+        (entries[i].bufTypeLength == bufType->length)) {
+      if (ST_BYTECMP(entries[i].bufTypeBuffer, bufType->buffer, bufType->length) == 0) {
+        bufSubType->buffer = entries[i].bufSubTypeBuffer;
+        bufSubType->length = entries[i].bufSubTypeLength;
 
-/*****************************************************************************/
-ReturnCode NdefClass::ndefVCardFindMarker(const ndefConstBuffer *bufPayload, const ndefConstBuffer *bufMarker, uint32_t *offset)
-{
-  uint32_t tempOffset;
+        bufValue->buffer = entries[i].bufValueBuffer;
+        bufValue->length = entries[i].bufValueLength;
 
-  if ((bufPayload == NULL) || (bufPayload->buffer == NULL) ||
-      (bufMarker  == NULL) || (bufMarker->buffer  == NULL) ||
-      (offset     == NULL)) {
-    return ST_ERR_PROTO;
-  }
-
-  tempOffset = 0;
-  while (tempOffset < (bufPayload->length - bufMarker->length)) {
-    if (bufMarker->length > 0U) {
-      // TODO Convert To Upper to be case insensitive
-      if (ST_BYTECMP(&bufPayload->buffer[tempOffset], bufMarker->buffer, bufMarker->length) == 0) {
-        *offset = tempOffset;
         return ST_ERR_NONE;
       }
     }
-    tempOffset++;
   }
 
   return ST_ERR_NOTFOUND;
@@ -523,153 +634,146 @@ ReturnCode NdefClass::ndefVCardFindMarker(const ndefConstBuffer *bufPayload, con
 
 
 /*****************************************************************************/
-ReturnCode NdefClass::ndefVCardExtractLine(const ndefConstBuffer *bufPayload, const ndefConstBuffer *bufMarker, ndefConstBuffer *bufLine)
+ReturnCode NdefClass::ndefVCardParseLine(const uint8_t *line, uint32_t semicolon, uint32_t colon, uint32_t lineEnd, ndefVCardEntry *vCardEntry)
 {
-  ReturnCode err;
-  uint32_t markerOffset;
+  uint32_t typeEnd;
 
-  if ((bufPayload == NULL) || (bufPayload->buffer == NULL) ||
-      (bufMarker  == NULL) || (bufMarker->buffer  == NULL) ||
-      (bufLine    == NULL) || (bufLine->buffer    == NULL)) {
+  if ((line == NULL) || (vCardEntry == NULL) || (colon >= lineEnd + 1U)) {
     return ST_ERR_PROTO;
   }
 
-  err = ndefVCardFindMarker(bufPayload, bufMarker, &markerOffset);
-  if (err == ST_ERR_NONE) {
-    /* Return up to the marker */
-    bufLine->buffer = bufPayload->buffer;
-    bufLine->length = markerOffset;
-  } else {
-    /* Return up to the end of the payload */
-    bufLine->buffer = bufPayload->buffer;
-    bufLine->length = bufPayload->length;
-  }
-
-  return ST_ERR_NONE;
-}
-
+  typeEnd = (semicolon != NDEF_VCARD_OFFSET_NONE) ? semicolon : colon;
 
-/*****************************************************************************/
-ReturnCode NdefClass::ndefVCardParseLine(const ndefConstBuffer *bufLine, ndefVCardEntry *vCardEntry)
-{
-  ReturnCode err;
-  ndefConstBuffer bufKeyword;
-  uint32_t semicolonOffset;
-  uint32_t colonOffset;
-
-  if ((bufLine == NULL) || (bufLine->buffer == NULL) || (vCardEntry == NULL)) {
-    return ST_ERR_PROTO;
+  /* Lengths must fit the entry fields */
+  if ((typeEnd > 0xFFU) || ((colon - typeEnd) > 0x100U) || ((lineEnd - colon - 1U) > 0xFFFFU)) {
+    return ST_ERR_NOMEM;
   }
 
-  /* Look for the type delimiter colon ":" */
-  err = ndefVCardFindMarker(bufLine, &bufDelimiterColon, &colonOffset);
-  if (err != ST_ERR_NONE) {
-    /* Invalid line */
-    return err;
-  }
-
-  /* Keyword is located at the beginning of the line up to the delimiter colon */
-  bufKeyword.buffer = bufLine->buffer;
-  bufKeyword.length = colonOffset;
-
-  vCardEntry->bufTypeBuffer = bufLine->buffer;
-  vCardEntry->bufTypeLength = (uint8_t)colonOffset;
+  vCardEntry->bufTypeBuffer = line;
+  vCardEntry->bufTypeLength = (uint8_t)typeEnd;
 
-  /* Look for any subtype delimiter semicolon ";" */
-  err = ndefVCardFindMarker(&bufKeyword, &bufDelimiterSemicolon, &semicolonOffset);
-  if (err == ST_ERR_NONE) {
+  if (semicolon != NDEF_VCARD_OFFSET_NONE) {
     /* Subtype found (remove the leading ";") */
-    vCardEntry->bufSubTypeBuffer = &bufLine->buffer[semicolonOffset + 1U];
-    vCardEntry->bufSubTypeLength = (uint8_t)(colonOffset - semicolonOffset - 1U);
-
-    /* Adjust the Type length */
-    vCardEntry->bufTypeLength -= vCardEntry->bufSubTypeLength + 1U;
+    vCardEntry->bufSubTypeBuffer = &line[semicolon + 1U];
+    vCardEntry->bufSubTypeLength = (uint8_t)(colon - semicolon - 1U);
+  } else {
+    vCardEntry->bufSubTypeBuffer = NULL;
+    vCardEntry->bufSubTypeLength = 0;
   }
 
-  /* The value follows ":" until the end of the line */
-  vCardEntry->bufValueBuffer = &bufLine->buffer[colonOffset + 1U];
-  vCardEntry->bufValueLength = (uint16_t)(bufLine->length - colonOffset);
+  /* The value follows ":" until the end of the line, folded lines included */
+  vCardEntry->bufValueBuffer = &line[colon + 1U];
+  vCardEntry->bufValueLength = (uint16_t)(lineEnd - colon - 1U);
 
   return ST_ERR_NONE;
 }
 
 
 /*****************************************************************************/
-bool NdefClass::ndefIsVCardTypeFound(const ndefTypeVCard *vCard, const uint8_t *typeString)
-{
-  uint32_t i;
-  for (i = 0; i < NDEF_VCARD_ENTRY_MAX; i++) {
-    if (vCard->entry[i].bufTypeLength > 0U) {
-      if (ST_BYTECMP(typeString, vCard->entry[i].bufTypeBuffer, vCard->entry[i].bufTypeLength) == 0) {
-        return true;
-      }
-    }
-  }
-
-  return false;
-}
-
-
-/*****************************************************************************/
-ReturnCode NdefClass::ndefPayloadToVcard(const ndefConstBuffer *bufPayload, ndefType *vCard)
+ReturnCode NdefClass::ndefPayloadToVcard(const ndefConstBuffer *bufPayload, ndefType *vCard, ndefVCardEntry *entries, uint32_t capacity)
 {
-  ReturnCode err;
-  ndefTypeVCard *vCardData;
-
-  uint32_t i;
+  ndefTypeVCard  *vCardData;
+  ndefVCardEntry *entry;
+  ndefVCardEntry  lineEntry;
+  const uint8_t  *payload;
   uint32_t offset;
-  uint32_t entry_count;
-  ndefConstBuffer bufLinePayload;
-  ndefConstBuffer bufLine;
+  uint32_t lineStart;
+  uint32_t lineEnd;
+  uint32_t colon;
+  uint32_t semicolon;
+  bool     endOfLine;
+  bool     beginFound   = false;
+  bool     versionFound = false;
+  bool     endFound     = false;
+  bool     overflow     = false;
 
   if ((bufPayload == NULL) || (bufPayload->buffer == NULL) || (bufPayload->length == 0U) ||
-      (vCard      == NULL)) {
+      (vCard      == NULL) || ((entries != NULL) && (capacity == 0U))) {
     return ST_ERR_PROTO;
   }
 
   vCard->id               = NDEF_TYPE_MEDIA_VCARD;
   vCard->getPayloadLength = ndefVCardPayloadGetLength;
   vCard->getPayloadItem   = ndefVCardToPayloadItem;
+  vCard->encodeInto       = ndefVCardEncodeInto;
   vCardData               = &vCard->data.vCard;
 
-  /* Clear the vCard before parsing */
-  for (i = 0; i < NDEF_VCARD_ENTRY_MAX; i++) {
-    vCardData->entry[i].bufTypeBuffer    = NULL;
-    vCardData->entry[i].bufTypeLength    = 0;
-    vCardData->entry[i].bufSubTypeBuffer = NULL;
-    vCardData->entry[i].bufSubTypeLength = 0;
-    vCardData->entry[i].bufValueBuffer   = NULL;
-    vCardData->entry[i].bufValueLength   = 0;
-  }
+  vCardData->entries          = entries;
+  vCardData->entryCount       = 0;
+  vCardData->bufVersionBuffer = NULL;
+  vCardData->bufVersionLength = 0;
+  if (entries == NULL) {
+    entries  = vCardData->entry;
+    capacity = NDEF_VCARD_ENTRY_MAX;
+  }
+
+  /* Single pass: delimiters are located while looking for the end of line.
+   * A line break followed by a space or a tab is a folded line and belongs to the current line.
+   */
+  payload   = bufPayload->buffer;
+  lineStart = 0;
+  colon     = NDEF_VCARD_OFFSET_NONE;
+  semicolon = NDEF_VCARD_OFFSET_NONE;
+  for (offset = 0; (offset <= bufPayload->length) && (endFound == false); offset++) {
+    endOfLine = (offset == bufPayload->length);
+    if (endOfLine == false) {
+      if (payload[offset] == (uint8_t)'\n') {
+        endOfLine = ((offset + 1U) >= bufPayload->length) ||
+                    ((payload[offset + 1U] != (uint8_t)' ') && (payload[offset + 1U] != (uint8_t)'\t'));
+      } else if (colon != NDEF_VCARD_OFFSET_NONE) {
+        /* Value content */
+      } else if (payload[offset] == (uint8_t)':') {
+        colon = offset - lineStart;
+      } else if ((payload[offset] == (uint8_t)';') && (semicolon == NDEF_VCARD_OFFSET_NONE)) {
+        semicolon = offset - lineStart;
+      } else {
+        /* MISRA 15.7 - Empty else */
+      }
+    }
+    if (endOfLine == false) {
+      continue;
+    }
 
-  offset = 0;
-  entry_count = 0;
-  while ((offset < bufPayload->length) && (entry_count < NDEF_VCARD_ENTRY_MAX)) {
-    /* Search an "end of line" or end of payload among the remaining to parse */
-    bufLinePayload.buffer = &bufPayload->buffer[offset];
-    bufLinePayload.length = bufPayload->length - offset;
-
-    (void)ndefVCardExtractLine(&bufLinePayload, &bufDelimiterNewLine, &bufLine);
-
-    /* Parse line and fill vCard entry */
-    err = ndefVCardParseLine(&bufLine, &vCardData->entry[entry_count]);
-    if (err == ST_ERR_NONE) {
-      entry_count++;
+    /* Remove the "\r" of "\r\n" */
+    lineEnd = offset - lineStart;
+    if ((lineEnd > 0U) && (payload[offset - 1U] == (uint8_t)'\r')) {
+      lineEnd--;
+    }
+
+    /* Lines without ":" are ignored */
+    if ((colon != NDEF_VCARD_OFFSET_NONE) &&
+        (ndefVCardParseLine(&payload[lineStart], semicolon, colon, lineEnd, &lineEntry) == ST_ERR_NONE)) {
+      if (ndefVCardKeywordMatch(lineEntry.bufTypeBuffer, lineEntry.bufTypeLength, &bufTypeBegin)) {
+        beginFound = ndefVCardKeywordMatch(lineEntry.bufValueBuffer, lineEntry.bufValueLength, &bufValueVCard);
+      } else if (ndefVCardKeywordMatch(lineEntry.bufTypeBuffer, lineEntry.bufTypeLength, &bufTypeEnd)) {
+        endFound = true;
+      } else if (ndefVCardKeywordMatch(lineEntry.bufTypeBuffer, lineEntry.bufTypeLength, &bufTypeVersion)) {
+        versionFound = (lineEntry.bufValueLength <= 0xFFU);
+        vCardData->bufVersionBuffer = lineEntry.bufValueBuffer;
+        vCardData->bufVersionLength = (uint8_t)lineEntry.bufValueLength;
+      } else if (vCardData->entryCount < capacity) {
+        entry = &entries[vCardData->entryCount];
+        (void)ST_MEMCPY(entry, &lineEntry, sizeof(ndefVCardEntry));
+        vCardData->entryCount++;
+      } else {
+        overflow = true;
+      }
     }
 
     /* Move to the next line */
-    offset += bufLine.length + bufDelimiterNewLine.length;
+    lineStart = offset + 1U;
+    colon     = NDEF_VCARD_OFFSET_NONE;
+    semicolon = NDEF_VCARD_OFFSET_NONE;
   }
 
   /* Check BEGIN, VERSION and END types exist */
-  if (ndefIsVCardTypeFound(vCardData, bufTypeBegin.buffer) == false) {
-    return ST_ERR_SYNTAX;
-  } else if (ndefIsVCardTypeFound(vCardData, bufTypeVersion.buffer) == false) {
+  if ((beginFound == false) || (versionFound == false) || (endFound == false)) {
     return ST_ERR_SYNTAX;
-  } else if (ndefIsVCardTypeFound(vCardData, bufTypeEnd.buffer) == false) {
-    return ST_ERR_SYNTAX;
-  } else {
-    /* MISRA 15.7 - Empty else */
+  }
+
+  if (overflow) {
+    /* Entries up to the capacity are available */
+    return ST_ERR_NOMEM;
   }
 
   return ST_ERR_NONE;
@@ -680,6 +784,8 @@ ReturnCode NdefClass::ndefPayloadToVcard(const ndefConstBuffer *bufPayload, ndef
 ReturnCode NdefClass::ndefRecordToVCard(const ndefRecord *record, ndefType *vCard)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
 
   if ((record == NULL) || (vCard == NULL)) {
     return ST_ERR_PARAM;
@@ -695,7 +801,37 @@ ReturnCode NdefClass::ndefRecordToVCard(const ndefRecord *record, ndefType *vCar
     return ST_ERR_NONE;
   }
 
-  return ndefPayloadToVcard(&record->bufPayload, vCard);
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  return ndefPayloadToVcard(&bufPayload, vCard, NULL, 0);
+}
+
+
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRecordToVCardEntries(const ndefRecord *record, ndefType *vCard, ndefVCardEntry *entries, uint32_t capacity)
+{
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
+
+  if ((record == NULL) || (vCard == NULL) || (entries == NULL) || (capacity == 0U)) {
+    return ST_ERR_PARAM;
+  }
+
+  if (! ndefRecordTypeMatch(record, NDEF_TNF_MEDIA_TYPE, &bufMediaTypeVCard)) { /* "text/x-vCard" */
+    return ST_ERR_PROTO;
+  }
+
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  return ndefPayloadToVcard(&bufPayload, vCard, entries, capacity);
 }
 
 
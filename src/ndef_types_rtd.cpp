@@ -163,6 +163,31 @@ static const ndefConstBuffer ndefUriPrefix[NDEF_URI_PREFIX_COUNT] = {
   { ndefUriPrefixEmpty, sizeof(ndefUriPrefixEmpty) - 1U }
 };
 
+/*! URI protocols grouped by first character ('a' to 'z'), longest prefix first within a group */
+static const uint8_t ndefUriPrefixByChar[] = {
+  /* b */ NDEF_URI_PREFIX_BTL2CAP, NDEF_URI_PREFIX_BTGOEP, NDEF_URI_PREFIX_BTSPP,
+  /* d */ NDEF_URI_PREFIX_DAV,
+  /* f */ NDEF_URI_PREFIX_FTP_ANONYMOUS, NDEF_URI_PREFIX_FTP_FTP, NDEF_URI_PREFIX_FTPS, NDEF_URI_PREFIX_FILE, NDEF_URI_PREFIX_FTP,
+  /* h */ NDEF_URI_PREFIX_HTTPS_WWW, NDEF_URI_PREFIX_HTTP_WWW, NDEF_URI_PREFIX_HTTPS, NDEF_URI_PREFIX_HTTP,
+  /* i */ NDEF_URI_PREFIX_IRDAOBEX, NDEF_URI_PREFIX_IMAP,
+  /* m */ NDEF_URI_PREFIX_MAILTO,
+  /* n */ NDEF_URI_PREFIX_NFS, NDEF_URI_PREFIX_NEWS,
+  /* p */ NDEF_URI_PREFIX_POP,
+  /* r */ NDEF_URI_PREFIX_RTSP,
+  /* s */ NDEF_URI_PREFIX_SFTP, NDEF_URI_PREFIX_SMB, NDEF_URI_PREFIX_SIPS, NDEF_URI_PREFIX_SIP,
+  /* t */ NDEF_URI_PREFIX_TCPOBEX, NDEF_URI_PREFIX_TELNET, NDEF_URI_PREFIX_TFTP, NDEF_URI_PREFIX_TEL,
+  /* u */ NDEF_URI_PREFIX_URN_EPC_PAT, NDEF_URI_PREFIX_URN_EPC_RAW, NDEF_URI_PREFIX_URN_EPC_ID, NDEF_URI_PREFIX_URN_EPC_TAG,
+          NDEF_URI_PREFIX_URN_EPC, NDEF_URI_PREFIX_URN_NFC, NDEF_URI_PREFIX_URN
+};
+
+/*! Start index in ndefUriPrefixByChar for each first character 'a' to 'z', plus end marker */
+static const uint8_t ndefUriPrefixCharStart[27] = {
+  /* a */  0U, /* b */  0U, /* c */  3U, /* d */  3U, /* e */  4U, /* f */  4U, /* g */  9U,
+  /* h */  9U, /* i */ 13U, /* j */ 15U, /* k */ 15U, /* l */ 15U, /* m */ 15U, /* n */ 16U,
+  /* o */ 18U, /* p */ 18U, /* q */ 19U, /* r */ 19U, /* s */ 20U, /* t */ 24U, /* u */ 28U,
+  /* v */ 35U, /* w */ 35U, /* x */ 35U, /* y */ 35U, /* z */ 35U, /* end */ 35U
+};
+
 
 /*
  ******************************************************************************
@@ -179,8 +204,10 @@ static uint32_t ndefRtdDeviceInfoPayloadGetLength(const ndefType *devInfo);
 static const uint8_t *ndefRtdDeviceInfoToPayloadItem(const ndefType *devInfo, ndefConstBuffer *bufItem, bool begin);
 static uint32_t ndefRtdTextPayloadGetLength(const ndefType *text);
 static const uint8_t *ndefRtdTextToPayloadItem(const ndefType *text, ndefConstBuffer *bufItem, bool begin);
+static uint32_t ndefRtdTextEncodeInto(const ndefType *text, uint8_t *buffer);
 static uint32_t ndefRtdUriPayloadGetLength(const ndefType *uri);
 static const uint8_t *ndefRtdUriToPayloadItem(const ndefType *uri, ndefConstBuffer *bufItem, bool begin);
+static uint32_t ndefRtdUriEncodeInto(const ndefType *uri, uint8_t *buffer);
 #ifdef __cplusplus
 }
 #endif
@@ -241,6 +268,7 @@ ReturnCode NdefClass::ndefEmptyType(ndefType *empty)
   empty->id               = NDEF_TYPE_EMPTY;
   empty->getPayloadLength = ndefEmptyTypePayloadGetLength;
   empty->getPayloadItem   = ndefEmptyTypePayloadItem;
+  empty->encodeInto       = NULL;
 
   return ST_ERR_NONE;
 }
@@ -387,6 +415,7 @@ ReturnCode NdefClass::ndefRtdDeviceInfo(ndefType *devInfo, const ndefDeviceInfoE
   devInfo->id               = NDEF_TYPE_RTD_DEVICE_INFO;
   devInfo->getPayloadLength = ndefRtdDeviceInfoPayloadGetLength;
   devInfo->getPayloadItem   = ndefRtdDeviceInfoToPayloadItem;
+  devInfo->encodeInto       = NULL;
   rtdDevInfo                = &devInfo->data.deviceInfo;
 
   /* Clear the Device Information structure before parsing */
@@ -477,6 +506,7 @@ ReturnCode NdefClass::ndefPayloadToRtdDeviceInfo(const ndefConstBuffer *bufDevIn
   devInfo->id               = NDEF_TYPE_RTD_DEVICE_INFO;
   devInfo->getPayloadLength = ndefRtdDeviceInfoPayloadGetLength;
   devInfo->getPayloadItem   = ndefRtdDeviceInfoToPayloadItem;
+  devInfo->encodeInto       = NULL;
   rtdDevInfo                = &devInfo->data.deviceInfo;
 
   if ((bufDevInfo->length < NDEF_RTD_DEVICE_INFO_PAYLOAD_MIN) ||
@@ -542,6 +572,8 @@ ReturnCode NdefClass::ndefPayloadToRtdDeviceInfo(const ndefConstBuffer *bufDevIn
 ReturnCode NdefClass::ndefRecordToRtdDeviceInfo(const ndefRecord *record, ndefType *devInfo)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
 
   if ((record == NULL) || (devInfo == NULL)) {
     return ST_ERR_PARAM;
@@ -557,11 +589,17 @@ ReturnCode NdefClass::ndefRecordToRtdDeviceInfo(const ndefRecord *record, ndefTy
     return ST_ERR_NONE;
   }
 
-  if (record->bufPayload.length < NDEF_RTD_DEVICE_INFO_PAYLOAD_MIN) { /* Device Information Payload Min */
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  if (bufPayload.length < NDEF_RTD_DEVICE_INFO_PAYLOAD_MIN) { /* Device Information Payload Min */
     return ST_ERR_PROTO;
   }
 
-  return ndefPayloadToRtdDeviceInfo(&record->bufPayload, devInfo);
+  return ndefPayloadToRtdDeviceInfo(&bufPayload, devInfo);
 }
 
 
@@ -653,6 +691,29 @@ static const uint8_t *ndefRtdTextToPayloadItem(const ndefType *text, ndefConstBu
 
   return bufItem->buffer;
 }
+
+
+/*****************************************************************************/
+static uint32_t ndefRtdTextEncodeInto(const ndefType *text, uint8_t *buffer)
+{
+  const ndefTypeRtdText *rtdText;
+  uint32_t offset;
+
+  if ((text == NULL) || (text->id != NDEF_TYPE_RTD_TEXT) || (buffer == NULL)) {
+    return 0;
+  }
+
+  rtdText = &text->data.text;
+
+  buffer[0] = rtdText->status;
+  offset    = sizeof(rtdText->status);
+  (void)ST_MEMCPY(&buffer[offset], rtdText->bufLanguageCode.buffer, rtdText->bufLanguageCode.length);
+  offset   += rtdText->bufLanguageCode.length;
+  (void)ST_MEMCPY(&buffer[offset], rtdText->bufSentence.buffer, rtdText->bufSentence.length);
+  offset   += rtdText->bufSentence.length;
+
+  return offset;
+}
 #ifdef __cplusplus
 }
 #endif
@@ -680,6 +741,7 @@ ReturnCode NdefClass::ndefRtdText(ndefType *text, uint8_t utfEncoding, const nde
   text->id               = NDEF_TYPE_RTD_TEXT;
   text->getPayloadLength = ndefRtdTextPayloadGetLength;
   text->getPayloadItem   = ndefRtdTextToPayloadItem;
+  text->encodeInto       = ndefRtdTextEncodeInto;
   rtdText                = &text->data.text;
 
   rtdText->status = (utfEncoding << NDEF_RTD_TEXT_ENCODING_SHIFT) | (bufLanguageCode->length & NDEF_RTD_TEXT_LANGUAGE_CODE_LEN_MASK);
@@ -733,6 +795,7 @@ ReturnCode NdefClass::ndefPayloadToRtdText(const ndefConstBuffer *bufText, ndefT
   text->id               = NDEF_TYPE_RTD_TEXT;
   text->getPayloadLength = ndefRtdTextPayloadGetLength;
   text->getPayloadItem   = ndefRtdTextToPayloadItem;
+  text->encodeInto       = ndefRtdTextEncodeInto;
   rtdText                = &text->data.text;
 
   /* Extract info from the payload */
@@ -758,6 +821,8 @@ ReturnCode NdefClass::ndefPayloadToRtdText(const ndefConstBuffer *bufText, ndefT
 ReturnCode NdefClass::ndefRecordToRtdText(const ndefRecord *record, ndefType *text)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
 
   if ((record == NULL) || (text == NULL)) {
     return ST_ERR_PARAM;
@@ -773,11 +838,17 @@ ReturnCode NdefClass::ndefRecordToRtdText(const ndefRecord *record, ndefType *te
     return ST_ERR_NONE;
   }
 
-  if (record->bufPayload.length < NDEF_RTD_TEXT_PAYLOAD_LENGTH_MIN) { /* Text Payload Min */
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  if (bufPayload.length < NDEF_RTD_TEXT_PAYLOAD_LENGTH_MIN) { /* Text Payload Min */
     return ST_ERR_PROTO;
   }
 
-  return ndefPayloadToRtdText(&record->bufPayload, text);
+  return ndefPayloadToRtdText(&bufPayload, text);
 }
 
 
@@ -863,6 +934,24 @@ static const uint8_t *ndefRtdUriToPayloadItem(const ndefType *uri, ndefConstBuff
 
   return bufItem->buffer;
 }
+
+
+/*****************************************************************************/
+static uint32_t ndefRtdUriEncodeInto(const ndefType *uri, uint8_t *buffer)
+{
+  const ndefTypeRtdUri *rtdUri;
+
+  if ((uri == NULL) || (uri->id != NDEF_TYPE_RTD_URI) || (buffer == NULL)) {
+    return 0;
+  }
+
+  rtdUri = &uri->data.uri;
+
+  buffer[0] = rtdUri->protocol;
+  (void)ST_MEMCPY(&buffer[sizeof(rtdUri->protocol)], rtdUri->bufUriString.buffer, rtdUri->bufUriString.length);
+
+  return sizeof(rtdUri->protocol) + rtdUri->bufUriString.length;
+}
 #ifdef __cplusplus
 }
 #endif
@@ -870,7 +959,10 @@ static const uint8_t *ndefRtdUriToPayloadItem(const ndefType *uri, ndefConstBuff
 /*****************************************************************************/
 ReturnCode NdefClass::ndefRtdUriProtocolAutodetect(uint8_t *protocol, ndefConstBuffer *bufUriString)
 {
-  uint8_t i; /* Protocol fits in 1 byte */
+  uint8_t  i; /* Protocol fits in 1 byte */
+  uint8_t  c;
+  uint8_t  prefix;
+  uint32_t length;
 
   if ((protocol  == NULL)                       ||
       (*protocol != NDEF_URI_PREFIX_AUTODETECT) ||
@@ -878,19 +970,31 @@ ReturnCode NdefClass::ndefRtdUriProtocolAutodetect(uint8_t *protocol, ndefConstB
     return ST_ERR_PARAM;
   }
 
-  for (i = 0; i < NDEF_URI_PREFIX_COUNT; i++) {
-    if (ndefUriPrefix[i].length > 0U) {
-      if (ST_BYTECMP(bufUriString->buffer, ndefUriPrefix[i].buffer, ndefUriPrefix[i].length) == 0) {
-        *protocol = i;
-        /* Move after the protocol string */
-        bufUriString->buffer  = &bufUriString->buffer[ndefUriPrefix[i].length];
-        bufUriString->length -= ndefUriPrefix[i].length;
-        return ST_ERR_NONE;
-      }
-    }
+  *protocol = NDEF_URI_PREFIX_NONE;
+
+  if ((bufUriString->buffer == NULL) || (bufUriString->length == 0U)) {
+    return ST_ERR_NOTFOUND;
   }
 
-  *protocol = NDEF_URI_PREFIX_NONE;
+  /* Only the prefixes sharing the first character are candidates, the longest one is tried first */
+  c = bufUriString->buffer[0];
+  if ((c < (uint8_t)'a') || (c > (uint8_t)'z')) {
+    return ST_ERR_NOTFOUND;
+  }
+  c -= (uint8_t)'a';
+
+  for (i = ndefUriPrefixCharStart[c]; i < ndefUriPrefixCharStart[c + 1U]; i++) {
+    prefix = ndefUriPrefixByChar[i];
+    length = ndefUriPrefix[prefix].length;
+    if ((length <= bufUriString->length) &&
+        (ST_BYTECMP(&bufUriString->buffer[1], &ndefUriPrefix[prefix].buffer[1], length - 1U) == 0)) {
+      *protocol = prefix;
+      /* Move after the protocol string */
+      bufUriString->buffer  = &bufUriString->buffer[length];
+      bufUriString->length -= length;
+      return ST_ERR_NONE;
+    }
+  }
 
   return ST_ERR_NOTFOUND;
 }
@@ -911,6 +1015,7 @@ ReturnCode NdefClass::ndefRtdUri(ndefType *uri, uint8_t protocol, const ndefCons
   uri->id               = NDEF_TYPE_RTD_URI;
   uri->getPayloadLength = ndefRtdUriPayloadGetLength;
   uri->getPayloadItem   = ndefRtdUriToPayloadItem;
+  uri->encodeInto       = ndefRtdUriEncodeInto;
   rtdUri                = &uri->data.uri;
 
   bufUri.buffer = bufUriString->buffer;
@@ -929,6 +1034,32 @@ ReturnCode NdefClass::ndefRtdUri(ndefType *uri, uint8_t protocol, const ndefCons
 }
 
 
+/*****************************************************************************/
+ReturnCode NdefClass::ndefRtdUriBatch(ndefType *uris, ndefRecord *records, const ndefConstBuffer *bufUriStrings, uint32_t count)
+{
+  ReturnCode err;
+  uint32_t   i;
+
+  if ((uris == NULL) || (records == NULL) || (bufUriStrings == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  for (i = 0; i < count; i++) {
+    err = ndefRtdUri(&uris[i], NDEF_URI_PREFIX_AUTODETECT, &bufUriStrings[i]);
+    if (err != ST_ERR_NONE) {
+      return err;
+    }
+
+    err = ndefRtdUriToRecord(&uris[i], &records[i]);
+    if (err != ST_ERR_NONE) {
+      return err;
+    }
+  }
+
+  return ST_ERR_NONE;
+}
+
+
 /*****************************************************************************/
 ReturnCode NdefClass::ndefGetRtdUri(const ndefType *uri, ndefConstBuffer *bufProtocol, ndefConstBuffer *bufUriString)
 {
@@ -975,6 +1106,8 @@ ReturnCode NdefClass::ndefPayloadToRtdUri(const ndefConstBuffer *bufUri, ndefTyp
 ReturnCode NdefClass::ndefRecordToRtdUri(const ndefRecord *record, ndefType *uri)
 {
   const ndefType *ndeftype;
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
 
   if ((record == NULL) || (uri == NULL)) {
     return ST_ERR_PARAM;
@@ -990,11 +1123,17 @@ ReturnCode NdefClass::ndefRecordToRtdUri(const ndefRecord *record, ndefType *uri
     return ST_ERR_NONE;
   }
 
-  if (record->bufPayload.length < NDEF_RTD_URI_PAYLOAD_LENGTH_MIN) {
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
+  if (bufPayload.length < NDEF_RTD_URI_PAYLOAD_LENGTH_MIN) {
     return ST_ERR_PROTO;
   }
 
-  return ndefPayloadToRtdUri(&record->bufPayload, uri);
+  return ndefPayloadToRtdUri(&bufPayload, uri);
 }
 
 
@@ -1035,6 +1174,7 @@ ReturnCode NdefClass::ndefRtdAar(ndefType *aar, const ndefConstBuffer *bufPayloa
   aar->id               = NDEF_TYPE_RTD_AAR;
   aar->getPayloadLength = NULL;
   aar->getPayloadItem   = NULL;
+  aar->encodeInto       = NULL;
   rtdAar                = &aar->data.aar;
 
   rtdAar->bufType.buffer    = bufRtdTypeAar.buffer;
@@ -1068,6 +1208,9 @@ ReturnCode NdefClass::ndefGetRtdAar(const ndefType *aar, ndefConstBuffer *bufAar
 /*****************************************************************************/
 ReturnCode NdefClass::ndefRecordToRtdAar(const ndefRecord *record, ndefType *aar)
 {
+  ndefConstBuffer bufPayload;
+  ReturnCode err;
+
   if ((record == NULL) || (aar == NULL)) {
     return ST_ERR_PARAM;
   }
@@ -1076,9 +1219,15 @@ ReturnCode NdefClass::ndefRecordToRtdAar(const ndefRecord *record, ndefType *aar
     return ST_ERR_PROTO;
   }
 
+  /* The payload is referenced in place, it must be contiguous */
+  err = ndefRecordGetPayload(record, &bufPayload);
+  if (err != ST_ERR_NONE) {
+    return err;
+  }
+
   /* No constraint on payload length */
 
-  return ndefRtdAar(aar, &record->bufPayload);
+  return ndefRtdAar(aar, &bufPayload);
 }
 
 
@@ -0,0 +1,194 @@
+/******************************************************************************
+  * \attention
+  *
+  * <h2><center>&copy; COPYRIGHT 2021 STMicroelectronics</center></h2>
+  *
+  * Licensed under ST MIX MYLIBERTY SOFTWARE LICENSE AGREEMENT (the "License");
+  * You may not use this file except in compliance with the License.
+  * You may obtain a copy of the License at:
+  *
+  *        www.st.com/mix_myliberty
+  *
+  * Unless required by applicable law or agreed to in writing, software
+  * distributed under the License is distributed on an "AS IS" BASIS,
+  * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied,
+  * AND SPECIFICALLY DISCLAIMING THE IMPLIED WARRANTIES OF MERCHANTABILITY,
+  * FITNESS FOR A PARTICULAR PURPOSE, AND NON-INFRINGEMENT.
+  * See the License for the specific language governing permissions and
+  * limitations under the License.
+  *
+******************************************************************************/
+
+/*! \file
+ *
+ *  \author SRA
+ *
+ *  \brief RFAL monotonic clock interface
+ *
+ *  This module provides the time base used by all RFAL timers (discovery
+ *  duration, SFGT, RTOX, ...) and by the RFAL delays.
+ *  The clock is injected on RfalNfcClass so that the platform time source
+ *  can be replaced, e.g. by a virtual clock for host side simulations.
+ *
+ * \addtogroup RFAL
+ * @{
+ *
+ * \addtogroup RFAL-HAL
+ * \brief RFAL Hardware Abstraction Layer
+ * @{
+ *
+ * \addtogroup Clock
+ * \brief RFAL Clock Module
+ * @{
+ *
+ */
+
+
+#ifndef RFAL_CLOCK_H
+#define RFAL_CLOCK_H
+
+/*
+ ******************************************************************************
+ * INCLUDES
+ ******************************************************************************
+ */
+#include <stdint.h>
+
+#if defined(ARDUINO)
+#include "Arduino.h"
+#endif
+#if defined(__linux__)
+#include <time.h>
+#include <errno.h>
+#endif
+
+/*
+ ******************************************************************************
+ * GLOBAL DEFINES
+ ******************************************************************************
+ */
+
+#define RFAL_CLOCK_US_IN_MS          1000U      /*!< Number of microseconds in one millisecond */
+
+
+/*******************************************************************************/
+
+class RfalClockClass {
+  public:
+
+    virtual ~RfalClockClass() {}
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL Clock Get Time
+     *
+     * Returns the current value of a monotonic time base. The value is allowed
+     * to wrap around, timers only rely on the difference between two readings.
+     *
+     * \return u32 : current time in microseconds
+     *****************************************************************************
+     */
+    virtual uint32_t rfalClockGetUs(void) = 0;
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL Clock Delay
+     *
+     * Blocks for the given amount of time.
+     * The default implementation busy waits on rfalClockGetUs()
+     *
+     * \param[in]  us : time to wait in microseconds
+     *****************************************************************************
+     */
+    virtual void rfalClockDelayUs(uint32_t us)
+    {
+      uint32_t start = rfalClockGetUs();
+
+      while ((rfalClockGetUs() - start) < us) { /* MISRA 15.6: mandatory brackets */ };
+    }
+};
+
+
+#if defined(ARDUINO)
+/*! Arduino clock adapter based on micros() */
+class RfalArduinoClock : public RfalClockClass {
+  public:
+
+    uint32_t rfalClockGetUs(void)
+    {
+      return (uint32_t)micros();
+    }
+
+    void rfalClockDelayUs(uint32_t us)
+    {
+      /* Use delay() for the ms part so that the scheduler is not starved */
+      if (us >= RFAL_CLOCK_US_IN_MS) {
+        delay(us / RFAL_CLOCK_US_IN_MS);
+      }
+      delayMicroseconds(us % RFAL_CLOCK_US_IN_MS);
+    }
+};
+#endif /* ARDUINO */
+
+
+#if defined(__linux__)
+/*! Linux clock adapter based on CLOCK_MONOTONIC */
+class RfalLinuxClock : public RfalClockClass {
+  public:
+
+    uint32_t rfalClockGetUs(void)
+    {
+      struct timespec ts;
+
+      (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (uint32_t)(((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U));
+    }
+
+    void rfalClockDelayUs(uint32_t us)
+    {
+      struct timespec ts;
+
+      ts.tv_sec  = (time_t)(us / 1000000U);
+      ts.tv_nsec = (long)((us % 1000000U) * 1000U);
+      while ((nanosleep(&ts, &ts) != 0) && (errno == EINTR)) { /* MISRA 15.6: mandatory brackets */ };
+    }
+};
+#endif /* __linux__ */
+
+
+/*! Virtual clock: time only moves when advanced, delays advance it instantly */
+class RfalVirtualClock : public RfalClockClass {
+  public:
+
+    RfalVirtualClock(uint32_t startUs = 0U) : nowUs(startUs) {}
+
+    uint32_t rfalClockGetUs(void)
+    {
+      return nowUs;
+    }
+
+    void rfalClockDelayUs(uint32_t us)
+    {
+      nowUs += us;
+    }
+
+    /*! Advances the virtual time by the given amount of microseconds */
+    void rfalClockAdvanceUs(uint32_t us)
+    {
+      nowUs += us;
+    }
+
+  protected:
+    uint32_t nowUs;
+};
+
+#endif /* RFAL_CLOCK_H */
+
+
+/**
+  * @}
+  *
+  * @}
+  *
+  * @}
+  */
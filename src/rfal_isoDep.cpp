@@ -275,6 +275,7 @@
 #define isoDepReEnableRx( rxB, rxBL, rxL )              rfalRfDev->rfalTransceiveBlockingTx( NULL, 0, rxB, rxBL, rxL, RFAL_TXRX_FLAGS_DEFAULT, RFAL_FWT_NONE )
 
 #define isoDepTimerStart( timer, time_ms ) (timer) = timerCalculateTimer((uint16_t)(time_ms))            /*!< Configures and starts the WTX timer  */
+#define isoDepTimerStartUs( timer, time_us ) (timer) = timerCalculateTimerUs((uint32_t)(time_us))   /*!< Configures and starts a us timer     */
 #define isoDepTimerisExpired( timer )      timerIsExpired( timer )                               /*!< Checks WTX timer has expired         */
 
 /*
@@ -324,7 +325,7 @@ ReturnCode RfalNfcClass::isoDepTx(uint8_t pcb, const uint8_t *txBuf, uint8_t *in
 
 
   if (infLen > 0U) {
-    if (((uint32_t)infBuf - (uint32_t)txBuf) < gIsoDep.hdrLen) { /* Check that we can fit the header in the given space */
+    if ((uint32_t)(infBuf - txBuf) < gIsoDep.hdrLen) { /* Check that we can fit the header in the given space */
       return ST_ERR_NOMEM;
     }
   }
@@ -357,7 +358,7 @@ ReturnCode RfalNfcClass::isoDepTx(uint8_t pcb, const uint8_t *txBuf, uint8_t *in
 
   *(--txBlock)      = computedPcb;               /* PCB always present */
 
-  txBufLen = (infLen + (uint16_t)((uint32_t)infBuf - (uint32_t)txBlock)); /* Calculate overall buffer size */
+  txBufLen = (infLen + (uint16_t)(infBuf - txBlock)); /* Calculate overall buffer size */
 
   if (txBufLen > (gIsoDep.fsx - ISODEP_CRC_LEN)) {                        /* Check if msg length violates the maximum frame size FSC */
     return ST_ERR_NOTSUPP;
@@ -857,12 +858,12 @@ uint16_t RfalNfcClass::rfalIsoDepGetMaxInfLen(void)
 ReturnCode RfalNfcClass::rfalIsoDepStartTransceive(rfalIsoDepTxRxParam param)
 {
   gIsoDep.txBuf        = param.txBuf->prologue;
-  gIsoDep.txBufInfPos  = (uint8_t)((uint32_t)param.txBuf->inf - (uint32_t)param.txBuf->prologue);
+  gIsoDep.txBufInfPos  = (uint8_t)(param.txBuf->inf - param.txBuf->prologue);
   gIsoDep.txBufLen     = param.txBufLen;
   gIsoDep.isTxChaining = param.isTxChaining;
 
   gIsoDep.rxBuf        = param.rxBuf->prologue;
-  gIsoDep.rxBufInfPos  = (uint8_t)((uint32_t)param.rxBuf->inf - (uint32_t)param.rxBuf->prologue);
+  gIsoDep.rxBufInfPos  = (uint8_t)(param.rxBuf->inf - param.rxBuf->prologue);
   gIsoDep.rxBufLen     = sizeof(rfalIsoDepBufFormat);
 
   gIsoDep.rxLen        = param.rxLen;
@@ -1049,7 +1050,7 @@ ReturnCode RfalNfcClass::rfalIsoDepPollAHandleActivation(rfalIsoDepFSxI FSDI, ui
       break;
     }
 
-    delay(1);
+    timerDelay(1);
   } while (((RATSretries--) != 0U) && (ret != ST_ERR_NONE));
 
 
@@ -1110,7 +1111,7 @@ ReturnCode RfalNfcClass::rfalIsoDepPollAHandleActivation(rfalIsoDepFSxI FSDI, ui
   isoDepDev->info.FSx  = rfalIsoDepFSxI2FSx(isoDepDev->info.FSxI);
 
   isoDepDev->info.SFGT = rfalIsoDepSFGI2SFGT((uint8_t)isoDepDev->info.SFGI);
-  isoDepTimerStart(gIsoDep.SFGTTimer, isoDepDev->info.SFGT);
+  isoDepTimerStartUs(gIsoDep.SFGTTimer, rfalIsoDepSFGI2SFGTUs((uint8_t)isoDepDev->info.SFGI));
 
   isoDepDev->info.FWT  = rfalIsoDepFWI2FWT(isoDepDev->info.FWI);
   isoDepDev->info.dFWT = RFAL_ISODEP_DFWT_20;
@@ -1229,7 +1230,7 @@ ReturnCode RfalNfcClass::rfalIsoDepPollBHandleActivation(rfalIsoDepFSxI FSDI, ui
     }
 
     /* Start the SFGT timer */
-    isoDepTimerStart(gIsoDep.SFGTTimer, isoDepDev->info.SFGT);
+    isoDepTimerStartUs(gIsoDep.SFGTTimer, rfalIsoDepSFGI2SFGTUs((uint8_t)isoDepDev->info.SFGI));
   } else {
     isoDepDev->info.DSI = RFAL_BR_106;
     isoDepDev->info.DRI = RFAL_BR_106;
@@ -1419,6 +1420,14 @@ void RfalNfcClass::rfalIsoDepCalcBitRate(rfalBitRate maxAllowedBR, uint8_t piccB
 
 /*******************************************************************************/
 uint32_t RfalNfcClass::rfalIsoDepSFGI2SFGT(uint8_t sfgi)
+{
+  /* Convert to milli seconds, rounded up as per previous 1fc conversion */
+  return ((rfalIsoDepSFGI2SFGTUs(sfgi) / RFAL_CLOCK_US_IN_MS) + 1U);
+}
+
+
+/*******************************************************************************/
+uint32_t RfalNfcClass::rfalIsoDepSFGI2SFGTUs(uint8_t sfgi)
 {
   uint32_t sfgt;
   uint8_t tmpSFGI;
@@ -1438,8 +1447,8 @@ uint32_t RfalNfcClass::rfalIsoDepSFGI2SFGT(uint8_t sfgi)
     sfgt = RFAL_FDT_POLL_NFCA_POLLER;
   }
 
-  /* Convert carrier cycles to milli seconds */
-  return (rfalConv1fcToMs(sfgt) + 1U);
+  /* Convert carrier cycles to micro seconds (64 bit as SFGT max exceeds 32 bit range in us*fc) and round up */
+  return ((uint32_t)(((uint64_t)sfgt * RFAL_US_IN_MS) / RFAL_1MS_IN_1FC) + 1U);
 }
 
 
@@ -61,17 +61,67 @@
 #define rfalNfcNfcNotify( st )         if( gNfcDev.disc.notifyCb != NULL )  gNfcDev.disc.notifyCb( st )
 
 
+/*
+******************************************************************************
+* LOCAL VARIABLES
+******************************************************************************
+*/
+#if defined(ARDUINO)
+static RfalArduinoClock rfalNfcDefaultClock;         /*!< Default time base for the RFAL timers */
+#elif defined(__linux__)
+static RfalLinuxClock   rfalNfcDefaultClock;         /*!< Default time base for the RFAL timers */
+#else
+#error "No default RFAL clock for this platform, provide one to RfalNfcClass"
+#endif
+
+
 /** Constructor I2C
  *  @param i2c object
  *  @param address the address of the component's instance
  */
-RfalNfcClass::RfalNfcClass(RfalRfClass *rfal_rf) : rfalRfDev(rfal_rf)
+RfalNfcClass::RfalNfcClass(RfalRfClass *rfal_rf, RfalClockClass *clock) : rfalRfDev(rfal_rf)
 {
+  rfalNfcSetClock(clock);
   memset(&gNfcDev, 0, sizeof(rfalNfc));
   memset(&gIsoDep, 0, sizeof(rfalIsoDep));
   memset(&gRfalNfcb, 0, sizeof(rfalNfcb));
   memset(&gNfcip, 0, sizeof(rfalNfcDep));
   memset(&gRfalNfcfGreedyF, 0, sizeof(rfalNfcfGreedyF));
+  rfalNfcSetDataExchangeBuffers(NULL, NULL);
+}
+
+
+/*******************************************************************************/
+void RfalNfcClass::rfalNfcSetClock(RfalClockClass *clock)
+{
+  rfalClock = ((clock != NULL) ? clock : &rfalNfcDefaultClock);
+}
+
+
+/*******************************************************************************/
+uint32_t RfalNfcClass::rfalNfcGetTimeUs(void)
+{
+  return rfalClock->rfalClockGetUs();
+}
+
+
+/*******************************************************************************/
+void RfalNfcClass::rfalNfcDelayMs(uint32_t ms)
+{
+  timerDelay(ms);
+}
+
+
+/*******************************************************************************/
+void RfalNfcClass::rfalNfcSetDataExchangeBuffers(rfalNfcBuffer *txBuf, rfalNfcBuffer *rxBuf)
+{
+#if RFAL_NFC_EXTERNAL_BUFFERS
+  gNfcDev.txBuf = txBuf;
+  gNfcDev.rxBuf = rxBuf;
+#else
+  gNfcDev.txBuf = ((txBuf != NULL) ? txBuf : &gNfcDev.txBufStore);
+  gNfcDev.rxBuf = ((rxBuf != NULL) ? rxBuf : &gNfcDev.rxBufStore);
+#endif
 }
 
 
@@ -366,12 +416,61 @@ void RfalNfcClass::rfalNfcWorker(void)
 }
 
 
+/*******************************************************************************/
+uint32_t RfalNfcClass::rfalNfcWorkerGetNextTimeout(void)
+{
+  uint32_t tmo;
+
+  tmo = rfalRfDev->rfalWorkerGetNextTimeout();                                  /* Deadline of the RF driver (GT, FWT, ...) */
+
+  switch (gNfcDev.state) {
+    /*******************************************************************************/
+    case RFAL_NFC_STATE_NOTINIT:
+    case RFAL_NFC_STATE_IDLE:
+    case RFAL_NFC_STATE_ACTIVATED:
+    case RFAL_NFC_STATE_POLL_SELECT:
+    case RFAL_NFC_STATE_DATAEXCHANGE_DONE:
+      break;                                                                    /* Waiting for the upper layer, only RF driver may have work */
+
+    /*******************************************************************************/
+    case RFAL_NFC_STATE_WAKEUP_MODE:
+      break;                                                                    /* Wake-up is signalled by the RF driver */
+
+    /*******************************************************************************/
+    case RFAL_NFC_STATE_LISTEN_TECHDETECT:
+      tmo = MIN(tmo, timerGetRemaining(gNfcDev.discTmr));                        /* Wake up to restart discovery loop */
+      break;
+
+    /*******************************************************************************/
+    case RFAL_NFC_STATE_DATAEXCHANGE:
+      if (gIsoDep.SFGTTimer != 0U) {
+        tmo = MIN(tmo, timerGetRemaining(gIsoDep.SFGTTimer));                    /* Pending SFGT before next I-Block */
+      }
+      if (gNfcip.state == NFCIP_ST_TARG_DEP_RTOX) {
+        tmo = MIN(tmo, timerGetRemaining(gNfcip.RTOXTimer));                     /* Pending RTOX on NFC-DEP target */
+      }
+      break;
+
+    /*******************************************************************************/
+    default:
+      tmo = 0U;                                                                 /* Discovery/activation steps progress on every call */
+      break;
+  }
+
+  return tmo;
+}
+
+
 /*******************************************************************************/
 ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDataLen, uint8_t **rxData, uint16_t **rvdLen, uint32_t fwt)
 {
   ReturnCode            err;
   rfalTransceiveContext ctx;
 
+  if ((gNfcDev.txBuf == NULL) || (gNfcDev.rxBuf == NULL)) {
+    return ST_ERR_NOMEM;
+  }
+
   /*******************************************************************************/
   /* The Data Exchange is divided in two different moments, the trigger/Start of *
    *  the transfer followed by the check until its completion                    */
@@ -387,8 +486,8 @@ ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDa
       }
 
       *rvdLen = (uint16_t *)&gNfcDev.rxLen;
-      *rxData = (uint8_t *)((gNfcDev.activeDev->rfInterface == RFAL_NFC_INTERFACE_ISODEP) ? gNfcDev.rxBuf.isoDepBuf.inf :
-                            ((gNfcDev.activeDev->rfInterface == RFAL_NFC_INTERFACE_NFCDEP) ? gNfcDev.rxBuf.nfcDepBuf.inf : gNfcDev.rxBuf.rfBuf));
+      *rxData = (uint8_t *)((gNfcDev.activeDev->rfInterface == RFAL_NFC_INTERFACE_ISODEP) ? gNfcDev.rxBuf->isoDepBuf.inf :
+                            ((gNfcDev.activeDev->rfInterface == RFAL_NFC_INTERFACE_NFCDEP) ? gNfcDev.rxBuf->nfcDepBuf.inf : gNfcDev.rxBuf->rfBuf));
       return ST_ERR_NONE;
     }
 
@@ -398,8 +497,8 @@ ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDa
       /*******************************************************************************/
       case RFAL_NFC_INTERFACE_RF:
 
-        rfalCreateByteFlagsTxRxContext(ctx, (uint8_t *)txData, txDataLen, gNfcDev.rxBuf.rfBuf, sizeof(gNfcDev.rxBuf.rfBuf), &gNfcDev.rxLen, RFAL_TXRX_FLAGS_DEFAULT, fwt);
-        *rxData = (uint8_t *)gNfcDev.rxBuf.rfBuf;
+        rfalCreateByteFlagsTxRxContext(ctx, (uint8_t *)txData, txDataLen, gNfcDev.rxBuf->rfBuf, sizeof(gNfcDev.rxBuf->rfBuf), &gNfcDev.rxLen, RFAL_TXRX_FLAGS_DEFAULT, fwt);
+        *rxData = (uint8_t *)gNfcDev.rxBuf->rfBuf;
         *rvdLen = (uint16_t *)&gNfcDev.rxLen;
         err = rfalRfDev->rfalStartTransceive(&ctx);
         break;
@@ -409,7 +508,7 @@ ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDa
           rfalIsoDepTxRxParam isoDepTxRx;
 
           if (txDataLen > 0U) {
-            ST_MEMCPY((uint8_t *)gNfcDev.txBuf.isoDepBuf.inf, txData, txDataLen);
+            ST_MEMCPY((uint8_t *)gNfcDev.txBuf->isoDepBuf.inf, txData, txDataLen);
           }
 
           isoDepTxRx.DID          = RFAL_ISODEP_NO_DID;
@@ -417,13 +516,13 @@ ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDa
           isoDepTxRx.FSx          = gNfcDev.activeDev->proto.isoDep.info.FSx;
           isoDepTxRx.dFWT         = gNfcDev.activeDev->proto.isoDep.info.dFWT;
           isoDepTxRx.FWT          = gNfcDev.activeDev->proto.isoDep.info.FWT;
-          isoDepTxRx.txBuf        = &gNfcDev.txBuf.isoDepBuf;
+          isoDepTxRx.txBuf        = &gNfcDev.txBuf->isoDepBuf;
           isoDepTxRx.txBufLen     = txDataLen;
           isoDepTxRx.isTxChaining = false;
-          isoDepTxRx.rxBuf        = &gNfcDev.rxBuf.isoDepBuf;
+          isoDepTxRx.rxBuf        = &gNfcDev.rxBuf->isoDepBuf;
           isoDepTxRx.rxLen        = &gNfcDev.rxLen;
           isoDepTxRx.isRxChaining = &gNfcDev.isRxChaining;
-          *rxData                 = (uint8_t *)gNfcDev.rxBuf.isoDepBuf.inf;
+          *rxData                 = (uint8_t *)gNfcDev.rxBuf->isoDepBuf.inf;
           *rvdLen                 = (uint16_t *)&gNfcDev.rxLen;
 
           /*******************************************************************************/
@@ -437,20 +536,20 @@ ReturnCode RfalNfcClass::rfalNfcDataExchangeStart(uint8_t *txData, uint16_t txDa
           rfalNfcDepTxRxParam nfcDepTxRx;
 
           if (txDataLen > 0U) {
-            ST_MEMCPY((uint8_t *)gNfcDev.txBuf.nfcDepBuf.inf, txData, txDataLen);
+            ST_MEMCPY((uint8_t *)gNfcDev.txBuf->nfcDepBuf.inf, txData, txDataLen);
           }
 
           nfcDepTxRx.DID          = RFAL_NFCDEP_DID_KEEP;
           nfcDepTxRx.FSx          = rfalNfcDepLR2FS((uint8_t)rfalNfcDepPP2LR(gNfcDev.activeDev->proto.nfcDep.activation.Target.ATR_RES.PPt));
           nfcDepTxRx.dFWT         = gNfcDev.activeDev->proto.nfcDep.info.dFWT;
           nfcDepTxRx.FWT          = gNfcDev.activeDev->proto.nfcDep.info.FWT;
-          nfcDepTxRx.txBuf        = &gNfcDev.txBuf.nfcDepBuf;
+          nfcDepTxRx.txBuf        = &gNfcDev.txBuf->nfcDepBuf;
           nfcDepTxRx.txBufLen     = txDataLen;
           nfcDepTxRx.isTxChaining = false;
-          nfcDepTxRx.rxBuf        = &gNfcDev.rxBuf.nfcDepBuf;
+          nfcDepTxRx.rxBuf        = &gNfcDev.rxBuf->nfcDepBuf;
           nfcDepTxRx.rxLen        = &gNfcDev.rxLen;
           nfcDepTxRx.isRxChaining = &gNfcDev.isRxChaining;
-          *rxData                 = (uint8_t *)gNfcDev.rxBuf.nfcDepBuf.inf;
+          *rxData                 = (uint8_t *)gNfcDev.rxBuf->nfcDepBuf.inf;
           *rvdLen                 = (uint16_t *)&gNfcDev.rxLen;
 
           /*******************************************************************************/
@@ -1176,7 +1275,28 @@ ReturnCode RfalNfcClass::rfalNfcDeactivation(void)
  */
 uint32_t RfalNfcClass::timerCalculateTimer(uint16_t time)
 {
-  return (millis() + time);
+  return timerCalculateTimerUs((uint32_t)time * RFAL_CLOCK_US_IN_MS);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief  Calculate Timer in Microseconds
+ *
+ * Same as timerCalculateTimer() but with microsecond resolution, used
+ * for sub-millisecond waits such as SFGT.
+ * Durations shall be kept below 2^31 us (~35min)
+ *
+ * \see timerCalculateTimer
+ *
+ * \param[in]  time : time/duration in Microseconds for the timer
+ *
+ * \return u32 : The new timer calculated based on the given time
+ *****************************************************************************
+ */
+uint32_t RfalNfcClass::timerCalculateTimerUs(uint32_t time)
+{
+  return (rfalClock->rfalClockGetUs() + time);
 }
 
 
@@ -1201,10 +1321,10 @@ bool RfalNfcClass::timerIsExpired(uint32_t timer)
   uint32_t uDiff;
   int32_t sDiff;
 
-  uDiff = (timer - millis());   /* Calculate the diff between the timers */
-  sDiff = uDiff;                            /* Convert the diff to a signed var      */
+  uDiff = (timer - rfalClock->rfalClockGetUs());   /* Calculate the diff between the timers */
+  sDiff = (int32_t)uDiff;                           /* Convert the diff to a signed var      */
   /* Having done this has two side effects:
-   * 1) all differences smaller than -(2^31) ms (~25d) will become positive
+   * 1) all differences smaller than -(2^31) us (~35min) will become positive
    *    Signaling not expired: acceptable!
    * 2) Time roll-over case will be handled correctly: super!
    */
@@ -1216,3 +1336,41 @@ bool RfalNfcClass::timerIsExpired(uint32_t timer)
 
   return false;
 }
+
+
+/*!
+ *****************************************************************************
+ * \brief  Get Timer Remaining Time
+ *
+ * This method returns the time left until the given timer expires.
+ *
+ * \see timerCalculateTimer
+ *
+ * \param[in]  timer : the timer to check
+ *
+ * \return u32 : Remaining time in Milliseconds (rounded up), 0 if already expired
+ *****************************************************************************
+ */
+uint32_t RfalNfcClass::timerGetRemaining(uint32_t timer)
+{
+  if (timerIsExpired(timer)) {
+    return 0U;
+  }
+
+  return (((timer - rfalClock->rfalClockGetUs()) + (RFAL_CLOCK_US_IN_MS - 1U)) / RFAL_CLOCK_US_IN_MS);
+}
+
+
+/*!
+ *****************************************************************************
+ * \brief  Delay
+ *
+ * This method blocks for the given time using the configured clock
+ *
+ * \param[in]  time : time to wait in Milliseconds
+ *****************************************************************************
+ */
+void RfalNfcClass::timerDelay(uint32_t time)
+{
+  rfalClock->rfalClockDelayUs(time * RFAL_CLOCK_US_IN_MS);
+}
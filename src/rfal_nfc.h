@@ -68,6 +68,7 @@
 */
 #include "st_errno.h"
 #include "rfal_rf.h"
+#include "rfal_clock.h"
 #include "rfal_isoDep.h"
 #include "rfal_nfca.h"
 #include "rfal_nfcb.h"
@@ -84,6 +85,10 @@
 */
 #define RFAL_NFC_RF_BUF_LEN              255U     /*!< No technology             */
 
+#ifndef RFAL_NFC_EXTERNAL_BUFFERS
+#define RFAL_NFC_EXTERNAL_BUFFERS        0U       /*!< 1: Data Exchange buffers only come from rfalNfcSetDataExchangeBuffers() */
+#endif
+
 #define RFAL_NFC_TECH_NONE               0x0000U  /*!< No technology             */
 #define RFAL_NFC_POLL_TECH_A             0x0001U  /*!< NFC-A technology Flag     */
 #define RFAL_NFC_POLL_TECH_B             0x0002U  /*!< NFC-B technology Flag     */
@@ -98,6 +103,8 @@
 
 #define RFAL_NFC_MAX_DEVICES          5U    /* Max number of devices supported */
 
+#define RFAL_ST25xV_MB_FRAME_BUF_LEN  272U  /*!< ST25DV mailbox frame buffer: header + UID + 256 bytes message + CRC */
+
 
 /*
 ******************************************************************************
@@ -237,12 +244,33 @@ typedef struct {
   bool                    isRxChaining;       /* Flag indicating Other device is chaining        */
   uint32_t                lmMask;             /* Listen Mode mask                                */
 
-  rfalNfcBuffer           txBuf;              /* Tx buffer for Data Exchange                     */
-  rfalNfcBuffer           rxBuf;              /* Rx buffer for Data Exchange                     */
+  rfalNfcBuffer           *txBuf;             /* Tx buffer for Data Exchange                     */
+  rfalNfcBuffer           *rxBuf;             /* Rx buffer for Data Exchange                     */
   uint16_t                rxLen;              /* Length of received data on Data Exchange        */
+#if !RFAL_NFC_EXTERNAL_BUFFERS
+  rfalNfcBuffer           txBufStore;         /* Embedded txBuf, used when none is supplied      */
+  rfalNfcBuffer           rxBufStore;         /* Embedded rxBuf, used when none is supplied      */
+#endif
 } rfalNfc;
 
 
+/*! ST25DV fast transfer mode mailbox streaming channel                                                            */
+typedef struct {
+  uint8_t                 flags;                              /*!< Request flags used on every command            */
+  uint8_t                 uid[RFAL_NFCV_UID_LEN];             /*!< UID of the addressed tag                       */
+  bool                    addressed;                          /*!< Use the UID (Addressed) or Selected mode       */
+  bool                    fastMode;                           /*!< Use the ST Fast commands                       */
+  uint16_t                timeoutMs;                          /*!< Max time to wait for the mailbox per message   */
+  uint16_t                hostLatencyMs;                      /*!< Learnt time the host takes to serve a message  */
+  uint32_t                bytes;                              /*!< Payload bytes transferred                      */
+  uint32_t                messages;                           /*!< Mailbox messages transferred                   */
+  uint32_t                polls;                              /*!< MB_CTRL_Dyn polls issued                       */
+  uint32_t                elapsedUs;                          /*!< Time spent in the streaming calls              */
+  uint32_t                bytesPerSec;                        /*!< Throughput over the transferred bytes          */
+  uint8_t                 frameBuf[RFAL_ST25xV_MB_FRAME_BUF_LEN]; /*!< Tx/Rx frame buffer                         */
+} rfalST25xVMailbox;
+
+
 /*******************************************************************************/
 
 
@@ -262,9 +290,67 @@ class RfalNfcClass {
      * \brief  RFAL NFC Constructor
      *
      * It generates the RFAL NFC object.
+     *
+     * \param[in]  rfal_rf : the hardware component to be used
+     * \param[in]  clock   : time base for the RFAL timers, NULL for the
+     *                       platform default (Arduino micros() / Linux
+     *                       CLOCK_MONOTONIC)
+     *****************************************************************************
+     */
+    RfalNfcClass(RfalRfClass *rfal_rf, RfalClockClass *clock = NULL);
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL NFC Set Clock
+     *
+     * It replaces the time base used by all RFAL timers and delays.
+     * Shall not be called while a timer is running, i.e. only in IDLE state
+     *
+     * \param[in]  clock : time base to be used, NULL for the platform default
+     *****************************************************************************
+     */
+    void rfalNfcSetClock(RfalClockClass *clock);
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL NFC Get Time
+     *
+     * It returns the current time of the RFAL time base, e.g. to measure
+     * durations consistently with the RFAL timers
+     *
+     * \return Current time in microseconds, wraps around
      *****************************************************************************
      */
-    RfalNfcClass(RfalRfClass *rfal_rf); // Set the hardware component to be used
+    uint32_t rfalNfcGetTimeUs(void);
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL NFC Delay
+     *
+     * It waits the given time on the RFAL time base, so that callers outside
+     * the RFAL keep in step with a replaced clock
+     *
+     * \param[in]  ms : time to wait in Milliseconds
+     *****************************************************************************
+     */
+    void rfalNfcDelayMs(uint32_t ms);
+
+    /*!
+     *****************************************************************************
+     * \brief  RFAL NFC Set Data Exchange Buffers
+     *
+     * It makes rfalNfcDataExchangeStart() use caller-owned Tx/Rx buffers
+     * instead of the ones embedded in the object, e.g. taken from a pool
+     * shared with other instances. The buffers must stay valid while a
+     * Data Exchange is ongoing.
+     * When built with RFAL_NFC_EXTERNAL_BUFFERS set to 1 the embedded buffers
+     * are removed and the Data Exchange requires these buffers.
+     *
+     * \param[in]  txBuf : Tx buffer, NULL to go back to the embedded one
+     * \param[in]  rxBuf : Rx buffer, NULL to go back to the embedded one
+     *****************************************************************************
+     */
+    void rfalNfcSetDataExchangeBuffers(rfalNfcBuffer *txBuf, rfalNfcBuffer *rxBuf);
 
     /*!
      *****************************************************************************
@@ -275,6 +361,26 @@ class RfalNfcClass {
      */
     void rfalNfcWorker(void);
 
+    /*!
+     *****************************************************************************
+     * \brief  RFAL NFC Worker Get Next Timeout
+     *
+     * It returns how long the caller may block before rfalNfcWorker() has to
+     * be executed again. It takes into account the discovery total duration
+     * timer, the ISO-DEP SFGT, the NFC-DEP RTOX and the timers reported by the
+     * RF driver (GT, FWT).
+     * This allows the host loop to sleep on an event/condition until either
+     * the returned deadline or an IRQ signalled through the callback set with
+     * rfalSetUpperLayerCallback() instead of spinning on rfalNfcWorker().
+     *
+     * \return 0                        : rfalNfcWorker() must be executed now
+     * \return RFAL_WORKER_TIMEOUT_NONE : No deadline pending, wait for an
+     *                                    IRQ or for an upper layer request
+     * \return others                   : Time in milliseconds until next deadline
+     *****************************************************************************
+     */
+    uint32_t rfalNfcWorkerGetNextTimeout(void);
+
     /*!
      *****************************************************************************
      * \brief  RFAL NFC Initialize
@@ -393,6 +499,7 @@ class RfalNfcClass {
      *
      * \return ST_ERR_WRONG_STATE  : Incorrect state for this operation
      * \return ST_ERR_PARAM        : Invalid parameters
+     * \return ST_ERR_NOMEM        : No Data Exchange buffers, see rfalNfcSetDataExchangeBuffers()
      * \return ST_ERR_NONE         : No error
      *****************************************************************************
      */
@@ -3151,6 +3258,81 @@ class RfalNfcClass {
      */
     ReturnCode rfalST25xVPollerFastWriteMessage(uint8_t flags, const uint8_t *uid, uint8_t msgLen, const uint8_t *msgData, uint8_t *txBuf, uint16_t txBufLen);
 
+    /*!
+     *****************************************************************************
+     * \brief  ST25DV Mailbox channel Initialize
+     *
+     * Prepares a streaming channel over the ST25DV fast transfer mode mailbox
+     * and clears its statistics. The mailbox must have been enabled by the host
+     * (MB_EN set in MB_CTRL_Dyn).
+     *
+     * \param[out] mb             : channel to be initialized
+     * \param[in]  flags          : Flags to be used: Sub-carrier; Data_rate; Option
+     *                              for NFC-Forum use: RFAL_NFCV_REQ_FLAG_DEFAULT
+     * \param[in]  uid            : UID of the device to be addressed
+     *                               if not provided Select mode will be used
+     * \param[in]  fastMode       : use the ST Fast commands
+     * \param[in]  timeoutMs      : max time to wait for the mailbox on each message
+     *
+     * \return ST_ERR_PARAM          : Invalid parameters
+     * \return ST_ERR_NONE           : No error
+     *****************************************************************************
+     */
+    ReturnCode rfalST25xVMailboxInit(rfalST25xVMailbox *mb, uint8_t flags, const uint8_t *uid, bool fastMode, uint16_t timeoutMs);
+
+    /*!
+     *****************************************************************************
+     * \brief  ST25DV Mailbox streaming Write
+     *
+     * Splits data into mailbox messages and writes them one after the other.
+     * Before each message MB_CTRL_Dyn is polled, with an increasing backoff,
+     * until the host has consumed the previous one. The function returns as soon
+     * as the last message is written so the host consumes it while the caller
+     * prepares the next transfer.
+     * Messages are at most 255 bytes long and never 1 byte long, a message shorter
+     * than 255 bytes therefore marks the end of a transfer. When dataLen is a
+     * multiple of 255 the last 255 bytes are sent as 253 + 2.
+     *
+     * \param[in]  mb             : initialized channel
+     * \param[in]  data           : data to be sent
+     * \param[in]  dataLen        : length of data (at least 2 bytes)
+     *
+     * \return ST_ERR_PARAM          : Invalid parameters
+     * \return ST_ERR_DISABLED       : Mailbox disabled by the host
+     * \return ST_ERR_TIMEOUT        : Host did not consume a message in time
+     * \return ST_ERR_PROTO          : Protocol error detected
+     * \return ST_ERR_NONE           : No error
+     *****************************************************************************
+     */
+    ReturnCode rfalST25xVMailboxWrite(rfalST25xVMailbox *mb, const uint8_t *data, uint32_t dataLen);
+
+    /*!
+     *****************************************************************************
+     * \brief  ST25DV Mailbox streaming Read
+     *
+     * Waits for the host to put messages in the mailbox and concatenates them
+     * in buf until buf is full or a message shorter than 255 bytes is received.
+     * The transfer must end with a message shorter than 255 bytes: a host that
+     * sends an exact multiple of 255 bytes must split the last message as
+     * rfalST25xVMailboxWrite() does, or frame the length in the data itself.
+     * On ST_ERR_TIMEOUT rcvLen holds the length of the data received so far,
+     * which is incomplete.
+     *
+     * \param[in]  mb             : initialized channel
+     * \param[out] buf            : buffer to store the received data
+     * \param[in]  bufLen         : length of buf
+     * \param[out] rcvLen         : number of bytes received
+     *
+     * \return ST_ERR_PARAM          : Invalid parameters
+     * \return ST_ERR_DISABLED       : Mailbox disabled by the host
+     * \return ST_ERR_TIMEOUT        : Host did not put the next message in time
+     * \return ST_ERR_NOMEM          : Message does not fit in buf
+     * \return ST_ERR_PROTO          : Protocol error detected
+     * \return ST_ERR_NONE           : No error
+     *****************************************************************************
+     */
+    ReturnCode rfalST25xVMailboxRead(rfalST25xVMailbox *mb, uint8_t *buf, uint32_t bufLen, uint32_t *rcvLen);
+
 
     /*
     ******************************************************************************
@@ -3257,6 +3439,30 @@ class RfalNfcClass {
     ReturnCode rfalT2TPollerRead(uint8_t blockNum, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
 
 
+    /*!
+     *****************************************************************************
+     * \brief  NFC-A T2T Poller Read Batch
+     *
+     * This method sends several Read commands back to back to a NFC-A T2T
+     * Listener device, reading nbReads * RFAL_T2T_READ_DATA_LEN consecutive
+     * bytes starting at blockNum, within the current sector
+     *
+     * \see rfalTransceiveBlockingTxRxBatch
+     *
+     * \param[in]   blockNum    : Number of the first block to read
+     * \param[in]   nbReads     : Number of Read commands (max RFAL_T2T_READ_BATCH_MAX)
+     * \param[out]  rxBuf       : pointer to place the read data
+     *                            (nbReads * RFAL_T2T_READ_DATA_LEN)
+     *
+     * \return ST_ERR_WRONG_STATE  : RFAL not initialized or mode not set
+     * \return ST_ERR_PARAM        : Invalid parameter
+     * \return ST_ERR_PROTO        : Protocol error
+     * \return ST_ERR_NONE         : No error
+     *****************************************************************************
+     */
+    ReturnCode rfalT2TPollerReadBatch(uint8_t blockNum, uint8_t nbReads, uint8_t *rxBuf);
+
+
     /*!
      *****************************************************************************
      * \brief  NFC-A T2T Poller Write
@@ -3479,7 +3685,7 @@ class RfalNfcClass {
      * \param[out]     cApduBuf : buffer where the C-APDU will be placed
      * \param[in]      offset   : File offset
      * \param[in]      data     : Data to be written
-     * \param[in]      dataLen  : Data length to be written (Lc)
+     * \param[in]      dataLen  : Data length to be written (Lc), extended coding above FFh
      * \param[out]     cApduLen : Composed C-APDU length
      *
      * \return ST_ERR_PARAM        : Invalid parameter
@@ -3487,7 +3693,7 @@ class RfalNfcClass {
      * \return ST_ERR_NONE         : No error
      *****************************************************************************
      */
-    ReturnCode rfalT4TPollerComposeWriteData(rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, const uint8_t *data, uint8_t dataLen, uint16_t *cApduLen);
+    ReturnCode rfalT4TPollerComposeWriteData(rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, const uint8_t *data, uint16_t dataLen, uint16_t *cApduLen);
 
     /*!
      *****************************************************************************
@@ -3503,7 +3709,7 @@ class RfalNfcClass {
      * \param[out]     cApduBuf : buffer where the C-APDU will be placed
      * \param[in]      offset   : File offset
      * \param[in]      data     : Data to be written
-     * \param[in]      dataLen  : Data length to be written (Lc)
+     * \param[in]      dataLen  : Data length to be written (Lc), extended coding above FFh
      * \param[out]     cApduLen : Composed C-APDU length
      *
      * \return ST_ERR_PARAM        : Invalid parameter
@@ -3511,7 +3717,7 @@ class RfalNfcClass {
      * \return ST_ERR_NONE         : No error
      *****************************************************************************
      */
-    ReturnCode rfalT4TPollerComposeWriteDataODO(rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, const uint8_t *data, uint8_t dataLen, uint16_t *cApduLen);
+    ReturnCode rfalT4TPollerComposeWriteDataODO(rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, const uint8_t *data, uint16_t dataLen, uint16_t *cApduLen);
 
     RfalRfClass *getRfalRf()
     {
@@ -3533,6 +3739,7 @@ class RfalNfcClass {
     ReturnCode isoDepDataExchangePCD(uint16_t *outActRxLen, bool *outIsChaining);
     void rfalIsoDepCalcBitRate(rfalBitRate maxAllowedBR, uint8_t piccBRCapability, rfalBitRate *dsi, rfalBitRate *dri);
     uint32_t rfalIsoDepSFGI2SFGT(uint8_t sfgi);
+    uint32_t rfalIsoDepSFGI2SFGTUs(uint8_t sfgi);
     uint8_t rfalNfcaCalculateBcc(const uint8_t *buf, uint8_t bufLen);
     ReturnCode rfalNfcbCheckSensbRes(const rfalNfcbSensbRes *sensbRes, uint8_t sensbResLen);
     bool nfcipDxIsSupported(uint8_t Dx, uint8_t BRx, uint8_t BSx);
@@ -3556,10 +3763,16 @@ class RfalNfcClass {
     ReturnCode rfalST25xVPollerGenericReadMessageLength(uint8_t cmd, uint8_t flags, const uint8_t *uid, uint8_t *msgLen);
     ReturnCode rfalST25xVPollerGenericReadMessage(uint8_t cmd, uint8_t flags, const uint8_t *uid, uint8_t mbPointer, uint8_t numBytes, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen);
     ReturnCode rfalST25xVPollerGenericWriteMessage(uint8_t cmd, uint8_t flags, const uint8_t *uid, uint8_t msgLen, const uint8_t *msgData, uint8_t *txBuf, uint16_t txBufLen);
+    ReturnCode rfalST25xVMailboxWait(rfalST25xVMailbox *mb, uint8_t mask, uint8_t value, bool settle);
+    void rfalST25xVMailboxUpdateStats(rfalST25xVMailbox *mb, uint32_t startUs);
     uint32_t timerCalculateTimer(uint16_t time);
+    uint32_t timerCalculateTimerUs(uint32_t time);
     bool timerIsExpired(uint32_t timer);
+    uint32_t timerGetRemaining(uint32_t timer);
+    void timerDelay(uint32_t time);
 
     RfalRfClass *rfalRfDev;
+    RfalClockClass *rfalClock;
     rfalNfc gNfcDev;
     rfalIsoDep gIsoDep;    /*!< ISO-DEP Module instance               */
     rfalNfcb gRfalNfcb; /*!< RFAL NFC-B Instance */
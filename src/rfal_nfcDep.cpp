@@ -1160,7 +1160,7 @@ ReturnCode RfalNfcClass::nfcipTx(rfalNfcDepCmd cmd, uint8_t *txBuf, uint8_t *pay
   *(--txBlock) = (uint8_t)(nfcipCmdIsReq(cmd) ? NFCIP_REQ : NFCIP_RES);                /* CMDType */
 
 
-  txBufIt += paylLen + (uint16_t)((uint32_t)payloadBuf - (uint32_t)txBlock);           /* Calculate overall buffer size */
+  txBufIt += paylLen + (uint16_t)(payloadBuf - txBlock);           /* Calculate overall buffer size */
 
 
   if (txBufIt > gNfcip.fsc) {                                                          /* Check if msg length violates the maximum payload size FSC */
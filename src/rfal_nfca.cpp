@@ -107,7 +107,7 @@ enum {
         do {                                   \
           (r)=(f);                                       \
           if (((rt)!=0U) && ((dl)!=0U)) {                \
-            delay(dl);                         \
+            timerDelay(dl);                    \
           }                                              \
         } while( ((rts--) != 0U) && ((r)==ST_ERR_TIMEOUT) );  \
       }
@@ -291,7 +291,7 @@ ReturnCode RfalNfcClass::rfalNfcvPollerCollisionResolution(rfalComplianceMode co
       return ST_ERR_RF_COLLISION;
     }
 
-    delay(RFAL_NFCV_FDT_V_INVENT_NORES);
+    timerDelay(RFAL_NFCV_FDT_V_INVENT_NORES);
 
     /*******************************************************************************/
     /* Collisions pending, Anticollision loop must be executed                     */
@@ -322,7 +322,7 @@ ReturnCode RfalNfcClass::rfalNfcvPollerCollisionResolution(rfalComplianceMode co
       if (ret != ST_ERR_TIMEOUT) {
         if (rcvdLen < rfalConvBytesToBits(RFAL_NFCV_INV_RES_LEN + RFAL_NFCV_CRC_LEN)) {
           /* If only a partial frame was received make sure the FDT_V_INVENT_NORES is fulfilled */
-          delay(RFAL_NFCV_FDT_V_INVENT_NORES);
+          timerDelay(RFAL_NFCV_FDT_V_INVENT_NORES);
         }
 
         if (ret == ST_ERR_NONE) {
@@ -355,7 +355,7 @@ ReturnCode RfalNfcClass::rfalNfcvPollerCollisionResolution(rfalComplianceMode co
         }
       } else {
         /* Timeout */
-        delay(RFAL_NFCV_FDT_V_INVENT_NORES);
+        timerDelay(RFAL_NFCV_FDT_V_INVENT_NORES);
       }
 
       /* Check if devices found have reached device limit   Activity 2.0  9.3.7.15  (Symbol 16) */
@@ -88,6 +88,8 @@
 
 #define RFAL_TIMING_NONE                           0x00U                                        /*!< Timing disabled | Don't apply                     */
 
+#define RFAL_WORKER_TIMEOUT_NONE                   0xFFFFFFFFU                                  /*!< No pending deadline: worker only needs to run on IRQ/event */
+
 #define RFAL_1FC_IN_4096FC                         (uint32_t)4096U                              /*!< Number of 1/fc cycles in one 4096/fc              */
 #define RFAL_1FC_IN_512FC                          (uint32_t)512U                               /*!< Number of 1/fc cycles in one 512/fc               */
 #define RFAL_1FC_IN_64FC                           (uint32_t)64U                                /*!< Number of 1/fc cycles in one 64/fc                */
@@ -390,6 +392,21 @@ typedef struct {
 } rfalTransceiveContext;
 
 
+/*! Struct that holds one entry of a batch of blocking Transceives (lengths in bytes)                      */
+typedef struct {
+  uint8_t              *txBuf;                  /*!< (In)  Buffer where outgoing message is located       */
+  uint16_t              txBufLen;               /*!< (In)  Length of the outgoing message in bytes        */
+
+  uint8_t              *rxBuf;                  /*!< (Out) Buffer where incoming message will be placed   */
+  uint16_t              rxBufLen;               /*!< (In)  Maximum length of the incoming message in bytes*/
+  uint16_t             *actLen;                 /*!< (Out) Actual received length in bytes                */
+
+  uint32_t              flags;                  /*!< (In)  TransceiveFlags indication special handling    */
+  uint32_t              fwt;                    /*!< (In)  Frame Waiting Time in 1/fc                     */
+  ReturnCode            ret;                    /*!< (Out) Result of this Transceive                      */
+} rfalTransceiveBatchItem;
+
+
 /*! System callback to indicate an event that requires a system reRun        */
 typedef void (* rfalUpperLayerCallback)(void);
 
@@ -1118,6 +1135,31 @@ class RfalRfClass {
     virtual void rfalWorker(void);
 
 
+    /*!
+     *****************************************************************************
+     *  \brief RFAL Worker Get Next Timeout
+     *
+     *  Returns how long the caller may sleep before rfalWorker() has to be
+     *  executed again, considering the timers currently running in the driver
+     *  (GT, FWT, FDT, ...).
+     *  Events signalled by the chip IRQ are reported through the callback
+     *  set with rfalSetUpperLayerCallback(), which shall be used to wake up
+     *  the caller before the returned timeout elapses.
+     *
+     *  The default implementation returns 0, keeping the busy polling behaviour
+     *  for drivers that do not track their deadlines.
+     *
+     * \return 0                        : rfalWorker() must be executed now
+     * \return RFAL_WORKER_TIMEOUT_NONE : No deadline pending, wait for an IRQ
+     * \return others                   : Time in milliseconds until next deadline
+     *****************************************************************************
+     */
+    virtual uint32_t rfalWorkerGetNextTimeout(void)
+    {
+      return 0U;
+    }
+
+
     /*****************************************************************************
      *  ISO1443A                                                                 *
      *****************************************************************************/
@@ -1342,6 +1384,54 @@ class RfalRfClass {
     virtual ReturnCode rfalTransceiveBlockingTxRx(uint8_t *txBuf, uint16_t txBufLen, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *actLen, uint32_t flags, uint32_t fwt);
 
 
+    /*!
+     *****************************************************************************
+     * \brief Transceive Blocking Batch
+     *
+     * This is method executes the given list of independent Transceives back
+     * to back, each one blocking until it has been completed.
+     * The result of each Transceive is stored on its item; items that have
+     * not been executed due to stopOnError are set to ST_ERR_REQUEST.
+     *
+     * The default implementation loops over rfalTransceiveBlockingTxRx().
+     * Drivers may override it to pipeline the loading of frame N+1 while
+     * frame N is still ongoing.
+     *
+     * \param[in,out] items       : Transceives to be executed
+     * \param[in]     itemsCnt    : Number of items
+     * \param[in]     stopOnError : Stop at the first Transceive not returning ST_ERR_NONE
+     *
+     * \return  ST_ERR_PARAM        : Invalid parameter
+     * \return  ST_ERR_XXXX         : Result of the first failed Transceive
+     * \return  ST_ERR_NONE         : All Transceives done with no error
+     *****************************************************************************
+     */
+    virtual ReturnCode rfalTransceiveBlockingTxRxBatch(rfalTransceiveBatchItem *items, uint16_t itemsCnt, bool stopOnError)
+    {
+      ReturnCode ret;
+      uint16_t   i;
+
+      if ((items == NULL) && (itemsCnt != 0U)) {
+        return ST_ERR_PARAM;
+      }
+
+      ret = ST_ERR_NONE;
+      for (i = 0U; i < itemsCnt; i++) {
+        if ((ret != ST_ERR_NONE) && stopOnError) {
+          items[i].ret = ST_ERR_REQUEST;
+          continue;
+        }
+
+        items[i].ret = rfalTransceiveBlockingTxRx(items[i].txBuf, items[i].txBufLen, items[i].rxBuf, items[i].rxBufLen, items[i].actLen, items[i].flags, items[i].fwt);
+        if ((items[i].ret != ST_ERR_NONE) && (ret == ST_ERR_NONE)) {
+          ret = items[i].ret;
+        }
+      }
+
+      return ret;
+    }
+
+
 
     /*****************************************************************************
      *  Listen Mode                                                              *
@@ -153,7 +153,7 @@ bool RfalNfcClass::rfalSt25tbPollerDoCollisionResolution(uint8_t devLimit, rfalS
   col = false;
 
   for (i = 0; i < RFAL_ST25TB_SLOTS; i++) {
-    delay(1);  /* Wait t2: Answer to new request delay  */
+    timerDelay(1);  /* Wait t2: Answer to new request delay  */
 
     if (i == 0U) {
       /* Step 2: Send Pcall16 */
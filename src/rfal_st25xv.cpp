@@ -68,6 +68,9 @@
 #define RFAL_NFCV_FLAG_POS                0U     /*!< Flag byte position                                                */
 #define RFAL_NFCV_FLAG_LEN                1U     /*!< Flag byte length                                                  */
 
+#define RFAL_ST25DV_MB_POLL_MIN_MS        1U     /*!< First backoff between two MB_CTRL_Dyn polls                       */
+#define RFAL_ST25DV_MB_POLL_MAX_MS        16U    /*!< Max backoff between two MB_CTRL_Dyn polls                         */
+
 
 /*
 ******************************************************************************
@@ -446,10 +449,10 @@ ReturnCode RfalNfcClass::rfalST25xVPollerPresentPassword(uint8_t flags, const ui
 ReturnCode RfalNfcClass::rfalST25xVPollerGetRandomNumber(uint8_t flags, const uint8_t *uid, uint8_t *rxBuf, uint16_t rxBufLen, uint16_t *rcvLen)
 {
   rfalRfDev->rfalFieldOff();
-  delay(RFAL_ST25TV02K_TRF_OFF);
+  timerDelay(RFAL_ST25TV02K_TRF_OFF);
   rfalNfcvPollerInitialize();
   rfalRfDev->rfalFieldOnAndStartGT();
-  delay(RFAL_ST25TV02K_TBOOT_RF);
+  timerDelay(RFAL_ST25TV02K_TBOOT_RF);
   return rfalNfcvPollerTransceiveReq(RFAL_NFCV_CMD_GET_RANDOM_NUMBER, flags, RFAL_NFCV_ST_IC_MFG_CODE, uid, NULL, 0U, rxBuf, rxBufLen, rcvLen);
 }
 
@@ -488,3 +491,210 @@ ReturnCode RfalNfcClass::rfalST25xVPollerFastReadMessage(uint8_t flags, const ui
 {
   return rfalST25xVPollerGenericReadMessage(RFAL_NFCV_CMD_FAST_READ_MESSAGE, flags, uid, mbPointer, numBytes, rxBuf, rxBufLen, rcvLen);
 }
+
+/*******************************************************************************/
+ReturnCode RfalNfcClass::rfalST25xVMailboxWait(rfalST25xVMailbox *mb, uint8_t mask, uint8_t value, bool settle)
+{
+  ReturnCode ret;
+  uint8_t    reg;
+  uint32_t   tmr;
+  uint32_t   startUs;
+  uint32_t   waitedMs;
+  uint32_t   backoff;
+  bool       first;
+
+  tmr     = timerCalculateTimer(mb->timeoutMs);
+  startUs = rfalClock->rfalClockGetUs();
+  backoff = RFAL_ST25DV_MB_POLL_MIN_MS;
+  first   = true;
+
+  /* Right after a message, give the host the time it usually needs before polling */
+  if (settle && (mb->hostLatencyMs > 0U)) {
+    timerDelay(mb->hostLatencyMs);
+  }
+
+  for (;;) {
+    if (mb->fastMode) {
+      ret = rfalST25xVPollerFastReadDynamicConfiguration(mb->flags, (mb->addressed ? mb->uid : NULL), RFAL_ST25DV_MB_CTRL_DYN, &reg);
+    } else {
+      ret = rfalST25xVPollerReadDynamicConfiguration(mb->flags, (mb->addressed ? mb->uid : NULL), RFAL_ST25DV_MB_CTRL_DYN, &reg);
+    }
+    mb->polls++;
+
+    if (ret != ST_ERR_NONE) {
+      return ret;
+    }
+
+    if ((reg & RFAL_ST25DV_MB_CTRL_MB_EN) == 0U) {
+      return ST_ERR_DISABLED;
+    }
+
+    if ((reg & mask) == value) {
+      break;
+    }
+
+    if (timerIsExpired(tmr)) {
+      return ST_ERR_TIMEOUT;
+    }
+
+    timerDelay(MIN(backoff, timerGetRemaining(tmr)));
+    backoff = MIN((backoff << 1U), RFAL_ST25DV_MB_POLL_MAX_MS);
+    first   = false;
+  }
+
+  /* Learn the host latency: shrink it when it was already met, otherwise move towards the observed one */
+  if (settle) {
+    if (first) {
+      mb->hostLatencyMs -= (mb->hostLatencyMs >> 2U);
+    } else {
+      waitedMs = ((rfalClock->rfalClockGetUs() - startUs) / RFAL_CLOCK_US_IN_MS);
+      mb->hostLatencyMs = (uint16_t)(((3U * (uint32_t)mb->hostLatencyMs) + MIN(waitedMs, (uint32_t)mb->timeoutMs) + 2U) >> 2U);
+    }
+  }
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+void RfalNfcClass::rfalST25xVMailboxUpdateStats(rfalST25xVMailbox *mb, uint32_t startUs)
+{
+  mb->elapsedUs += (rfalClock->rfalClockGetUs() - startUs);
+
+  if (mb->elapsedUs > 0U) {
+    mb->bytesPerSec = (uint32_t)(((uint64_t)mb->bytes * 1000000U) / mb->elapsedUs);
+  }
+}
+
+/*******************************************************************************/
+ReturnCode RfalNfcClass::rfalST25xVMailboxInit(rfalST25xVMailbox *mb, uint8_t flags, const uint8_t *uid, bool fastMode, uint16_t timeoutMs)
+{
+  if (mb == NULL) {
+    return ST_ERR_PARAM;
+  }
+
+  ST_MEMSET(mb, 0x00, sizeof(rfalST25xVMailbox));
+
+  mb->flags     = flags;
+  mb->fastMode  = fastMode;
+  mb->timeoutMs = timeoutMs;
+
+  if (uid != NULL) {
+    ST_MEMCPY(mb->uid, uid, RFAL_NFCV_UID_LEN);
+    mb->addressed = true;
+  }
+
+  return ST_ERR_NONE;
+}
+
+/*******************************************************************************/
+ReturnCode RfalNfcClass::rfalST25xVMailboxWrite(rfalST25xVMailbox *mb, const uint8_t *data, uint32_t dataLen)
+{
+  ReturnCode ret;
+  uint32_t   startUs;
+  uint32_t   offset;
+  uint32_t   msgLen;
+  bool       settle;
+
+  if ((mb == NULL) || (data == NULL) || (dataLen < 2U)) {
+    return ST_ERR_PARAM;
+  }
+
+  startUs = rfalClock->rfalClockGetUs();
+  offset  = 0U;
+  settle  = false;
+  ret     = ST_ERR_NONE;
+
+  while (offset < dataLen) {
+    msgLen = MIN((dataLen - offset), RFAL_ST25DV_MB_MSG_MAX_LEN);
+
+    /* A 1 byte message cannot be sent: leave 2 bytes for the last one */
+    if ((dataLen - offset - msgLen) == 1U) {
+      msgLen--;
+    }
+
+    /* The last message must be shorter than 255 bytes to mark the end: send 253 + 2 for an exact multiple of 255 */
+    if ((msgLen == RFAL_ST25DV_MB_MSG_MAX_LEN) && ((dataLen - offset) == RFAL_ST25DV_MB_MSG_MAX_LEN)) {
+      msgLen -= 2U;
+    }
+
+    /* Mailbox is free once the host has read the previous message and has none pending */
+    ret = rfalST25xVMailboxWait(mb, (RFAL_ST25DV_MB_CTRL_HOST_PUT_MSG | RFAL_ST25DV_MB_CTRL_RF_PUT_MSG), 0U, settle);
+    if (ret != ST_ERR_NONE) {
+      break;
+    }
+
+    if (mb->fastMode) {
+      ret = rfalST25xVPollerFastWriteMessage(mb->flags, (mb->addressed ? mb->uid : NULL), (uint8_t)(msgLen - 1U), &data[offset], mb->frameBuf, sizeof(mb->frameBuf));
+    } else {
+      ret = rfalST25xVPollerWriteMessage(mb->flags, (mb->addressed ? mb->uid : NULL), (uint8_t)(msgLen - 1U), &data[offset], mb->frameBuf, sizeof(mb->frameBuf));
+    }
+    if (ret != ST_ERR_NONE) {
+      break;
+    }
+
+    offset += msgLen;
+    mb->bytes += msgLen;
+    mb->messages++;
+    settle = true;
+  }
+
+  /* The last message is left to the host: it is consumed while the caller goes on */
+  rfalST25xVMailboxUpdateStats(mb, startUs);
+  return ret;
+}
+
+/*******************************************************************************/
+ReturnCode RfalNfcClass::rfalST25xVMailboxRead(rfalST25xVMailbox *mb, uint8_t *buf, uint32_t bufLen, uint32_t *rcvLen)
+{
+  ReturnCode ret;
+  uint32_t   startUs;
+  uint32_t   msgLen;
+  uint16_t   len;
+  bool       settle;
+
+  if ((mb == NULL) || (buf == NULL) || (bufLen == 0U) || (rcvLen == NULL)) {
+    return ST_ERR_PARAM;
+  }
+
+  startUs = rfalClock->rfalClockGetUs();
+  *rcvLen = 0U;
+  settle  = false;
+
+  do {
+    ret = rfalST25xVMailboxWait(mb, RFAL_ST25DV_MB_CTRL_HOST_PUT_MSG, RFAL_ST25DV_MB_CTRL_HOST_PUT_MSG, settle);
+    if (ret != ST_ERR_NONE) {
+      /* On timeout *rcvLen still tells how much data was received before the transfer stalled */
+      break;
+    }
+
+    /* MBPointer and Number of bytes at 0: the whole message is returned, which frees the mailbox */
+    if (mb->fastMode) {
+      ret = rfalST25xVPollerFastReadMessage(mb->flags, (mb->addressed ? mb->uid : NULL), 0U, 0U, mb->frameBuf, sizeof(mb->frameBuf), &len);
+    } else {
+      ret = rfalST25xVPollerReadMessage(mb->flags, (mb->addressed ? mb->uid : NULL), 0U, 0U, mb->frameBuf, sizeof(mb->frameBuf), &len);
+    }
+    if (ret != ST_ERR_NONE) {
+      break;
+    }
+
+    if (len <= RFAL_NFCV_FLAG_LEN) {
+      ret = ST_ERR_PROTO;
+      break;
+    }
+
+    msgLen = ((uint32_t)len - RFAL_NFCV_FLAG_LEN);
+    if (msgLen > (bufLen - *rcvLen)) {
+      ret = ST_ERR_NOMEM;
+      break;
+    }
+
+    ST_MEMCPY(&buf[*rcvLen], &mb->frameBuf[RFAL_NFCV_FLAG_LEN], msgLen);
+    *rcvLen += msgLen;
+    mb->bytes += msgLen;
+    mb->messages++;
+    settle = true;
+  } while ((msgLen >= RFAL_ST25DV_MB_MSG_MAX_LEN) && (*rcvLen < bufLen));
+
+  rfalST25xVMailboxUpdateStats(mb, startUs);
+  return ret;
+}
@@ -64,6 +64,12 @@
 #define RFAL_NFCV_BLOCKNUM_M24LR_LEN                     2U      /*!< Block Number length of MR24LR tags: 16 bits                */
 #define RFAL_NFCV_ST_IC_MFG_CODE                         0x02    /*!< ST IC Mfg code (used for custom commands)                  */
 
+#define RFAL_ST25DV_MB_CTRL_DYN                          0x0DU   /*!< ST25DV MB_CTRL_Dyn dynamic register pointer                */
+#define RFAL_ST25DV_MB_CTRL_MB_EN                        0x01U   /*!< MB_CTRL_Dyn: mailbox enabled                               */
+#define RFAL_ST25DV_MB_CTRL_HOST_PUT_MSG                 0x02U   /*!< MB_CTRL_Dyn: message put by the host, not yet read by RF   */
+#define RFAL_ST25DV_MB_CTRL_RF_PUT_MSG                   0x04U   /*!< MB_CTRL_Dyn: message put by RF, not yet read by the host   */
+#define RFAL_ST25DV_MB_MSG_MAX_LEN                       255U    /*!< Max mailbox message length used by the streaming channel   */
+
 
 #endif /* RFAL_ST25xV_H */
 
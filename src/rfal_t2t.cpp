@@ -136,6 +136,49 @@ ReturnCode RfalNfcClass::rfalT2TPollerRead(uint8_t blockNum, uint8_t *rxBuf, uin
 }
 
 
+/*******************************************************************************/
+ReturnCode RfalNfcClass::rfalT2TPollerReadBatch(uint8_t blockNum, uint8_t nbReads, uint8_t *rxBuf)
+{
+  ReturnCode              ret;
+  rfalT2TReadReq          req[RFAL_T2T_READ_BATCH_MAX];
+  rfalTransceiveBatchItem items[RFAL_T2T_READ_BATCH_MAX];
+  uint16_t                rcvLen[RFAL_T2T_READ_BATCH_MAX];
+  uint8_t                 i;
+
+  if ((rxBuf == NULL) || (nbReads == 0U) || (nbReads > RFAL_T2T_READ_BATCH_MAX) ||
+      (((uint16_t)blockNum + ((uint16_t)(nbReads - 1U) * (RFAL_T2T_READ_DATA_LEN / RFAL_T2T_BLOCK_LEN))) > 0xFFU)) {
+    return ST_ERR_PARAM;
+  }
+
+  for (i = 0U; i < nbReads; i++) {
+    req[i].code = (uint8_t)RFAL_T2T_CMD_READ;
+    req[i].blNo = (uint8_t)(blockNum + (i * (RFAL_T2T_READ_DATA_LEN / RFAL_T2T_BLOCK_LEN)));
+
+    items[i].txBuf    = (uint8_t *)&req[i];
+    items[i].txBufLen = (uint16_t)sizeof(rfalT2TReadReq);
+    items[i].rxBuf    = &rxBuf[i * RFAL_T2T_READ_DATA_LEN];
+    items[i].rxBufLen = (uint16_t)RFAL_T2T_READ_DATA_LEN;
+    items[i].actLen   = &rcvLen[i];
+    items[i].flags    = RFAL_TXRX_FLAGS_DEFAULT;
+    items[i].fwt      = RFAL_FDT_POLL_READ_MAX;
+  }
+
+  /* Transceive Commands */
+  ret = rfalRfDev->rfalTransceiveBlockingTxRxBatch(items, nbReads, true);
+
+  for (i = 0U; i < nbReads; i++) {
+    /* T2T 1.0 5.2.1.7 The Reader/Writer SHALL treat a NACK in response to a READ Command as a Protocol Error */
+    if ((items[i].ret == ST_ERR_INCOMPLETE_BYTE) && (rcvLen[i] == RFAL_T2T_ACK_NACK_LEN) && ((*items[i].rxBuf & RFAL_T2T_ACK_MASK) != RFAL_T2T_ACK)) {
+      return ST_ERR_PROTO;
+    }
+    if ((items[i].ret == ST_ERR_NONE) && (rcvLen[i] != RFAL_T2T_READ_DATA_LEN)) {
+      return ST_ERR_PROTO;
+    }
+  }
+  return ret;
+}
+
+
 /*******************************************************************************/
 ReturnCode RfalNfcClass::rfalT2TPollerWrite(uint8_t blockNum, const uint8_t *wrData)
 {
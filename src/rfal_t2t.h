@@ -63,6 +63,7 @@
 #define RFAL_T2T_BLOCK_LEN            4U                          /*!< T2T block length           */
 #define RFAL_T2T_READ_DATA_LEN        (4U * RFAL_T2T_BLOCK_LEN)   /*!< T2T READ data length       */
 #define RFAL_T2T_WRITE_DATA_LEN       RFAL_T2T_BLOCK_LEN          /*!< T2T WRITE data length      */
+#define RFAL_T2T_READ_BATCH_MAX       4U                          /*!< Max READs in one batch     */
 
 /*
 ******************************************************************************
@@ -57,6 +57,7 @@
 #define RFAL_T4T_OFFSET_DO          0x54U        /*!< Tag value for offset BER-TLV data object          */
 #define RFAL_T4T_LENGTH_DO          0x03U        /*!< Len value for offset BER-TLV data object          */
 #define RFAL_T4T_DATA_DO            0x53U        /*!< Tag value for data BER-TLV data object            */
+#define RFAL_T4T_BER_LEN_2BYTES     0x82U        /*!< BER-TLV length prefix for a two bytes length      */
 
 #define RFAL_T4T_MAX_LC             255U         /*!< Maximum Lc value for short Lc coding              */
 /*
@@ -90,6 +91,7 @@
 ReturnCode RfalNfcClass::rfalT4TPollerComposeCAPDU(rfalT4tCApduParam *apduParam)
 {
   uint8_t                  hdrLen;
+  uint8_t                  lcLen;
   uint16_t                 msgIt;
 
   if ((apduParam == NULL) || (apduParam->cApduBuf == NULL) || (apduParam->cApduLen == NULL)) {
@@ -97,6 +99,7 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeCAPDU(rfalT4tCApduParam *apduParam)
   }
 
   msgIt                  = 0;
+  lcLen                  = 0;
   *(apduParam->cApduLen) = 0;
 
   /*******************************************************************************/
@@ -105,7 +108,13 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeCAPDU(rfalT4tCApduParam *apduParam)
   /* Check if Data is present */
   if (apduParam->LcFlag) {
     if (apduParam->Lc == 0U) {
-      /* Extended field coding not supported */
+      return ST_ERR_PARAM;
+    }
+
+    /* Lc above FFh requires the extended field coding ISO7816-4 2013 5.1 */
+    lcLen = (apduParam->Lc > RFAL_T4T_MAX_LC) ? RFAL_T4T_LC_EXT_LEN : RFAL_T4T_LC_LEN;
+    if ((lcLen == RFAL_T4T_LC_EXT_LEN) && apduParam->LeFlag) {
+      /* Extended Lc followed by a short Le is not a valid case */
       return ST_ERR_PARAM;
     }
 
@@ -115,7 +124,7 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeCAPDU(rfalT4tCApduParam *apduParam)
     }
 
     /* Calculate the header length a place the data/body where it should be */
-    hdrLen = RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN + RFAL_T4T_LC_LEN;
+    hdrLen = RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN + lcLen;
 
     /* make sure not to exceed buffer size */
     if (((uint16_t)hdrLen + (uint16_t)apduParam->Lc + (apduParam->LeFlag ? RFAL_T4T_LC_LEN : 0U)) > RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN) {
@@ -133,7 +142,11 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeCAPDU(rfalT4tCApduParam *apduParam)
 
   /* Check if Data field length is to be added */
   if (apduParam->LcFlag) {
-    apduParam->cApduBuf->apdu[msgIt++] = apduParam->Lc;
+    if (lcLen == RFAL_T4T_LC_EXT_LEN) {
+      apduParam->cApduBuf->apdu[msgIt++] = 0x00U;
+      apduParam->cApduBuf->apdu[msgIt++] = (uint8_t)(apduParam->Lc >> 8U);
+    }
+    apduParam->cApduBuf->apdu[msgIt++] = (uint8_t)apduParam->Lc;
     msgIt += apduParam->Lc;
   }
 
@@ -302,13 +315,14 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeReadDataODO(rfalIsoDepApduBufFormat
 
 
 /*******************************************************************************/
-ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteData(rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, const uint8_t *data, uint8_t dataLen, uint16_t *cApduLen)
+ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteData(rfalIsoDepApduBufFormat *cApduBuf, uint16_t offset, const uint8_t *data, uint16_t dataLen, uint16_t *cApduLen)
 {
   rfalT4tCApduParam cAPDU;
 
 
   /* CLA INS P1  P2   Lc  Data   Le  */
   /* 00h D6h [Offset] len Data   -   */
+  /* Lc is coded on 3 bytes (00h Lc1 Lc2) when len exceeds FFh */
   cAPDU.CLA      = RFAL_T4T_CLA;
   cAPDU.INS      = (uint8_t)RFAL_T4T_INS_UPDATEBINARY;
   cAPDU.P1       = (uint8_t)((offset >> 8U) & 0xFFU);
@@ -327,14 +341,15 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteData(rfalIsoDepApduBufFormat *
 }
 
 /*******************************************************************************/
-ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteDataODO(rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, const uint8_t *data, uint8_t dataLen, uint16_t *cApduLen)
+ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteDataODO(rfalIsoDepApduBufFormat *cApduBuf, uint32_t offset, const uint8_t *data, uint16_t dataLen, uint16_t *cApduLen)
 {
   rfalT4tCApduParam cAPDU;
-  uint8_t           dataIt;
+  uint16_t          dataIt;
 
   /* CLA INS P1  P2   Lc  Data                     Le  */
   /* 00h D7h 00h 00h  len 54 03 xxyyzz 53 Ld data  -   */
   /*                           [offset]     [data]     */
+  /* Ld becomes 82h Ld1 Ld2 and Lc extended when data exceeds FFh */
   cAPDU.CLA      = RFAL_T4T_CLA;
   cAPDU.INS      = (uint8_t)RFAL_T4T_INS_UPDATEBINARY_ODO;
   cAPDU.P1       = 0x00U;
@@ -351,9 +366,13 @@ ReturnCode RfalNfcClass::rfalT4TPollerComposeWriteDataODO(rfalIsoDepApduBufForma
   cApduBuf->apdu[dataIt++] = (uint8_t)(offset >> 8U);
   cApduBuf->apdu[dataIt++] = (uint8_t)(offset);
   cApduBuf->apdu[dataIt++] = RFAL_T4T_DATA_DO;
-  cApduBuf->apdu[dataIt++] = dataLen;
+  if (dataLen > RFAL_T4T_MAX_LC) {
+    cApduBuf->apdu[dataIt++] = RFAL_T4T_BER_LEN_2BYTES;
+    cApduBuf->apdu[dataIt++] = (uint8_t)(dataLen >> 8U);
+  }
+  cApduBuf->apdu[dataIt++] = (uint8_t)dataLen;
 
-  if ((((uint32_t)dataLen + (uint32_t)dataIt) >= RFAL_T4T_MAX_LC) || (((uint32_t)dataLen + (uint32_t)dataIt) >= RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN)) {
+  if (((uint32_t)dataLen + (uint32_t)dataIt + RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN + RFAL_T4T_LC_EXT_LEN) > RFAL_FEATURE_ISO_DEP_APDU_MAX_LEN) {
     return (ST_ERR_NOMEM);
   }
 
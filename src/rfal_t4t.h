@@ -67,6 +67,7 @@
 #define RFAL_T4T_MAX_CAPDU_PROLOGUE_LEN                          4U                          /*!< Command-APDU prologue length (CLA INS P1 P2)                    */
 #define RFAL_T4T_LE_LEN                                          1U                          /*!< Le Expected Response Length (short field coding)                */
 #define RFAL_T4T_LC_LEN                                          1U                          /*!< Lc Data field length  (short field coding)                      */
+#define RFAL_T4T_LC_EXT_LEN                                      3U                          /*!< Lc Data field length  (extended field coding: 00h Lc1 Lc2)      */
 #define RFAL_T4T_MAX_RAPDU_SW1SW2_LEN                            2U                          /*!< SW1 SW2 length                                                  */
 #define RFAL_T4T_CLA                                          0x00U                          /*!< Class byte (contains 00h because secure message are not used)   */
 
@@ -97,7 +98,7 @@ typedef struct {
   uint8_t                  INS;                              /*!< Instruction byte                                   */
   uint8_t                  P1;                               /*!< Parameter byte 1                                   */
   uint8_t                  P2;                               /*!< Parameter byte 2                                   */
-  uint8_t                  Lc;                               /*!< Data field length                                  */
+  uint16_t                 Lc;                               /*!< Data field length (extended coding when above FFh) */
   bool                     LcFlag;                           /*!< Lc flag (append Lc when true)                      */
   uint8_t                  Le;                               /*!< Expected Response Length                           */
   bool                     LeFlag;                           /*!< Le flag (append Le when true)                      */